@@ -0,0 +1,131 @@
+/*
+ *  \file riocore.cpp
+ *  \brief Hardware independent RIO sampling and framing.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+*/
+#include "riocore.h"
+
+
+void rio_sampler_init(struct rio_sampler *s, uint8_t n_channels,
+                      uint8_t scans_per_frame, uint32_t scan_period_us,
+                      uint32_t start_us) {
+  if (n_channels < 1) {
+    n_channels = 1;
+  } else if (n_channels > RIO_MAX_CHANNELS) {
+    n_channels = RIO_MAX_CHANNELS;
+  }
+  if (scans_per_frame < 1) {
+    scans_per_frame = 1;
+  } else if (scans_per_frame > 64) {
+    scans_per_frame = 64;
+  }
+  s->n_channels = n_channels;
+  s->scans_per_frame = scans_per_frame;
+  s->scan_period_us = scan_period_us;
+  s->write = 0;
+  s->channel = 0;
+  s->scan = 0;
+  s->sequence = 0;
+  s->time_us = start_us;
+  s->latest = 0;
+  s->pending = 0;
+  s->overruns = 0;
+}
+
+
+uint8_t rio_sampler_push(struct rio_sampler *s, uint16_t count) {
+  struct rio_frame *f = &s->buf[s->write];
+  if (s->scan == 0) {
+    if (s->channel == 0) {
+      f->sequence = s->sequence;
+      f->time_us = s->time_us;
+    }
+    f->sums[s->channel] = count;
+  } else {
+    f->sums[s->channel] += count;
+  }
+  if (++s->channel < s->n_channels) {
+    return s->channel;
+  }
+
+  // scan complete; the sample clock, not the time the interrupt ran,
+  // stamps the frames
+  s->channel = 0;
+  s->time_us += s->scan_period_us;
+  if (++s->scan == s->scans_per_frame) {
+    s->scan = 0;
+    ++s->sequence;
+    if (s->pending) {
+      ++s->overruns;
+    }
+    s->latest = s->write;
+    s->pending = 1;
+    s->write ^= 1;
+  }
+  return RIO_SCAN_DONE;
+}
+
+
+const struct rio_frame *rio_sampler_take(struct rio_sampler *s) {
+  if (!s->pending) {
+    return 0;
+  }
+  s->pending = 0;
+  return &s->buf[s->latest];
+}
+
+
+uint16_t rio_frame_count(const struct rio_sampler *s,
+                         const struct rio_frame *f, uint8_t channel) {
+  return (f->sums[channel] + s->scans_per_frame / 2) / s->scans_per_frame;
+}
+
+
+int16_t rio_count_to_deg(uint16_t count) {
+  // map() truncates towards zero
+  return ((int32_t)count - 39) * 360 / 943;
+}
+
+
+uint16_t rio_crc16(uint16_t crc, const uint8_t *data, uint8_t len) {
+  while (len--) {
+    crc ^= (uint16_t)*data++ << 8;
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+
+// append a little-endian 16 bit value
+static uint8_t *put16(uint8_t *p, uint16_t v) {
+  *p++ = v & 0xff;
+  *p++ = v >> 8;
+  return p;
+}
+
+
+uint8_t rio_encode_frame(uint8_t *buf, const struct rio_sampler *s,
+                         const struct rio_frame *f, uint16_t rpm) {
+  uint8_t *p = buf;
+  *p++ = 0xa5;
+  *p++ = 0x5a;
+  *p++ = s->n_channels;
+  p = put16(p, f->sequence);
+  p = put16(p, f->time_us & 0xffff);
+  p = put16(p, f->time_us >> 16);
+  for (uint8_t i = 0; i < s->n_channels; ++i) {
+    p = put16(p, rio_frame_count(s, f, i));
+  }
+  p = put16(p, rpm);
+
+  // CRC of everything after the sync bytes, big-endian
+  uint16_t crc = rio_crc16(0, buf + 2, p - buf - 2);
+  *p++ = crc >> 8;
+  *p++ = crc & 0xff;
+  return p - buf;
+}
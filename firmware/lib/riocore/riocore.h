@@ -0,0 +1,93 @@
+/*
+ *  \file riocore.h
+ *  \brief Hardware independent RIO sampling and framing.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ *  Everything here is plain C++ on <stdint.h>, so the same code runs in the
+ *  ADC interrupt on the Arduino and on the host, where the Unity tests in
+ *  test/ check it with `pio test -e native`.
+*/
+#pragma once
+
+#include <stdint.h>
+
+// most channels in a frame, as DFTI's binary decoder accepts
+#define RIO_MAX_CHANNELS 15
+
+// sync (2), channel count, sequence (2), time (4), channels, rpm (2), crc (2)
+#define RIO_FRAME_LEN(n) (9 + 2 * (n) + 4)
+
+// returned by rio_sampler_push when the scan is complete
+#define RIO_SCAN_DONE 0xff
+
+// one frame's worth of samples
+struct rio_frame {
+  // sum of the counts of every scan in the frame, per channel
+  uint16_t sums[RIO_MAX_CHANNELS];
+  // frame sequence counter
+  uint16_t sequence;
+  // sample clock at the start of the first scan, us
+  uint32_t time_us;
+};
+
+// Double buffered sampler, fed one conversion at a time by the ADC
+// interrupt. A scan converts every channel back to back once per tick of
+// the sample clock; scans_per_frame scans are summed into a frame, and
+// completed frames alternate between the two buffers so loop() can encode
+// one while the interrupt fills the other.
+struct rio_sampler {
+  struct rio_frame buf[2];
+  uint8_t n_channels;
+  uint8_t scans_per_frame;
+  // sample clock period, us
+  uint32_t scan_period_us;
+  // interrupt side
+  uint8_t write;
+  uint8_t channel;
+  uint8_t scan;
+  uint16_t sequence;
+  uint32_t time_us;
+  // handoff to loop()
+  volatile uint8_t latest;
+  volatile uint8_t pending;
+  // frames completed before loop() took the previous one
+  volatile uint16_t overruns;
+};
+
+// n_channels is clamped to 1..RIO_MAX_CHANNELS and scans_per_frame to
+// 1..64, so the 10-bit sums can't overflow. start_us is the sample clock
+// at the first scan.
+void rio_sampler_init(struct rio_sampler *s, uint8_t n_channels,
+                      uint8_t scans_per_frame, uint32_t scan_period_us,
+                      uint32_t start_us);
+
+// Store the conversion of the current channel. Returns the next channel to
+// convert, or RIO_SCAN_DONE when the scan is complete and the ADC should
+// wait for the next sample clock tick, with channel 0 selected.
+uint8_t rio_sampler_push(struct rio_sampler *s, uint16_t count);
+
+// Return the latest completed frame, or 0 if there is none since the last
+// call. Call with interrupts disabled. The frame stays untouched for one
+// frame period, after which the interrupt starts filling it again; frames
+// that complete before they are taken are skipped, which shows up as a gap
+// in the sequence counter.
+const struct rio_frame *rio_sampler_take(struct rio_sampler *s);
+
+// Average of a channel over the frame, rounded.
+uint16_t rio_frame_count(const struct rio_sampler *s,
+                         const struct rio_frame *f, uint8_t channel);
+
+// Map an averaged count to whole degrees, as Arduino's map(count, 39, 982,
+// 0, 360). The pots have a dead band below 39 and above 982 counts.
+int16_t rio_count_to_deg(uint16_t count);
+
+// CRC-16-CCITT (xmodem), as avr-libc's _crc_xmodem_update.
+uint16_t rio_crc16(uint16_t crc, const uint8_t *data, uint8_t len);
+
+// Encode a binary (v2) frame of the averaged counts into buf, which must
+// hold RIO_FRAME_LEN(n_channels) bytes. Returns the frame length.
+uint8_t rio_encode_frame(uint8_t *buf, const struct rio_sampler *s,
+                         const struct rio_frame *f, uint16_t rpm);
@@ -8,12 +8,13 @@
 */
 #include <SoftwareSerial.h>
 #include <FreqCount.h>
+#include <riocore.h>
 
 // initialize readings
-unsigned int n_enc = 5; // number of encoder
+const uint8_t n_enc = 5; // number of encoder
 int enc[5] = {0,0,0,0,0};
 unsigned int i = 0;
-int starting_analog_pin = 1;
+const uint8_t starting_analog_pin = 1;
 
 // temporary array to store formatted checksum byte
 char tmp[3];
@@ -26,26 +27,110 @@ float mistery_factor = 308880/43600; // correction factor calculated comparing
 static unsigned long rpm_freq = 0;
 uint32_t             rpm_send = 0;
 
+// Sampling. FreqCount owns Timer1 and Timer2, so the sample clock is the
+// Timer0 compare match A that Arduino's millis() timer already produces
+// every 64 * 256 / 16 MHz = 1024 us. Each compare match starts a scan of all
+// channels back to back, 104 us apart, and the scans are averaged per frame.
+const uint32_t scan_period_us = 1024;
+struct rio_sampler sampler;
+
+#ifdef RIO_BINARY
+// binary (v2) protocol: three scans a frame, so 23 byte frames at 325.5 Hz
+// use 65% of 115200 baud
+const uint8_t scans_per_frame = 3;
+uint8_t frame[RIO_FRAME_LEN(5)];
+#else
+// ASCII protocol: sixteen scans a frame, so messages of about 35 bytes at
+// 61 Hz use a fifth of 112500 baud and leave loop() time to format them.
+// Frames that complete before loop() takes them are counted in
+// sampler.overruns
+const uint8_t scans_per_frame = 16;
+#endif
+
+
+// ADC conversion complete: hand the count to the sampler and select the next
+// channel. The mux change takes effect at the next conversion, whose
+// sample-and-hold acquires for 12 us, plenty for the pots.
+ISR(ADC_vect) {
+  uint8_t next = rio_sampler_push(&sampler, ADC);
+
+  // the trigger is the rising edge of OCF0A, which nothing else clears
+  TIFR0 = _BV(OCF0A);
+  if (next == RIO_SCAN_DONE) {
+    ADMUX = _BV(REFS0) | starting_analog_pin;
+  } else {
+    ADMUX = _BV(REFS0) | (starting_analog_pin + next);
+    ADCSRA |= _BV(ADSC);
+  }
+}
+
 
 void setup() {
   // initialize serial communication and FreqCount for rpm
+#ifdef RIO_BINARY
+  Serial.begin(115200);
+#else
   Serial.begin(112500);
+#endif
   FreqCount.begin(1000);
+
+  // AVcc reference like analogRead(), auto trigger on Timer0 compare match
+  // A, 125 kHz ADC clock
+  rio_sampler_init(&sampler, n_enc, scans_per_frame, scan_period_us,
+                   micros());
+  ADMUX = _BV(REFS0) | starting_analog_pin;
+  ADCSRB = _BV(ADTS1) | _BV(ADTS0);
+  TIFR0 = _BV(OCF0A);
+  ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) |
+           _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+}
+
+
+void update_rpm() {
+  // rpm, updated once per FreqCount gate
+  if (FreqCount.available()) {
+    rpm_freq = FreqCount.read();
+
+    // the brushless sensor triggers 1~10 pulses per second when no RPM is
+    // detected. erase them.
+    rpm_send = (rpm_freq > 10) ? rpm_freq * 60.0 / rpm_ratio : 0;
+
+    // apply mistery factor to match tacho reading
+    rpm_send = rpm_send / mistery_factor;
+  }
 }
 
+
+#ifdef RIO_BINARY
 void loop() {
-  // read the input on analog pin
-  for(i = 0; i < n_enc; i++) {
-    // read encoder
-    enc[i] = analogRead(i + starting_analog_pin);
-    // add delay to settle adc
-    delay(2);
+  const struct rio_frame *f;
+  noInterrupts();
+  f = rio_sampler_take(&sampler);
+  interrupts();
+  if (!f) {
+    return;
   }
 
-  // map to degrees
+  // encode straight away, the interrupt reuses the buffer next frame
+  update_rpm();
+  uint8_t len = rio_encode_frame(frame, &sampler, f,
+                                 rpm_send > 0xffff ? 0xffff : rpm_send);
+  Serial.write(frame, len);
+}
+#else
+void loop() {
+  const struct rio_frame *f;
+  noInterrupts();
+  f = rio_sampler_take(&sampler);
+  interrupts();
+  if (!f) {
+    return;
+  }
+
+  // map to degrees; copy out first, the interrupt reuses the buffer next
+  // frame
   for(i = 0; i < n_enc; i++) {
-    // apparently there's a dead band  before 39 and after 982 on the pots
-    enc[i] = map(enc[i], 39, 982, 0, 360);
+    enc[i] = rio_count_to_deg(rio_frame_count(&sampler, f, i));
   }
 
   // send over serial (test on terminal)
@@ -55,14 +140,8 @@ void loop() {
     msg_str.concat("$");
   }
 
-  // read rpm
-  rpm_freq = FreqCount.read();
-
-  // the brushless sensor triggers 1~10 pulses per second when no RPM is detected. erase them.
-  rpm_send = (rpm_freq > 10) ? rpm_freq * 60.0 / rpm_ratio : 0;
-
-  // apply mistery factor to match tacho reading and append to message
-  rpm_send = rpm_send / mistery_factor;
+  // read rpm and append to message
+  update_rpm();
   msg_str.concat(rpm_send);
   msg_str.concat("$");
 
@@ -82,3 +161,4 @@ void loop() {
   // send packet over serial
   Serial.println(msg_str);
 }
+#endif
@@ -0,0 +1,182 @@
+/*
+ *  \file test_main.cpp
+ *  \brief Unity tests of the RIO sampler and framing.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ *  Runs on the host with `platformio test -e native`. The sampler is fed
+ *  conversions the way the ADC interrupt feeds it, and the frames are
+ *  decoded here as DFTI's binary RIO decoder does.
+*/
+#include <unity.h>
+#include <riocore.h>
+
+const uint8_t channels = 5;
+const uint8_t scans = 3;
+const uint32_t period_us = 1024;
+// just before the sample clock wraps
+const uint32_t start_us = 0xffff0000u;
+
+struct rio_sampler sampler;
+
+
+// a known conversion for each scan and channel
+static uint16_t conversion(uint32_t scan, uint32_t ch) {
+  return (scan * 7 + ch * 131 + scan * ch) % 1024;
+}
+
+
+// feed one frame's conversions, checking the channel the sampler selects
+// after each
+static void push_frame(uint32_t frame) {
+  for (uint32_t s = 0; s < scans; ++s) {
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+      uint8_t next = rio_sampler_push(&sampler,
+                                      conversion(frame * scans + s, ch));
+      TEST_ASSERT_EQUAL_UINT8(ch + 1 < channels ? ch + 1 : RIO_SCAN_DONE,
+                              next);
+    }
+  }
+}
+
+
+static uint16_t get16(const uint8_t *p) {
+  return p[0] | (uint16_t)p[1] << 8;
+}
+
+
+void setUp(void) {
+  rio_sampler_init(&sampler, channels, scans, period_us, start_us);
+}
+
+
+void tearDown(void) {
+}
+
+
+void test_init_clamps(void) {
+  rio_sampler_init(&sampler, 0, 0, period_us, 0);
+  TEST_ASSERT_EQUAL_UINT8(1, sampler.n_channels);
+  TEST_ASSERT_EQUAL_UINT8(1, sampler.scans_per_frame);
+  rio_sampler_init(&sampler, 100, 200, period_us, 0);
+  TEST_ASSERT_EQUAL_UINT8(RIO_MAX_CHANNELS, sampler.n_channels);
+  TEST_ASSERT_EQUAL_UINT8(64, sampler.scans_per_frame);
+}
+
+
+void test_take_needs_a_complete_frame(void) {
+  TEST_ASSERT_NULL(rio_sampler_take(&sampler));
+  // all but the last conversion
+  for (uint32_t i = 0; i + 1 < scans * channels; ++i) {
+    rio_sampler_push(&sampler, 0);
+  }
+  TEST_ASSERT_NULL(rio_sampler_take(&sampler));
+  rio_sampler_push(&sampler, 0);
+  TEST_ASSERT_NOT_NULL(rio_sampler_take(&sampler));
+  TEST_ASSERT_NULL(rio_sampler_take(&sampler));
+}
+
+
+void test_frames_average_scans(void) {
+  for (uint32_t f = 0; f < 100; ++f) {
+    push_frame(f);
+    const struct rio_frame *taken = rio_sampler_take(&sampler);
+    TEST_ASSERT_NOT_NULL(taken);
+    TEST_ASSERT_EQUAL_UINT16(f, taken->sequence);
+    // exact sample clock timestamps, across the wrap
+    TEST_ASSERT_EQUAL_UINT32(start_us + f * scans * period_us,
+                             taken->time_us);
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+      uint32_t sum = 0;
+      for (uint32_t s = 0; s < scans; ++s) {
+        sum += conversion(f * scans + s, ch);
+      }
+      TEST_ASSERT_EQUAL_UINT16((sum + scans / 2) / scans,
+                               rio_frame_count(&sampler, taken, ch));
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, sampler.overruns);
+}
+
+
+void test_skipped_frames_are_overruns(void) {
+  uint16_t skipped = 0;
+  for (uint32_t f = 0; f < 1001; ++f) {
+    push_frame(f);
+    if (f % 50 == 49) {
+      // loop() stalled; the next frame replaces this one
+      ++skipped;
+      continue;
+    }
+    const struct rio_frame *taken = rio_sampler_take(&sampler);
+    TEST_ASSERT_NOT_NULL(taken);
+    TEST_ASSERT_EQUAL_UINT16(f, taken->sequence);
+  }
+  TEST_ASSERT_EQUAL_UINT16(skipped, sampler.overruns);
+}
+
+
+void test_crc16(void) {
+  // the CRC-16/XMODEM check value
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TEST_ASSERT_EQUAL_HEX16(0x31c3, rio_crc16(0, check, sizeof(check)));
+  TEST_ASSERT_EQUAL_HEX16(0, rio_crc16(0, check, 0));
+}
+
+
+void test_encode_frame(void) {
+  push_frame(0);
+  push_frame(1);
+  const struct rio_frame *taken = rio_sampler_take(&sampler);
+  TEST_ASSERT_NOT_NULL(taken);
+  const uint16_t rpm = 2450;
+  uint8_t buf[RIO_FRAME_LEN(RIO_MAX_CHANNELS)];
+  uint8_t len = rio_encode_frame(buf, &sampler, taken, rpm);
+  TEST_ASSERT_EQUAL_UINT8(RIO_FRAME_LEN(channels), len);
+  TEST_ASSERT_EQUAL_UINT8(23, len);
+
+  TEST_ASSERT_EQUAL_HEX8(0xa5, buf[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x5a, buf[1]);
+  TEST_ASSERT_EQUAL_UINT8(channels, buf[2]);
+  TEST_ASSERT_EQUAL_UINT16(1, get16(buf + 3));
+  TEST_ASSERT_EQUAL_UINT32(start_us + scans * period_us,
+                           get16(buf + 5) | (uint32_t)get16(buf + 7) << 16);
+  for (uint8_t ch = 0; ch < channels; ++ch) {
+    TEST_ASSERT_EQUAL_UINT16(rio_frame_count(&sampler, taken, ch),
+                             get16(buf + 9 + 2 * ch));
+  }
+  TEST_ASSERT_EQUAL_UINT16(rpm, get16(buf + 9 + 2 * channels));
+
+  // big-endian CRC of everything after the sync bytes, so the CRC over the
+  // CRC as well is zero
+  uint16_t crc = rio_crc16(0, buf + 2, len - 4);
+  TEST_ASSERT_EQUAL_HEX8(crc >> 8, buf[len - 2]);
+  TEST_ASSERT_EQUAL_HEX8(crc & 0xff, buf[len - 1]);
+  TEST_ASSERT_EQUAL_HEX16(0, rio_crc16(0, buf + 2, len - 2));
+}
+
+
+void test_count_to_deg(void) {
+  // as Arduino's map(count, 39, 982, 0, 360)
+  for (int32_t count = 0; count < 1024; ++count) {
+    TEST_ASSERT_EQUAL_INT16((count - 39) * 360 / 943,
+                            rio_count_to_deg(count));
+  }
+  TEST_ASSERT_EQUAL_INT16(0, rio_count_to_deg(39));
+  TEST_ASSERT_EQUAL_INT16(360, rio_count_to_deg(982));
+}
+
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_init_clamps);
+  RUN_TEST(test_take_needs_a_complete_frame);
+  RUN_TEST(test_frames_average_scans);
+  RUN_TEST(test_skipped_frames_are_overruns);
+  RUN_TEST(test_crc16);
+  RUN_TEST(test_encode_frame);
+  RUN_TEST(test_count_to_deg);
+  return UNITY_END();
+}
@@ -23,7 +23,8 @@ namespace dfti {
 Autopilot::Autopilot(Settings *_settings, QObject* _parent) :
 SerialSensor(_settings, _parent)
 {
-    lastStatus.packet_rx_drop_count = 0;
+    // Stream requests are written to the autopilot.
+    openMode = QIODevice::ReadWrite;
     if (settings->autopilotBaudRate()) {
         setBaudRate(settings->autopilotBaudRate());
         if (settings->debugSerial()) {
@@ -36,26 +37,6 @@ SerialSensor(_settings, _parent)
 // ----------------------------------------------------------------------------
 //  Public functions
 // ----------------------------------------------------------------------------
-void
-Autopilot::open(void)
-{
-    if (_valid_serial && !isOpen()) {
-        if (_port->open(QIODevice::ReadWrite)) {
-            if (settings->debugSerial()) {
-                qDebug() << "Opened serial port:"
-                         << _port->portName();
-            }
-        } else {
-            if (settings->debugSerial()) {
-                qDebug() << "Failed to open serial port:"
-                         << _port->errorString();
-            }
-        };
-        connect(QSERIALPORTPTR(_port), &QIODevice::readyRead, this,
-            &Autopilot::readData);
-    }
-}
-
 void
 Autopilot::getDataRate(quint16 msgId)
 {
@@ -75,7 +56,7 @@ Autopilot::getDataRate(quint16 msgId)
 
     // Send the command message.
     if (isOpen()) {
-        quint32 writeLen = _port->write(buf, len);
+        quint32 writeLen = writePort(buf, len);
         QString msgName = QString::number(msgId);
         if (mavlinkMessageName.contains(msgId)) {
             msgName = mavlinkMessageName[msgId];
@@ -111,8 +92,7 @@ Autopilot::setDataRate(quint8 msgId, float msgRate)
 
     // Send the command message.
     if (isOpen()) {
-        quint32 writeLen = _port->write(buf, len);
-        _port->flush();
+        quint32 writeLen = writePort(buf, len);
         QString msgName = QString::number(msgId);
         if (mavlinkMessageName.contains(msgId)) {
             msgName = mavlinkMessageName[msgId];
@@ -147,139 +127,187 @@ Autopilot::requestStream(quint8 streamId, quint16 streamRate, quint8 enabled)
 
     // Send the message.
     if (isOpen()) {
-        quint32 writeLen = _port->write(buf, len);
-        _port->flush();
+        quint32 writeLen = writePort(buf, len);
         if (writeLen != len) {
             qWarning() << "Failed to send data stream request to autopilot!";
         }
     }
 }
 
+
+void
+Autopilot::parseBytes(const char *bytes, qint64 len)
+{
+    const quint64 failures = stats.checksumFailures;
+    while (len > 0) {
+        const quint32 n = framer.write(bytes, len);
+        bytes += n;
+        len -= n;
+        FrameView frame;
+        while (framer.next(frame)) {
+            if (unpackMessage(frame)) {
+                handleMessage();
+            }
+        }
+    }
+
+    // Check if we dropped any packets.
+    if (settings->debugSerial() && (stats.checksumFailures != failures)) {
+        qDebug() << "dropped" << stats.checksumFailures << "packets";
+    }
+
+    // If this is our first time getting data, request the streams/messages we
+    // want.
+    if (!gotMsg) {
+        if (settings->useMessageInterval()) {
+            setDataRate(MAVLINK_MSG_ID_RC_CHANNELS_RAW,
+                hzToUsec(settings->streamRate()));
+            setDataRate(MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,
+                hzToUsec(settings->streamRate()));
+            getDataRate(MAVLINK_MSG_ID_RC_CHANNELS_RAW);
+            getDataRate(MAVLINK_MSG_ID_SERVO_OUTPUT_RAW);
+        } else {
+            requestStream(MAV_DATA_STREAM_RC_CHANNELS,
+                settings->streamRate(), 1);
+        }
+        gotMsg = true;
+    }
+}
+
 // ----------------------------------------------------------------------------
 // Public Slots
 // ----------------------------------------------------------------------------
-void
-Autopilot::readData(void)
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+bool
+Autopilot::unpackMessage(const FrameView &frame)
 {
-    quint8 ch;
-    mavlink_status_t status = {0};
-    quint8 msgReceived = false;
+    const uchar *p = reinterpret_cast<const uchar *>(frame.data);
+    message.magic = p[0];
+    message.len = p[1];
+    message.seq = p[2];
+    message.sysid = p[3];
+    message.compid = p[4];
+    message.msgid = p[5];
+    char *payload = _MAV_PAYLOAD_NON_CONST(&message);
+    memcpy(payload, p + 6, message.len);
+    // The message is reused, and the decoders read their whole payload.
+    memset(payload + message.len, 0, MAVLINK_MAX_PAYLOAD_LEN - message.len);
+    message.checksum = p[frame.len - 2] | (p[frame.len - 1] << 8);
 
-    // Read in a single byte.
-    if (_port->getChar((char *) &ch)) {
-        // Attempt to parse.
-        msgReceived = mavlink_parse_char(MAVLINK_COMM_1, ch, &message, &status);
-        // Check if we dropped any packets.
-        if (lastStatus.packet_rx_drop_count != status.packet_rx_drop_count) {
-            if (settings->debugSerial()) {
-                qDebug() << "dropped" << status.packet_rx_drop_count
-                         << "packets";
-            }
-            lastStatus = status;
+    const quint8 expected = mavlinkPayloadLen(message.msgid);
+    if (expected && (message.len != expected)) {
+        if (settings->debugSerial()) {
+            qDebug() << "MAVLink message" << message.msgid << "has"
+                     << message.len << "payload bytes, expected" << expected;
         }
+        return false;
+    }
+    return true;
+}
 
-        // Extract the message type if we have a full packet.
-        if (msgReceived) {
-            // Get the system and component IDs of the connected a/p.
-            systemId = message.sysid;
-            compId = message.compid;
 
-            switch (message.msgid) {
-                case MAVLINK_MSG_ID_HEARTBEAT:
-                    if (settings->debugData()) {
-                        qDebug() << "got HEARTBEAT";
-                    }
-                    break;
-                case MAVLINK_MSG_ID_RC_CHANNELS_RAW: {
-                    mavlink_rc_channels_raw_t rcIn;
-                    mavlink_msg_rc_channels_raw_decode(&message, &rcIn);
-                    data.rcInTime = rcIn.time_boot_ms;
-                    data.rcIn1 = rcIn.chan1_raw;
-                    data.rcIn2 = rcIn.chan2_raw;
-                    data.rcIn3 = rcIn.chan3_raw;
-                    data.rcIn4 = rcIn.chan4_raw;
-                    data.rcIn5 = rcIn.chan5_raw;
-                    data.rcIn6 = rcIn.chan6_raw;
-                    data.rcIn7 = rcIn.chan7_raw;
-                    data.rcIn8 = rcIn.chan8_raw;
-                    timestamps.rcChannelsRaw = getTimeUsec();
-                    if (settings->debugData()) {
-                        qDebug() << "Autopilot::readData: RC_CHANNELS_RAW";
-                    }
-                    break;
-                }
-                case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW: {
-                    mavlink_servo_output_raw_t rcOut;
-                    mavlink_msg_servo_output_raw_decode(&message, &rcOut);
-                    data.rcOutTime = rcOut.time_usec;
-                    data.rcOut1 = rcOut.servo1_raw;
-                    data.rcOut2 = rcOut.servo2_raw;
-                    data.rcOut3 = rcOut.servo3_raw;
-                    data.rcOut4 = rcOut.servo4_raw;
-                    data.rcOut5 = rcOut.servo5_raw;
-                    data.rcOut6 = rcOut.servo6_raw;
-                    data.rcOut7 = rcOut.servo7_raw;
-                    data.rcOut8 = rcOut.servo8_raw;
-                    timestamps.servoOutputRaw = getTimeUsec();
-                    if (settings->debugData()) {
-                        qDebug() << "Autopilot::readData: SERVO_OUTPUT_RAW";
-                    }
-                    break;
-                }
-                case MAVLINK_MSG_ID_STATUSTEXT: {
-                    mavlink_statustext_t status;
-                    mavlink_msg_statustext_decode(&message, &status);
-                    qWarning() << "[WARN:" << status.severity << "]: "
-                               << status.text;
-                    break;
-                }
-                case MAVLINK_MSG_ID_COMMAND_ACK: {
-                    if (settings->debugData()) {
-                        mavlink_command_ack_t ack;
-                        mavlink_msg_command_ack_decode(&message, &ack);
-                        qDebug() << "COMMAND ACK" << ack.command << "RESULT"
-                                 << ack.result;
-                    }
-                    break;
+void
+Autopilot::handleMessage(void)
+{
+    // Get the system and component IDs of the connected a/p.
+    systemId = message.sysid;
+    compId = message.compid;
+
+    switch (message.msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+            if (settings->debugData()) {
+                qDebug() << "got HEARTBEAT";
+            }
+            break;
+        case MAVLINK_MSG_ID_RC_CHANNELS_RAW: {
+            mavlink_rc_channels_raw_t rcIn;
+            mavlink_msg_rc_channels_raw_decode(&message, &rcIn);
+            data.rcInTime = rcIn.time_boot_ms;
+            data.rcIn1 = rcIn.chan1_raw;
+            data.rcIn2 = rcIn.chan2_raw;
+            data.rcIn3 = rcIn.chan3_raw;
+            data.rcIn4 = rcIn.chan4_raw;
+            data.rcIn5 = rcIn.chan5_raw;
+            data.rcIn6 = rcIn.chan6_raw;
+            data.rcIn7 = rcIn.chan7_raw;
+            data.rcIn8 = rcIn.chan8_raw;
+            timestamps.rcChannelsRaw = rxTimeUsec;
+            if (settings->debugData()) {
+                qDebug() << "Autopilot::readData: RC_CHANNELS_RAW";
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW: {
+            mavlink_servo_output_raw_t rcOut;
+            mavlink_msg_servo_output_raw_decode(&message, &rcOut);
+            data.rcOutTime = rcOut.time_usec;
+            data.rcOut1 = rcOut.servo1_raw;
+            data.rcOut2 = rcOut.servo2_raw;
+            data.rcOut3 = rcOut.servo3_raw;
+            data.rcOut4 = rcOut.servo4_raw;
+            data.rcOut5 = rcOut.servo5_raw;
+            data.rcOut6 = rcOut.servo6_raw;
+            data.rcOut7 = rcOut.servo7_raw;
+            data.rcOut8 = rcOut.servo8_raw;
+            timestamps.servoOutputRaw = rxTimeUsec;
+            if (settings->debugData()) {
+                qDebug() << "Autopilot::readData: SERVO_OUTPUT_RAW";
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_STATUSTEXT: {
+            mavlink_statustext_t status;
+            mavlink_msg_statustext_decode(&message, &status);
+            qWarning() << "[WARN:" << status.severity << "]: "
+                       << status.text;
+            break;
+        }
+        case MAVLINK_MSG_ID_COMMAND_ACK: {
+            if (settings->debugData()) {
+                mavlink_command_ack_t ack;
+                mavlink_msg_command_ack_decode(&message, &ack);
+                qDebug() << "COMMAND ACK" << ack.command << "RESULT"
+                         << ack.result;
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_MESSAGE_INTERVAL: {
+            if (settings->debugData()) {
+                mavlink_message_interval_t mi;
+                mavlink_msg_message_interval_decode(&message, &mi);
+                QString msgName = QString::number(mi.message_id);
+                if (mavlinkMessageName.contains(mi.message_id)) {
+                    msgName = mavlinkMessageName[mi.message_id];
                 }
-                case MAVLINK_MSG_ID_MESSAGE_INTERVAL: {
-                    if (settings->debugData()) {
-                        mavlink_message_interval_t mi;
-                        mavlink_msg_message_interval_decode(&message, &mi);
-                        QString msgName = QString::number(mi.message_id);
-                        if (mavlinkMessageName.contains(mi.message_id)) {
-                            msgName = mavlinkMessageName[mi.message_id];
-                        }
-                        qDebug() << "Message" << msgName << "at"
-                                 << mi.interval_us << "us.";
-                    }
-                    break;
+                qDebug() << "Message" << msgName << "at"
+                         << mi.interval_us << "us.";
+            }
+            break;
+        }
+        default: {
+            if (settings->debugData()) {
+                QString msgName = QString::number(message.msgid);
+                if (mavlinkMessageName.contains(message.msgid)) {
+                    msgName = mavlinkMessageName[message.msgid];
                 }
-                default: {
-                    if (settings->debugData()) {
-                        QString msgName = QString::number(message.msgid);
-                        if (mavlinkMessageName.contains(message.msgid)) {
-                            msgName = mavlinkMessageName[message.msgid];
-                        }
-                        if (settings->useMessageInterval()) {
-                            setDataRate(message.msgid, -1);
-                            getDataRate(message.msgid);
-                        }
-                        qDebug() << "Got unhandled message type:"
-                                 << msgName;
-                    }
-                    break;
+                if (settings->useMessageInterval()) {
+                    setDataRate(message.msgid, -1);
+                    getDataRate(message.msgid);
                 }
+                qDebug() << "Got unhandled message type:"
+                         << msgName;
             }
-        }
-    } else {
-        if (settings->debugSerial()) {
-            qDebug() << "Failed to read serial port!";
+            break;
         }
     }
 
     // Emit message update if we have both, then reset.
     if (timestamps.rcChannelsRaw && timestamps.servoOutputRaw) {
+        data.timeUsec = rxTimeUsec;
+        data.rxTimeNs = rxTimeNs;
+        publish(data);
         emit measurementUpdate(data);
         timestamps.reset();
 
@@ -305,34 +333,39 @@ Autopilot::readData(void)
                      << "\tRCOUT8:    " << data.rcOut8 << "\n";
         }
     }
-
-    // If this is our first time getting data, request the streams/messages we
-    // want.
-    if (!gotMsg) {
-        if (settings->useMessageInterval()) {
-            setDataRate(MAVLINK_MSG_ID_RC_CHANNELS_RAW,
-                hzToUsec(settings->streamRate()));
-            setDataRate(MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,
-                hzToUsec(settings->streamRate()));
-            getDataRate(MAVLINK_MSG_ID_RC_CHANNELS_RAW);
-            getDataRate(MAVLINK_MSG_ID_SERVO_OUTPUT_RAW);
-        } else {
-            requestStream(MAV_DATA_STREAM_RC_CHANNELS,
-                settings->streamRate(), 1);
-        }
-        gotMsg = true;
-    }
-
-    return;
 }
 
-// ----------------------------------------------------------------------------
-//  Private functions
-// ----------------------------------------------------------------------------
-
 // ----------------------------------------------------------------------------
 //  Functions
 // ----------------------------------------------------------------------------
+quint8
+mavlinkCrcExtra(quint8 msgId)
+{
+    static const quint8 crcs[256] = MAVLINK_MESSAGE_CRCS;
+    return crcs[msgId];
+}
+
+
+quint8
+mavlinkPayloadLen(quint8 msgId)
+{
+    switch (msgId) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+            return MAVLINK_MSG_ID_HEARTBEAT_LEN;
+        case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
+            return MAVLINK_MSG_ID_RC_CHANNELS_RAW_LEN;
+        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+            return MAVLINK_MSG_ID_SERVO_OUTPUT_RAW_LEN;
+        case MAVLINK_MSG_ID_STATUSTEXT:
+            return MAVLINK_MSG_ID_STATUSTEXT_LEN;
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+            return MAVLINK_MSG_ID_COMMAND_ACK_LEN;
+        case MAVLINK_MSG_ID_MESSAGE_INTERVAL:
+            return MAVLINK_MSG_ID_MESSAGE_INTERVAL_LEN;
+        default:
+            return 0;
+    }
+}
 
 
 };  // namespace dfti
@@ -20,8 +20,11 @@
 #include <mavlink/v1/common/mavlink.h>
 // dfti
 #include "mavlink_info.hh"
+#include "sensor/framer.hh"
 #include "sensor/serialsensor.hh"
 #include "settings/settings.hh"
+#include "util/spscqueue.hh"
+#include "util/util.hh"
 
 
 namespace dfti {
@@ -72,11 +75,32 @@ struct APData
     quint16 rcOut7{0};
     //! RC Output channel 8 PPM value.
     quint16 rcOut8{0};
+    //! Host receive time, microseconds since the Unix epoch.
+    quint64 timeUsec{0};
+    //! Host monotonic receive time, nanoseconds (see getMonotonicNsec).
+    quint64 rxTimeNs{0};
 };
 
 
+//! MAVLink CRC extra byte of a message.
+/*!
+ *  \param msgId The MAVLink message ID.
+ *  \return The CRC extra byte from the common dialect's MAVLINK_MESSAGE_CRCS.
+ */
+quint8 mavlinkCrcExtra(quint8 msgId);
+
+
+//! Payload length of a MAVLink message the autopilot driver decodes.
+/*!
+ *  \param msgId The MAVLink message ID.
+ *  \return The message's MAVLINK_MSG_ID_*_LEN, or 0 for messages the driver
+ *      does not decode.
+ */
+quint8 mavlinkPayloadLen(quint8 msgId);
+
+
 //! Serial driver to acquire data from a MAVLink-based autopilot.
-class Autopilot : public SerialSensor
+class Autopilot : public SerialSensor, public MeasurementPublisher<APData>
 {
     Q_OBJECT;
 
@@ -88,13 +112,6 @@ public:
      */
     explicit Autopilot(Settings *_settings, QObject* _parent = nullptr);
 
-    //! Opens the serial port.
-    /*!
-     *  Overrides the SerialSensor::open method to open the serial port as R/W.
-     */
-    void open(void);
-
-
     //! Request a MAVLink message at a given rate.
     /*!
      *  \deprecated REQUEST_DATA_STREAM is deprecated in favor of the
@@ -126,15 +143,45 @@ public:
      */
     void setDataRate(quint8 msgId, float msgRate);
 
-public slots:
-    //! Slot to read in data over serial and parse complete packets.
-    void readData(void);
-
 signals:
     //! Emitted to share new APData.
     void measurementUpdate(APData data);
 
+protected:
+    //! Parse a chunk of raw bytes from the autopilot.
+    /*!
+     *  Frames and validates every complete MAVLink packet and handles each
+     *  message, publishing APData whenever both the RC input and servo
+     *  output messages have been seen.
+     *
+     *  \param bytes Raw bytes as read from the serial port.
+     *  \param len Number of bytes.
+     */
+    void parseBytes(const char *bytes, qint64 len);
+
 private:
+    //! Packet framer.
+    /*!
+     *  Buffers the raw bytes we read in from the serial port until complete
+     *  MAVLink packets can be parsed out of them. 2 kB is several of the
+     *  longest packets.
+     */
+    Framer<MavlinkFraming<mavlinkCrcExtra>, 2048> framer{stats};
+
+    //! Unpack a framed MAVLink packet into the current message.
+    /*!
+     *  The payload after the packet's is zeroed, so nothing of the previous
+     *  message is left for the generated decoders to read.
+     *
+     *  \param frame A full, valid MAVLink packet.
+     *  \return False if the payload length is wrong for a message the
+     *      driver decodes.
+     */
+    bool unpackMessage(const FrameView &frame);
+
+    //! Handle the MAVLink message that just completed.
+    void handleMessage(void);
+
     //! Have we gotten a message?
     bool gotMsg{false};
 
@@ -150,13 +197,6 @@ private:
     //! Current MAVLink message.
     mavlink_message_t message = {0};
 
-    //! Last MAVLink message status.
-    /*!
-     *  The last MAVLink message status is kept to determine if we have packet
-     *  loss by comparing the packet_rx_drop_count field.
-     */
-    mavlink_status_t lastStatus = {0};
-
     //! Hold timestamps for MAVLink messages we want to make sure we get both.
     struct MavlinkTimestamps {
         //! Ctor.
@@ -0,0 +1,3120 @@
+/*!
+ *  \file dfti_bench.cc
+ *  \brief DFTI throughput benchmark program.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+
+
+// stdlib
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <thread>
+#include <vector>
+// 3rd party
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <QUdpSocket>
+// project
+#include "autopilot/autopilot.hh"
+#include "core/consts.hh"
+#include "core/logger.hh"
+#include "rio/rio.hh"
+#include "sensor/capture.hh"
+#include "sensor/reactor.hh"
+#include "settings/settings.hh"
+#include "server/server.hh"
+#include "sim/simulator.hh"
+#include "telemetry/deltacodec.hh"
+#include "telemetry/fec.hh"
+#include "uadc/uadc.hh"
+#include "util/clocksync.hh"
+#include "util/crc.hh"
+#include "util/decimal.hh"
+#include "util/scheduler.hh"
+#include "util/timeutil.hh"
+#include "util/util.hh"
+#include "vn200/vn200.hh"
+
+
+//! App info.
+const QString app_name{"dfti_bench"};
+
+
+//! Heap allocations made while counting is enabled.
+static std::atomic<quint64> allocations{0};
+
+//! Flag to count heap allocations.
+static std::atomic<bool> countAllocations{false};
+
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+
+//! Heap allocations can be counted.
+static const bool allocationsCounted = true;
+
+
+//! Count an allocation if counting is enabled.
+static inline void
+countAllocation(void)
+{
+    if (countAllocations) {
+        ++allocations;
+    }
+}
+
+
+//! Counting allocators.
+/*!
+ *  Interpose glibc's malloc, calloc, realloc and aligned allocators so that
+ *  allocations made anywhere can be counted: Qt's containers call malloc
+ *  and realloc directly, and libstdc++'s operator new and new[], aligned
+ *  forms included, allocate through malloc and aligned_alloc. Only valloc
+ *  and pvalloc, which nothing here uses, are not counted.
+ */
+extern "C" void *
+malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+
+extern "C" void *
+calloc(size_t count, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+
+extern "C" void *
+realloc(void *ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+
+extern "C" void *
+memalign(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+
+extern "C" void *
+aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+
+extern "C" int
+posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if (!alignment || (alignment & (alignment - 1)) ||
+            (alignment % sizeof(void *))) {
+        return EINVAL;
+    }
+    countAllocation();
+    void *p = __libc_memalign(alignment, size);
+    if (!p) {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+#else
+//! Heap allocations can't be counted without glibc's allocator to wrap.
+static const bool allocationsCounted = false;
+#endif
+
+
+//! Heap allocations per packet since counting was last enabled.
+/*!
+ *  \param packets Packets processed.
+ *  \return Allocations per packet, or NaN if they can't be counted.
+ */
+static double
+allocationsPerPacket(quint64 packets)
+{
+    return allocationsCounted ?
+        static_cast<double>(allocations) / packets : std::nan("");
+}
+
+
+//! VN-200 driver that can publish measurements without a serial port.
+class BenchVN200 : public dfti::VN200
+{
+public:
+    using dfti::VN200::VN200;
+    using dfti::MeasurementPublisher<dfti::VN200Data>::publish;
+};
+
+
+//! Write a throwaway rc file.
+/*!
+ *  \param dir Directory to write the file in.
+ *  \param contents Contents of the rc file.
+ *  \return Path to the rc file.
+ */
+static QString
+writeRCFile(const QDir &dir, const QString &contents)
+{
+    QString path = dir.filePath("bench.ini");
+    QFile rc(path);
+    if (!rc.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "Failed to write rc file" << path;
+        exit(-1);
+    }
+    rc.write(contents.toUtf8());
+    return path;
+}
+
+
+//! Fill the sensor data structures with plausible, time-varying values.
+/*!
+ *  \param i Sample index.
+ */
+static void
+fillSensorData(quint32 i, dfti::APData &ap, dfti::RIOData &rio,
+    dfti::uADCData &adc, dfti::VN200Data &ins)
+{
+    const float t = 0.01f * i;
+    ap.rcInTime = 10 * i;
+    ap.rcIn1 = 1500 + static_cast<qint16>(400 * std::sin(t));
+    ap.rcIn2 = 1500 + static_cast<qint16>(400 * std::cos(t));
+    ap.rcOutTime = 10 * i + 3;
+    ap.rcOut1 = ap.rcIn1;
+    ap.rcOut2 = ap.rcIn2;
+    for (quint8 j = 0; j < rio.numValues; ++j) {
+        rio.values[j] = std::floor(180 + 90 * std::sin(t + j));
+    }
+    adc.id = i % 100000;
+    adc.iasMps = std::floor(2500 + 500 * std::sin(t)) / 100;
+    adc.aoaDeg = std::floor(300 * std::sin(2 * t)) / 100;
+    adc.aosDeg = std::floor(100 * std::cos(3 * t)) / 100;
+    adc.altM = 120;
+    adc.ptPa = 101700 + i % 50;
+    adc.psPa = 101325 - i % 50;
+    ins.gpsTimeNs = 1180000000000000000ull + 2500000ull * i;
+    for (quint8 j = 0; j < 3; ++j) {
+        ins.eulerDeg[j] = 30 * std::sin(t + j);
+        ins.angularRatesRPS[j] = 0.5f * std::cos(t + j);
+        ins.velNedMps[j] = 20 * std::sin(0.1f * t + j);
+        ins.accelMps2[j] = 9.81f * std::cos(t + j);
+    }
+    for (quint8 j = 0; j < 4; ++j) {
+        ins.quaternion[j] = 0.5f * std::cos(t + j);
+    }
+    ins.posDegDegM[0] = 30.6280 + 1e-6 * i;
+    ins.posDegDegM[1] = -96.3344 - 1e-6 * i;
+    ins.posDegDegM[2] = 120.0 + 0.01 * std::sin(t);
+}
+
+
+//! Benchmark the CSV and binary log writers.
+/*!
+ *  Runs Logger::writeData for the number of ticks a flight of the given
+ *  length would take at 100, 400 and 800 Hz, with all four sensors enabled
+ *  and fresh data each tick, and reports the time spent per tick, the
+ *  fraction of the tick period that represents, and the bytes written.
+ *
+ *  \param seconds Simulated flight time per run.
+ *  \return Exit code.
+ */
+static int
+benchLog(quint32 seconds)
+{
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) {
+        qWarning() << "Failed to create temporary directory";
+        return -1;
+    }
+    QDir dir(tmp.path());
+    // The Logger writes to the working directory.
+    QDir::setCurrent(tmp.path());
+
+    const quint16 rates[] = {100, 400, 800};
+    const QString formats[] = {"csv", "binary"};
+
+    printf("%8s %8s %10s %12s %8s %12s\n", "rate_hz", "format", "ticks",
+        "usec/tick", "cpu_%", "bytes");
+    for (auto rate : rates) {
+        for (auto format : formats) {
+            dfti::Settings settings(writeRCFile(dir,
+                QString("[dfti]\nlog_rate_hz = %1\nlog_format = %2\n"
+                        "wait_for_update = false\n").arg(rate).arg(format)),
+                dfti::DebugMode::DEBUG_NONE);
+            const quint32 ticks = seconds * rate;
+            qint64 elapsedNs = 0;
+            {
+                dfti::Logger logger(&settings);
+                dfti::Autopilot ap(&settings);
+                dfti::RIO rio(&settings);
+                dfti::uADC adc(&settings);
+                dfti::VN200 ins(&settings);
+                logger.enableAutopilot(&ap);
+                logger.enableRIO(&rio);
+                logger.enableUADC(&adc);
+                logger.enableVN200(&ins);
+
+                dfti::APData apData;
+                dfti::RIOData rioData;
+                rioData.numValues = 6;
+                dfti::uADCData adcData;
+                dfti::VN200Data insData;
+                QElapsedTimer timer;
+                for (quint32 i = 0; i < ticks; ++i) {
+                    fillSensorData(i, apData, rioData, adcData, insData);
+                    logger.getAPData(apData);
+                    logger.getRIOData(rioData);
+                    logger.getUADCData(adcData);
+                    logger.getVN200Data(insData);
+                    timer.start();
+                    logger.writeData();
+                    elapsedNs += timer.nsecsElapsed();
+                }
+                timer.start();
+                logger.flush();
+                elapsedNs += timer.nsecsElapsed();
+            }
+            // Tally up and remove the log files.
+            qint64 bytes = 0;
+            for (auto info : dir.entryInfoList(
+                     QStringList() << "*.csv" << "*.bin", QDir::Files)) {
+                bytes += info.size();
+                QFile::remove(info.filePath());
+            }
+            const double usecPerTick = 1e-3 * elapsedNs / ticks;
+            printf("%8u %8s %10u %12.2f %8.3f %12lld\n", rate,
+                format.toLatin1().constData(), ticks, usecPerTick,
+                100.0 * usecPerTick * rate / 1e6,
+                static_cast<long long>(bytes));
+        }
+    }
+    return 0;
+}
+
+
+//! Check that every-sample logging keeps up with a 400 Hz VN-200.
+/*!
+ *  A producer thread publishes VN-200 measurements at 400 Hz, each stamped
+ *  with its receive time, while the Logger runs in every_sample mode at a
+ *  100 Hz tick. At the end the records written, queue drops and rows in the
+ *  log file are compared against the number of measurements published.
+ *
+ *  \param seconds Run time per format in seconds (real time).
+ *  \return Exit code; nonzero if any sample was lost.
+ */
+static int
+benchEvery(quint32 seconds)
+{
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) {
+        qWarning() << "Failed to create temporary directory";
+        return -1;
+    }
+    QDir dir(tmp.path());
+    // The Logger writes to the working directory.
+    QDir::setCurrent(tmp.path());
+
+    const quint16 sensorRate = 400;
+    const quint16 logRate = 100;
+    const QString formats[] = {"csv", "binary"};
+    int status = 0;
+
+    printf("%8s %10s %10s %10s %10s\n", "format", "published", "written",
+        "dropped", "rows");
+    for (auto format : formats) {
+        dfti::Settings settings(writeRCFile(dir,
+            QString("[dfti]\nlog_rate_hz = %1\nlog_format = %2\n"
+                    "log_mode = every_sample\n").arg(logRate).arg(format)),
+            dfti::DebugMode::DEBUG_NONE);
+        const quint32 samples = seconds * sensorRate;
+        dfti::LogCounters counters;
+        {
+            dfti::Logger logger(&settings);
+            BenchVN200 ins(&settings);
+            logger.enableVN200(&ins);
+
+            std::atomic<bool> done{false};
+            std::thread producer([&]() {
+                dfti::VN200Data data;
+                dfti::APData ap;
+                dfti::RIOData rio;
+                dfti::uADCData adc;
+                auto next = std::chrono::steady_clock::now();
+                for (quint32 i = 0; i < samples; ++i) {
+                    fillSensorData(i, ap, rio, adc, data);
+                    data.timeUsec = dfti::getTimeUsec();
+                    ins.publish(data);
+                    next += std::chrono::microseconds(1000000 / sensorRate);
+                    std::this_thread::sleep_until(next);
+                }
+                done = true;
+            });
+            auto next = std::chrono::steady_clock::now();
+            while (!done) {
+                logger.writeData();
+                next += std::chrono::microseconds(1000000 / logRate);
+                std::this_thread::sleep_until(next);
+            }
+            producer.join();
+            logger.writeData();
+            logger.flush();
+            counters = logger.counters(dfti::BinlogSensor::VN200);
+        }
+        // Count the rows actually on disk.
+        quint64 rows = 0;
+        for (auto info : dir.entryInfoList(
+                 QStringList() << "*.csv" << "*.bin", QDir::Files)) {
+            QFile log(info.filePath());
+            if (log.open(QFile::ReadOnly)) {
+                if (format == "csv") {
+                    // Don't count the header line.
+                    rows = log.readAll().count('\n') - 1;
+                } else {
+                    // Size the schema header by writing it to memory.
+                    QBuffer header;
+                    header.open(QBuffer::WriteOnly);
+                    dfti::writeBinlogHeader(&header,
+                        dfti::BinlogSensor::VN200);
+                    rows = (info.size() - header.size()) /
+                        dfti::binlogRecordSize(dfti::BinlogSensor::VN200);
+                }
+            }
+            QFile::remove(info.filePath());
+        }
+        printf("%8s %10u %10llu %10u %10llu\n", format.toLatin1().constData(),
+            samples, static_cast<unsigned long long>(counters.written),
+            counters.dropped, static_cast<unsigned long long>(rows));
+        if ((counters.written != samples) || counters.dropped ||
+            (rows != samples)) {
+            status = 1;
+        }
+    }
+    return status;
+}
+
+
+//! Verify and benchmark the CRC-16-CCITT implementations.
+/*!
+ *  First checks the table and slice-by-8 versions against the scalar
+ *  reference for every (initial CRC, byte) pair and for random buffers of
+ *  random length and alignment, and checks that validateVN200Checksum
+ *  accepts VN-200 sized packets with a correct checksum appended and
+ *  rejects single-bit errors. Then reports the throughput of each version
+ *  on VN-200 packets and on large buffers.
+ *
+ *  \param seconds Approximate run time per throughput case.
+ *  \return Exit code; nonzero if any implementation disagrees.
+ */
+static int
+benchCRC(quint32 seconds)
+{
+    typedef quint16 (*CRCFunc)(const char *, size_t, quint16);
+    struct Impl {
+        const char *name;
+        CRCFunc func;
+    };
+    const Impl impls[] = {
+        {"scalar", dfti::crc16CCITTScalar},
+        {"table", dfti::crc16CCITTTable},
+        {"slice8", dfti::crc16CCITTSlice8},
+    };
+
+    // Exhaustive single byte check, covers every table entry from every
+    // starting state.
+    quint64 mismatches = 0;
+    for (quint32 crc = 0; crc < 0x10000; ++crc) {
+        for (quint32 byte = 0; byte < 0x100; ++byte) {
+            const char c = static_cast<char>(byte);
+            const quint16 ref = dfti::crc16CCITTScalar(&c, 1, crc);
+            for (auto impl : impls) {
+                mismatches += impl.func(&c, 1, crc) != ref;
+            }
+        }
+    }
+    // Random buffers of every length up to a few blocks, at every alignment.
+    std::vector<char> buf(1 << 16);
+    quint32 seed = 1;
+    for (auto &c : buf) {
+        seed = 1664525 * seed + 1013904223;
+        c = static_cast<char>(seed >> 24);
+    }
+    for (quint32 offset = 0; offset < 8; ++offset) {
+        for (quint32 len = 0; len <= 1024; ++len) {
+            const quint16 init = static_cast<quint16>(len * 40503u);
+            const quint16 ref = dfti::crc16CCITTScalar(&buf[offset], len,
+                init);
+            for (auto impl : impls) {
+                mismatches += impl.func(&buf[offset], len, init) != ref;
+            }
+        }
+    }
+    // VN-200 packets: a good checksum validates and any flipped bit does
+    // not.
+    const size_t packetSize = 102;
+    quint64 packetErrors = 0;
+    for (quint32 i = 0; i < 1000; ++i) {
+        char pkt[packetSize];
+        memcpy(pkt, &buf[i * packetSize % (buf.size() - packetSize)],
+            packetSize);
+        pkt[0] = '\xfa';
+        const quint16 crc = dfti::crc16CCITTScalar(pkt + 1, packetSize - 3);
+        pkt[packetSize - 2] = static_cast<char>(crc >> 8);
+        pkt[packetSize - 1] = static_cast<char>(crc & 0xff);
+        packetErrors += !dfti::validateVN200Checksum(pkt, packetSize);
+        const quint32 bit = 8 + i % (8 * (packetSize - 1));
+        pkt[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+        packetErrors += dfti::validateVN200Checksum(pkt, packetSize);
+    }
+    printf("verify: %llu mismatches, %llu packet errors\n",
+        static_cast<unsigned long long>(mismatches),
+        static_cast<unsigned long long>(packetErrors));
+    if (mismatches || packetErrors) {
+        return 1;
+    }
+
+    // Throughput.
+    printf("%8s %8s %10s %12s\n", "arch", "impl", "bytes", "MB/s");
+    const size_t sizes[] = {packetSize - 1, buf.size()};
+    const QString arch = QSysInfo::buildCpuArchitecture();
+    volatile quint16 sink = 0;
+    for (auto size : sizes) {
+        for (auto impl : impls) {
+            QElapsedTimer timer;
+            quint64 bytes = 0;
+            timer.start();
+            do {
+                for (quint32 i = 0; i < 1000; ++i) {
+                    sink = impl.func(buf.data(), size, sink);
+                }
+                bytes += 1000 * size;
+            } while (timer.nsecsElapsed() < 1e9 * seconds);
+            printf("%8s %8s %10zu %12.1f\n", arch.toLatin1().constData(),
+                impl.name, size, 1e3 * bytes / timer.nsecsElapsed());
+        }
+    }
+    return 0;
+}
+
+
+//! Synthesize a MAVLink byte stream like an autopilot sends DFTI.
+/*!
+ *  RC_CHANNELS_RAW, SERVO_OUTPUT_RAW and ATTITUDE at 50 Hz, VFR_HUD at
+ *  10 Hz and HEARTBEAT at 1 Hz, which is about 90% of a 57600 baud link.
+ *
+ *  \param seconds Length of the stream in (autopilot) seconds.
+ *  \return Raw bytes.
+ */
+static QByteArray
+synthesizeMAVLink(quint32 seconds)
+{
+    QByteArray stream;
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    mavlink_message_t msg;
+    auto append = [&]() {
+        const quint16 len = mavlink_msg_to_send_buffer(buf, &msg);
+        stream.append(reinterpret_cast<const char *>(buf), len);
+    };
+    const quint8 sys = 1;
+    const quint8 comp = 1;
+    for (quint32 tick = 0; tick < 50 * seconds; ++tick) {
+        const quint32 ms = 20 * tick;
+        const float t = 1e-3f * ms;
+        const quint16 pwm = 1500 + static_cast<qint16>(400 * std::sin(t));
+        if (!(tick % 50)) {
+            mavlink_msg_heartbeat_pack(sys, comp, &msg, MAV_TYPE_FIXED_WING,
+                MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+            append();
+        }
+        mavlink_msg_rc_channels_raw_pack(sys, comp, &msg, ms, 0, pwm, pwm,
+            1500, 1100, 1500, 1500, 1500, 1500, 255);
+        append();
+        mavlink_msg_servo_output_raw_pack(sys, comp, &msg, 1000 * ms, 0, pwm,
+            pwm, 1500, 1100, 1500, 1500, 1500, 1500);
+        append();
+        mavlink_msg_attitude_pack(sys, comp, &msg, ms, 0.1f * std::sin(t),
+            0.05f * std::cos(t), t, 0.1f, 0.05f, 0.01f);
+        append();
+        if (!(tick % 5)) {
+            mavlink_msg_vfr_hud_pack(sys, comp, &msg, 25, 24, 90, 55, 120,
+                0.5f);
+            append();
+        }
+    }
+    return stream;
+}
+
+
+//! Benchmark MAVLink parsing in the autopilot driver.
+/*!
+ *  Feeds a MAVLink byte stream (a recording if one is given, otherwise a
+ *  synthesized one) to Autopilot::processBytes at 10x the real-time rate of a
+ *  57600 baud link, in 64 byte chunks as a UART delivers them. The bulk
+ *  path parses each chunk with one call; the per_byte path makes one call
+ *  per byte as readData used to. Reports parse time, CPU load at that rate,
+ *  and the number of messages parsed and measurements published.
+ *
+ *  \param seconds Length of the synthesized stream in seconds.
+ *  \param input Path to a recorded raw MAVLink stream, or empty.
+ *  \return Exit code.
+ */
+static int
+benchMAVLink(quint32 seconds, const QString &input)
+{
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) {
+        qWarning() << "Failed to create temporary directory";
+        return -1;
+    }
+    QDir dir(tmp.path());
+
+    QByteArray stream;
+    if (input.isEmpty()) {
+        stream = synthesizeMAVLink(seconds);
+    } else {
+        QFile recording(input);
+        if (!recording.open(QFile::ReadOnly)) {
+            qWarning() << "Failed to open" << input;
+            return -1;
+        }
+        stream = recording.readAll();
+    }
+
+    // 57600 baud 8N1 is 5760 bytes/s.
+    const double speedup = 10;
+    const double bytesPerSec = speedup * 57600 / 10;
+    const qint64 chunk = 64;
+
+    printf("%8s %10s %10s %10s %12s %8s\n", "mode", "bytes", "messages",
+        "published", "usec/chunk", "cpu_%");
+    const QString modes[] = {"bulk", "per_byte"};
+    for (auto mode : modes) {
+        dfti::Settings settings(writeRCFile(dir, "[mavlink]\n"),
+            dfti::DebugMode::DEBUG_NONE);
+        dfti::Autopilot ap(&settings);
+        quint64 published = 0;
+        QObject::connect(&ap, &dfti::Autopilot::measurementUpdate,
+            [&published](dfti::APData) { ++published; });
+
+        QElapsedTimer wall;
+        QElapsedTimer timer;
+        qint64 parseNs = 0;
+        auto start = std::chrono::steady_clock::now();
+        wall.start();
+        for (qint64 pos = 0; pos < stream.size(); pos += chunk) {
+            // Wait until the chunk would have arrived.
+            std::this_thread::sleep_until(start + std::chrono::microseconds(
+                static_cast<qint64>(1e6 * (pos + chunk) / bytesPerSec)));
+            const qint64 len = qMin(chunk, stream.size() - pos);
+            const char *bytes = stream.constData() + pos;
+            timer.start();
+            if (mode == "bulk") {
+                ap.processBytes(bytes, len, dfti::getMonotonicNsec());
+            } else {
+                for (qint64 i = 0; i < len; ++i) {
+                    ap.processBytes(bytes + i, 1, dfti::getMonotonicNsec());
+                }
+            }
+            parseNs += timer.nsecsElapsed();
+        }
+        const qint64 chunks = (stream.size() + chunk - 1) / chunk;
+        printf("%8s %10d %10llu %10llu %12.2f %8.3f\n",
+            mode.toLatin1().constData(), stream.size(),
+            static_cast<unsigned long long>(ap.rxStats().packetsParsed),
+            static_cast<unsigned long long>(published),
+            1e-3 * parseNs / chunks, 100.0 * parseNs / wall.nsecsElapsed());
+    }
+    return 0;
+}
+
+
+//! Decode a uADC line the way the driver did before decodeUADCPacket.
+/*!
+ *  Kept as the reference decodeUADCPacket must match bit for bit.
+ *
+ *  \param line One line from the uADC, including the terminator.
+ *  \param data Structure to decode into.
+ *  \return True if the packet checksum is correct.
+ */
+static bool
+referenceDecodeUADC(const QByteArray &line, dfti::uADCData &data)
+{
+    QByteArray pkt = line.left(dfti::uadcPktLen);
+    if (!dfti::validateUADCChecksum(pkt)) {
+        return false;
+    }
+    data.id = pkt.left(5).toInt();
+    data.iasMps = pkt.mid(dfti::uadcPktIasPos, dfti::uadcPktIasLen).toFloat();
+    data.aoaDeg = pkt.mid(dfti::uadcPktAoAPos, dfti::uadcPktAoALen).toFloat();
+    data.aosDeg = pkt.mid(dfti::uadcPktAoSPos, dfti::uadcPktAoSLen).toFloat();
+    data.altM = pkt.mid(dfti::uadcPktAltPos, dfti::uadcPktAltLen).toInt();
+    data.ptPa = pkt.mid(dfti::uadcPktPtPos, dfti::uadcPktPtLen).toInt();
+    data.psPa = pkt.mid(dfti::uadcPktPsPos, dfti::uadcPktPsLen).toInt();
+    return true;
+}
+
+
+//! Compare two uADC measurements bit for bit.
+/*!
+ *  \param a First measurement.
+ *  \param b Second measurement.
+ *  \return True if every decoded field is identical.
+ */
+static bool
+sameUADCData(const dfti::uADCData &a, const dfti::uADCData &b)
+{
+    return a.id == b.id && !memcmp(&a.iasMps, &b.iasMps, sizeof(float)) &&
+        !memcmp(&a.aoaDeg, &b.aoaDeg, sizeof(float)) &&
+        !memcmp(&a.aosDeg, &b.aosDeg, sizeof(float)) && a.altM == b.altM &&
+        a.ptPa == b.ptPa && a.psPa == b.psPa;
+}
+
+
+//! Synthesize random uADC lines in the documented format.
+/*!
+ *  \param count Number of lines.
+ *  \return Lines, including "\r\n" terminators.
+ */
+static QByteArray
+synthesizeUADC(quint32 count)
+{
+    QByteArray stream;
+    quint32 seed = 1;
+    auto next = [&seed](quint32 range) {
+        seed = 1664525 * seed + 1013904223;
+        return (seed >> 8) % range;
+    };
+    char line[dfti::uadcPktLen + 2];
+    for (quint32 i = 0; i < count; ++i) {
+        snprintf(line, sizeof(line),
+            "%05u, %05.2f, %+06.2f, %+06.2f, %+05d, %06u, %06u, ", i % 100000,
+            next(10000) / 100.0, (next(20000) - 9999.0) / 100.0,
+            (next(20000) - 9999.0) / 100.0, static_cast<int>(next(20000)) -
+            9999, 90000 + next(20000), 90000 + next(20000));
+        quint8 cksum = 0;
+        for (quint8 j = 0; j < dfti::uadcPktCksumPos; ++j) {
+            cksum ^= static_cast<quint8>(line[j]);
+        }
+        snprintf(line + dfti::uadcPktCksumPos,
+            sizeof(line) - dfti::uadcPktCksumPos, "%02X\r\n", cksum);
+        stream.append(line, dfti::uadcPktLen + 1);
+    }
+    return stream;
+}
+
+
+//! Verify and benchmark the allocation-free uADC decoder.
+/*!
+ *  First checks decimalToFloat and decimalToInt against QByteArray::toFloat
+ *  and toInt for every value of every uADC field format and for random
+ *  strings (including ones that take the fallback path), and checks that
+ *  decodeUADCPacket decodes random packets bit for bit like the old
+ *  QByteArray based decoder. Then reports the time and heap allocations
+ *  per packet for both decoders and for the whole driver receive path, and
+ *  checks that the in place decoder made none. Allocations are only
+ *  counted with glibc, so elsewhere that check fails.
+ *
+ *  \param seconds Approximate run time per throughput case.
+ *  \return Exit code; nonzero if the decoders disagree or the in place
+ *      decoder allocated.
+ */
+static int
+benchUADC(quint32 seconds)
+{
+    quint64 checked = 0;
+    quint64 mismatches = 0;
+    char field[32];
+    auto checkFloat = [&](const char *str, int len) {
+        bool ok1 = false;
+        bool ok2 = false;
+        const float a = dfti::decimalToFloat(str, len, &ok1);
+        const float b = QByteArray(str, len).toFloat(&ok2);
+        mismatches += memcmp(&a, &b, sizeof(float)) || ok1 != ok2;
+        ++checked;
+    };
+    auto checkInt = [&](const char *str, int len) {
+        bool ok1 = false;
+        bool ok2 = false;
+        mismatches += dfti::decimalToInt(str, len, &ok1) !=
+            QByteArray(str, len).toInt(&ok2) || ok1 != ok2;
+        mismatches += dfti::hexToInt(str, len, &ok1) !=
+            QByteArray(str, len).toInt(&ok2, 16) || ok1 != ok2;
+        ++checked;
+    };
+    // Every value of the fixed-width field formats.
+    for (int i = 0; i < 10000; ++i) {
+        checkFloat(field, snprintf(field, sizeof(field), "%05.2f", i / 100.0));
+    }
+    for (int i = -9999; i <= 9999; ++i) {
+        checkFloat(field, snprintf(field, sizeof(field), "%+06.2f",
+            i / 100.0));
+        checkInt(field, snprintf(field, sizeof(field), "%+05d", i));
+    }
+    for (int i = 0; i < 1000000; ++i) {
+        checkInt(field, snprintf(field, sizeof(field), "%06d", i));
+    }
+    // Random strings, mostly numbers but with junk, whitespace and exponents
+    // mixed in.
+    const char alphabet[] = "0123456789012345678901234567890123456789"
+        "+-...  eExaF";
+    quint32 seed = 7;
+    for (quint32 i = 0; i < 1000000; ++i) {
+        seed = 1664525 * seed + 1013904223;
+        const int len = 1 + (seed >> 28);
+        for (int j = 0; j < len; ++j) {
+            seed = 1664525 * seed + 1013904223;
+            field[j] = alphabet[(seed >> 8) % (sizeof(alphabet) - 1)];
+        }
+        checkFloat(field, len);
+        checkInt(field, len);
+    }
+    // Whole packets.
+    const quint32 count = 100000;
+    const qint64 lineLen = dfti::uadcPktLen + 1;
+    const QByteArray stream = synthesizeUADC(count);
+    quint64 packetErrors = 0;
+    for (quint32 i = 0; i < count; ++i) {
+        const char *line = stream.constData() + i * lineLen;
+        dfti::uADCData a;
+        dfti::uADCData b;
+        packetErrors += !dfti::decodeUADCPacket(line, dfti::uadcPktLen, a) ||
+            !referenceDecodeUADC(QByteArray(line, lineLen), b) ||
+            !sameUADCData(a, b);
+    }
+    printf("verify: %llu fields, %llu mismatches, %llu packet errors\n",
+        static_cast<unsigned long long>(checked),
+        static_cast<unsigned long long>(mismatches),
+        static_cast<unsigned long long>(packetErrors));
+    if (mismatches || packetErrors) {
+        return 1;
+    }
+
+    // Throughput and allocations.
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) {
+        qWarning() << "Failed to create temporary directory";
+        return -1;
+    }
+    dfti::Settings settings(writeRCFile(QDir(tmp.path()), "[uadc]\n"),
+        dfti::DebugMode::DEBUG_NONE);
+    dfti::uADC adc(&settings);
+    printf("%10s %10s %12s %14s\n", "decoder", "packets", "ns/packet",
+        "allocs/packet");
+    const QString modes[] = {"qbytearray", "in_place", "driver"};
+    quint64 inPlaceAllocations = 0;
+    for (auto mode : modes) {
+        dfti::uADCData data;
+        quint64 packets = 0;
+        QElapsedTimer timer;
+        // Comparing a QString with a literal converts the literal, so
+        // decide the mode before counting.
+        const bool reference = (mode == "qbytearray");
+        const bool inPlace = (mode == "in_place");
+        allocations = 0;
+        countAllocations = true;
+        timer.start();
+        do {
+            if (reference) {
+                for (quint32 i = 0; i < count; ++i) {
+                    referenceDecodeUADC(QByteArray::fromRawData(
+                        stream.constData() + i * lineLen, lineLen), data);
+                }
+            } else if (inPlace) {
+                for (quint32 i = 0; i < count; ++i) {
+                    dfti::decodeUADCPacket(stream.constData() + i * lineLen,
+                        dfti::uadcPktLen, data);
+                }
+            } else {
+                // 64 byte chunks, as a UART delivers them.
+                for (qint64 pos = 0; pos < stream.size(); pos += 64) {
+                    adc.processBytes(stream.constData() + pos,
+                        qMin<qint64>(64, stream.size() - pos),
+                        dfti::getMonotonicNsec());
+                }
+            }
+            packets += count;
+        } while (timer.nsecsElapsed() < 1e9 * seconds);
+        const qint64 ns = timer.nsecsElapsed();
+        countAllocations = false;
+        if (inPlace) {
+            inPlaceAllocations = allocations;
+        }
+        printf("%10s %10llu %12.1f %14.3f\n", mode.toLatin1().constData(),
+            static_cast<unsigned long long>(packets),
+            static_cast<double>(ns) / packets, allocationsPerPacket(packets));
+    }
+    if (adc.rxStats().checksumFailures) {
+        qWarning() << "Driver rejected" << adc.rxStats().checksumFailures
+                   << "packets";
+        return 1;
+    }
+    if (!allocationsCounted || inPlaceAllocations) {
+        qWarning() << "In place decoder allocations" << (allocationsCounted ?
+            QString::number(inPlaceAllocations) : QString("not counted"));
+        return 1;
+    }
+    return 0;
+}
+
+
+//! Decode a RIO line the way the driver did before decodeRIOPacket.
+/*!
+ *  Kept as the reference decodeRIOPacket must match bit for bit.
+ *
+ *  \param pkt One line from the RIO, including the terminator.
+ *  \param values Decoded values.
+ *  \return True if the packet checksum is correct.
+ */
+static bool
+referenceDecodeRIO(QByteArray pkt, std::vector<float> &values)
+{
+    pkt.replace("\r\n", "");
+    if (!dfti::validateRIOChecksum(pkt)) {
+        return false;
+    }
+    auto pktItems = pkt.replace("$$$", "").split(dfti::rioSep);
+    pktItems.removeLast();
+    values.clear();
+    for (auto value : pktItems) {
+        values.push_back(value.toFloat());
+    }
+    return true;
+}
+
+
+//! Synthesize RIO lines like the RIO sketch prints.
+/*!
+ *  Integer encoder angles followed by a fractional RPM value, 1 to
+ *  rioMaxValues values per line.
+ *
+ *  \param count Number of lines.
+ *  \param offsets Set to the offset of each line, plus the stream end.
+ *  \return Lines, including "\r\n" terminators.
+ */
+static QByteArray
+synthesizeRIO(quint32 count, std::vector<qint64> &offsets)
+{
+    QByteArray stream;
+    quint32 seed = 3;
+    auto next = [&seed](quint32 range) {
+        seed = 1664525 * seed + 1013904223;
+        return (seed >> 8) % range;
+    };
+    offsets.clear();
+    for (quint32 i = 0; i < count; ++i) {
+        QByteArray pkt(dfti::rioStart);
+        const quint32 n = 1 + next(dfti::rioMaxValues);
+        for (quint32 j = 0; j + 1 < n; ++j) {
+            pkt.append(QByteArray::number(next(361)));
+            pkt.append(dfti::rioSep);
+        }
+        pkt.append(QByteArray::number(next(1000000) / 100.0, 'f', 2));
+        pkt.append(dfti::rioSep);
+        quint8 cksum = 0;
+        for (auto c : pkt) {
+            cksum ^= static_cast<quint8>(c);
+        }
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02x", cksum);
+        pkt.append(hex);
+        pkt.append("\r\n");
+        offsets.push_back(stream.size());
+        stream.append(pkt);
+    }
+    offsets.push_back(stream.size());
+    return stream;
+}
+
+
+//! Verify and benchmark the allocation-free RIO tokenizer.
+/*!
+ *  First checks that decodeRIOPacket decodes random lines bit for bit like
+ *  the old split based decoder. Then reports the time and heap allocations
+ *  per packet for both decoders and for the whole driver receive path,
+ *  including handing each measurement to a consumer queue.
+ *
+ *  \param seconds Approximate run time per throughput case.
+ *  \return Exit code; nonzero if the decoders disagree.
+ */
+static int
+benchRIO(quint32 seconds)
+{
+    const quint32 count = 100000;
+    std::vector<qint64> offsets;
+    const QByteArray stream = synthesizeRIO(count, offsets);
+    quint64 packetErrors = 0;
+    std::vector<float> values;
+    for (quint32 i = 0; i < count; ++i) {
+        const char *line = stream.constData() + offsets[i];
+        const qint64 len = offsets[i + 1] - offsets[i];
+        dfti::RIOData data;
+        if (!dfti::decodeRIOPacket(line, len, data) ||
+            !referenceDecodeRIO(QByteArray(line, len), values) ||
+            data.numValues != values.size() ||
+            memcmp(data.values, values.data(), values.size() * sizeof(float))) {
+            ++packetErrors;
+        }
+    }
+    printf("verify: %u packets, %llu packet errors\n", count,
+        static_cast<unsigned long long>(packetErrors));
+    if (packetErrors) {
+        return 1;
+    }
+
+    // Throughput and allocations.
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) {
+        qWarning() << "Failed to create temporary directory";
+        return -1;
+    }
+    dfti::Settings settings(writeRCFile(QDir(tmp.path()), "[rio]\n"),
+        dfti::DebugMode::DEBUG_NONE);
+    dfti::RIO rio(&settings);
+    dfti::RIO::Queue queue;
+    rio.attachQueue(&queue);
+    quint64 delivered = 0;
+    printf("%10s %10s %12s %14s\n", "decoder", "packets", "ns/packet",
+        "allocs/packet");
+    const QString modes[] = {"qbytearray", "in_place", "driver"};
+    for (auto mode : modes) {
+        dfti::RIOData data;
+        quint64 packets = 0;
+        QElapsedTimer timer;
+        values.reserve(dfti::rioMaxValues);
+        allocations = 0;
+        countAllocations = true;
+        timer.start();
+        do {
+            if (mode == "qbytearray") {
+                for (quint32 i = 0; i < count; ++i) {
+                    referenceDecodeRIO(QByteArray::fromRawData(
+                        stream.constData() + offsets[i],
+                        offsets[i + 1] - offsets[i]), values);
+                }
+            } else if (mode == "in_place") {
+                for (quint32 i = 0; i < count; ++i) {
+                    dfti::decodeRIOPacket(stream.constData() + offsets[i],
+                        offsets[i + 1] - offsets[i], data);
+                }
+            } else {
+                // 64 byte chunks, as a UART delivers them, with the consumer
+                // draining its queue after each.
+                for (qint64 pos = 0; pos < stream.size(); pos += 64) {
+                    rio.processBytes(stream.constData() + pos,
+                        qMin<qint64>(64, stream.size() - pos),
+                        dfti::getMonotonicNsec());
+                    queue.drain([&delivered](const dfti::RIOData &) {
+                        ++delivered;
+                    });
+                }
+            }
+            packets += count;
+        } while (timer.nsecsElapsed() < 1e9 * seconds);
+        const qint64 ns = timer.nsecsElapsed();
+        countAllocations = false;
+        printf("%10s %10llu %12.1f %14.3f\n", mode.toLatin1().constData(),
+            static_cast<unsigned long long>(packets),
+            static_cast<double>(ns) / packets, allocationsPerPacket(packets));
+    }
+    if (rio.rxStats().checksumFailures || queue.overflows() ||
+        delivered != rio.rxStats().packetsParsed) {
+        qWarning() << "Driver rejected" << rio.rxStats().checksumFailures
+                   << "packets, queue dropped" << queue.overflows();
+        return 1;
+    }
+    return 0;
+}
+
+
+//! Verify and benchmark the host to GPS clock correlation.
+/*!
+ *  Feeds ClockSync five minutes of simulated 200 Hz VN-200 packets from a
+ *  GPS clock running 20 ppm fast, delayed by the time on the wire plus
+ *  exponential jitter (mean 0.3 ms) and, for 1% of packets, a further
+ *  50 ms. Half way the GPS time steps by a second. Checks that converted
+ *  host times are within 100 us of GPS time once locked (except for the
+ *  ten seconds after the step) and that the drift is recovered, then
+ *  reports the cost of a conversion.
+ *
+ *  \param seconds Approximate run time of the throughput case.
+ *  \return Exit code; nonzero if a check fails.
+ */
+static int
+benchClockSync(quint32 seconds)
+{
+    const quint32 rateHz = 200;
+    const quint32 durationSec = 300;
+    const quint64 periodNs = 1000000000ull / rateHz;
+    const quint64 wireNs = 9000000;
+    const double drift = 20e-6;
+    const quint64 mono0 = 1000000000000ull;
+    const quint64 gps0 = 1200000000000000000ull;
+    std::mt19937_64 rng(1);
+    std::exponential_distribution<double> jitter(1 / 300e3);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    dfti::ClockSync sync;
+    quint64 step = 0;
+    double maxErrNs = 0;
+    quint64 unlocked = 0;
+    for (quint32 i = 0; i < rateHz * durationSec; ++i) {
+        const quint64 mono = mono0 + i * periodNs;
+        if (i == rateHz * durationSec / 2) {
+            step = 1000000000ull;
+        }
+        const quint64 gps = gps0 + step + (mono - mono0) +
+            static_cast<quint64>(drift * (mono - mono0));
+        double delay = wireNs + jitter(rng);
+        if (uniform(rng) < 0.01) {
+            delay += 50e6;
+        }
+        sync.addSample(mono + static_cast<quint64>(delay) - wireNs, gps);
+
+        // Skip the start and the ten seconds after the step.
+        const quint32 sec = i / rateHz;
+        if (sec < 10 ||
+            (sec >= durationSec / 2 && sec < durationSec / 2 + 10)) {
+            continue;
+        }
+        const quint64 converted = sync.toGpsNs(mono);
+        if (!converted) {
+            ++unlocked;
+            continue;
+        }
+        maxErrNs = std::max(maxErrNs, std::fabs(static_cast<double>(
+            static_cast<qint64>(converted - gps))));
+    }
+    const dfti::ClockSyncStats stats = sync.stats();
+    printf("verify: max error %.1f us, drift %.1f ppb (true %.1f), rms %.1f "
+        "us, %llu outliers, %u resets, %llu unlocked\n", 1e-3 * maxErrNs,
+        stats.driftPpb, 1e9 * drift, 1e-3 * stats.rmsNs,
+        static_cast<unsigned long long>(stats.rejected), stats.resets,
+        static_cast<unsigned long long>(unlocked));
+    if (maxErrNs > 100e3 || std::fabs(stats.driftPpb - 1e9 * drift) > 100 ||
+        stats.resets != 1 || unlocked) {
+        return 1;
+    }
+
+    // Conversion cost.
+    QElapsedTimer timer;
+    quint64 count = 0;
+    volatile quint64 sink = 0;
+    timer.start();
+    do {
+        for (quint32 i = 0; i < 100000; ++i) {
+            sink += sync.toGpsNs(mono0 + i * periodNs);
+        }
+        count += 100000;
+    } while (timer.nsecsElapsed() < 1e9 * seconds);
+    printf("%12s %12s\n", "conversions", "ns/call");
+    printf("%12llu %12.1f\n", static_cast<unsigned long long>(count),
+        static_cast<double>(timer.nsecsElapsed()) / count);
+    return 0;
+}
+
+
+//! Time a clock or conversion call.
+/*!
+ *  \param f Function to call; its result is accumulated so it is not
+ *      optimized away.
+ *  \param seconds Approximate run time.
+ *  \return Nanoseconds per call.
+ */
+template <typename F>
+static double
+timeCall(F f, quint32 seconds)
+{
+    QElapsedTimer timer;
+    quint64 count = 0;
+    volatile quint64 sink = 0;
+    timer.start();
+    do {
+        for (quint32 i = 0; i < 100000; ++i) {
+            sink += f(i);
+        }
+        count += 100000;
+    } while (timer.nsecsElapsed() < 1e9 * seconds);
+    return static_cast<double>(timer.nsecsElapsed()) / count;
+}
+
+
+//! Verify and benchmark the host clocks and GPS/Unix conversion.
+/*!
+ *  Checks the GPS/Unix conversion against known epochs, round trips Unix
+ *  times either side of every leap second and a million random ones since
+ *  the GPS epoch, and shows the error of the float conversion it replaced
+ *  at the current epoch. Then reports the cost of reading each clock and of
+ *  a conversion.
+ *
+ *  \param seconds Approximate run time of each throughput case.
+ *  \return Exit code; nonzero if a check fails.
+ */
+static int
+benchTime(quint32 seconds)
+{
+    const quint64 sec = dfti::nsecPerSec;
+    quint32 failures = 0;
+
+    // Known epochs: the GPS epoch, and 1 JAN 2017 after the last leap second.
+    if (dfti::gpsToUnixNsec(0) != dfti::gpsEpochUnixSec * sec ||
+        dfti::unixToGpsNsec(1483228800ull * sec) != 1167264018ull * sec ||
+        dfti::gpsToUnixNsec(1167264016ull * sec) != 1483228799ull * sec) {
+        ++failures;
+    }
+
+    // Round trips around each leap second and at random times.
+    for (quint64 u = dfti::gpsEpochUnixSec; u < 1500000000ull; u += 86400) {
+        for (qint64 d = -2; d <= 2; ++d) {
+            const quint64 ns = (u + d) * sec + 999999999;
+            if (u + d >= dfti::gpsEpochUnixSec &&
+                dfti::gpsToUnixNsec(dfti::unixToGpsNsec(ns)) != ns) {
+                ++failures;
+            }
+        }
+    }
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<quint64> when(
+        dfti::gpsEpochUnixSec * sec, 2000000000ull * sec);
+    for (quint32 i = 0; i < 1000000; ++i) {
+        const quint64 ns = when(rng);
+        if (dfti::gpsToUnixNsec(dfti::unixToGpsNsec(ns)) != ns) {
+            ++failures;
+        }
+    }
+
+    // The float conversion this replaced, at the current epoch.
+    const quint64 gpsNow = dfti::unixToGpsNsec(dfti::realtimeNsec());
+    const float nsToUs = 1e-3;
+    const quint64 floatUs = static_cast<quint64>(
+        315964800000000ull + gpsNow * nsToUs);
+    const quint64 exactUs = gpsNow / 1000 + 315964800000000ull;
+    printf("verify: %u conversion failures, GPS - UTC %u s, float "
+        "conversion error %.3f s\n", failures,
+        dfti::leapSecondsAtGps(gpsNow / sec),
+        1e-6 * std::fabs(static_cast<double>(
+            static_cast<qint64>(floatUs - exactUs))));
+    if (failures) {
+        return 1;
+    }
+
+    printf("%-24s %12s\n", "call", "ns/call");
+    printf("%-24s %12.1f\n", "monotonicNsec", timeCall(
+        [](quint32) { return dfti::monotonicNsec(); }, seconds));
+    printf("%-24s %12.1f\n", "realtimeNsec", timeCall(
+        [](quint32) { return dfti::realtimeNsec(); }, seconds));
+    printf("%-24s %12.1f\n", "steady_clock::now", timeCall(
+        [](quint32) {
+            return static_cast<quint64>(std::chrono::steady_clock::now()
+                .time_since_epoch().count());
+        }, seconds));
+    printf("%-24s %12.1f\n", "gettimeofday", timeCall(
+        [](quint32) {
+            struct timeval tv;
+            gettimeofday(&tv, nullptr);
+            return static_cast<quint64>(tv.tv_usec);
+        }, seconds));
+    printf("%-24s %12.1f\n", "getTimeUsec", timeCall(
+        [](quint32) { return dfti::getTimeUsec(); }, seconds));
+    printf("%-24s %12.1f\n", "gpsToUnixNsec", timeCall(
+        [gpsNow](quint32 i) { return dfti::gpsToUnixNsec(gpsNow + i); },
+        seconds));
+    return 0;
+}
+
+
+//! Lateness below which a fraction of the ticks fell.
+/*!
+ *  \param stats Scheduler statistics.
+ *  \param fraction Fraction of the ticks, 0 to 1.
+ *  \return Upper edge of the histogram bin reaching the fraction, us.
+ */
+static quint32
+latenessPercentile(const dfti::SchedulerStats &stats, double fraction)
+{
+    quint64 seen = 0;
+    for (quint32 i = 0; i < dfti::numJitterBins; ++i) {
+        seen += stats.histogram[i];
+        if (seen >= fraction * stats.ticks) {
+            return dfti::jitterBinUsec(i);
+        }
+    }
+    return dfti::jitterBinUsec(dfti::numJitterBins - 1);
+}
+
+
+//! Verify and benchmark the log tick scheduler.
+/*!
+ *  Runs a Scheduler at log rates from 100 Hz to 2 kHz in this thread's
+ *  event loop and checks that the deadlines passed (ticks plus missed
+ *  ticks) match the requested rate. Alongside the achieved rate it shows
+ *  the rate the old QTimer path gave for the same log_rate_hz, whose period
+ *  went through a quint8 rate and whole milliseconds, and the lateness of
+ *  the ticks from their deadlines.
+ *
+ *  \param seconds Run time per rate.
+ *  \return Exit code; nonzero if a check fails.
+ */
+static int
+benchSchedule(quint32 seconds)
+{
+    const quint32 rates[] = {100, 300, 400, 1000, 2000};
+    int result = 0;
+    printf("%8s %8s %10s %8s %8s %8s %10s\n", "rate", "qtimer", "achieved",
+        "missed", "p50 us", "p99 us", "max us");
+    for (quint32 rate : rates) {
+        dfti::Scheduler scheduler;
+        quint64 ticks = 0;
+        QObject::connect(&scheduler, &dfti::Scheduler::tick,
+            [&ticks]() { ++ticks; });
+        QEventLoop loop;
+        QTimer::singleShot(1000 * seconds, &loop, &QEventLoop::quit);
+        QElapsedTimer timer;
+        timer.start();
+        if (!scheduler.start(dfti::hzToUsec(rate))) {
+            return 1;
+        }
+        loop.exec();
+        const double elapsed = 1e-9 * timer.nsecsElapsed();
+        const dfti::SchedulerStats stats = scheduler.stats();
+        scheduler.stop();
+
+        // Old path: the rate was cast to quint8 and the float period
+        // truncated to whole milliseconds by QTimer::start.
+        const quint8 oldRate = static_cast<quint8>(rate);
+        const int oldMs = oldRate ? static_cast<int>(1e3 / oldRate) : 0;
+        const double oldHz = oldMs ? 1e3 / oldMs : 0;
+
+        const double deadlines = stats.ticks + stats.missed;
+        const double expected = rate * elapsed;
+        printf("%8u %8.1f %10.1f %8llu %8u %8u %10.1f\n", rate, oldHz,
+            deadlines / elapsed, static_cast<unsigned long long>(stats.missed),
+            latenessPercentile(stats, 0.5), latenessPercentile(stats, 0.99),
+            1e-3 * stats.maxLateNs);
+        if (ticks != stats.ticks ||
+            std::fabs(deadlines - expected) > 2 + 0.002 * expected) {
+            result = 1;
+        }
+    }
+    printf("verify: %s\n", result ? "deadline count off the requested rate" :
+        "deadline counts match the requested rates");
+    return result;
+}
+
+
+//! Result of running the sensors in one threading layout.
+struct LayoutResult
+{
+    //! Packets the simulators wrote.
+    quint64 sent{0};
+    //! Measurements that reached the consumer.
+    quint64 received{0};
+    //! Measurements dropped by full queues.
+    quint64 dropped{0};
+    //! Process CPU time, percent of one core.
+    double cpuPct{0};
+    //! Process context switches per second.
+    double switchesPerSec{0};
+    //! VN-200 write to parse latencies, microseconds, sorted.
+    std::vector<double> latencyUsec;
+};
+
+
+//! Run the serial sensors against simulated ports in one layout.
+/*!
+ *  \param mode Threading layout.
+ *  \param backend Serial port backend.
+ *  \param seconds Run time.
+ *  \param result Results.
+ *  \return False if a port could not be opened.
+ */
+static bool
+runLayout(dfti::ThreadMode mode, dfti::SerialBackend backend,
+    quint32 seconds, LayoutResult &result)
+{
+    QTemporaryDir tmp;
+    dfti::Settings settings(writeRCFile(QDir(tmp.path()),
+        QString("[dfti]\nserial_backend = %1\n[vn200]\nbaud_rate = 921600\n")
+            .arg(backend == dfti::SerialBackend::TERMIOS ? "termios" : "qt")),
+        dfti::DebugMode::DEBUG_NONE);
+
+    // The rates of a fast flight configuration.
+    std::unique_ptr<dfti::PtySimulator> sims[] = {
+        std::unique_ptr<dfti::PtySimulator>(new dfti::PtySimulator(
+            dfti::SimSensor::AUTOPILOT, 50, 57600, 0)),
+        std::unique_ptr<dfti::PtySimulator>(new dfti::PtySimulator(
+            dfti::SimSensor::RIO, 325.5, 115200, 0)),
+        std::unique_ptr<dfti::PtySimulator>(new dfti::PtySimulator(
+            dfti::SimSensor::UADC, 100, 115200, 0)),
+        std::unique_ptr<dfti::PtySimulator>(new dfti::PtySimulator(
+            dfti::SimSensor::VN200, 800, 921600, 0))
+    };
+    for (auto &sim : sims) {
+        if (!sim->open()) {
+            return false;
+        }
+    }
+
+    // Sensors are deleted in their own thread once it finishes.
+    dfti::Autopilot *ap = new dfti::Autopilot(&settings);
+    dfti::RIO *rio = new dfti::RIO(&settings);
+    dfti::uADC *adc = new dfti::uADC(&settings);
+    dfti::VN200 *ins = new dfti::VN200(&settings);
+    dfti::SerialSensor *sensors[] = {ap, rio, adc, ins};
+    dfti::Autopilot::Queue apQueue;
+    dfti::RIO::Queue rioQueue;
+    dfti::uADC::Queue adcQueue;
+    dfti::VN200::Queue insQueue;
+    ap->attachQueue(&apQueue);
+    rio->attachQueue(&rioQueue);
+    adc->attachQueue(&adcQueue);
+    ins->attachQueue(&insQueue);
+    for (quint32 i = 0; i < 4; ++i) {
+        sensors[i]->configureSerial(sims[i]->portName());
+    }
+
+    std::vector<QThread *> threads;
+    dfti::Reactor *reactor = nullptr;
+    if (mode == dfti::ThreadMode::REACTOR) {
+        QThread *thread = new QThread();
+        reactor = new dfti::Reactor(&settings);
+        reactor->moveToThread(thread);
+        for (auto sensor : sensors) {
+            sensor->moveToThread(thread);
+            reactor->addSensor(sensor);
+        }
+        QObject::connect(thread, &QThread::started, reactor,
+            &dfti::Reactor::threadStart);
+        threads.push_back(thread);
+    } else {
+        for (auto sensor : sensors) {
+            QThread *thread = new QThread();
+            sensor->moveToThread(thread);
+            QObject::connect(thread, &QThread::started, sensor,
+                &dfti::SerialSensor::threadStart);
+            threads.push_back(thread);
+        }
+    }
+
+    // The host time the simulator stamped each VN-200 packet with is its
+    // GPS time; map it onto the monotonic clock the parse is stamped with.
+    const qint64 realToMonoNs = static_cast<qint64>(dfti::realtimeNsec() -
+        dfti::monotonicNsec());
+    auto consume = [&]() {
+        result.received += apQueue.drain([](const dfti::APData &) {});
+        result.received += rioQueue.drain([](const dfti::RIOData &) {});
+        result.received += adcQueue.drain([](const dfti::uADCData &) {});
+        result.received += insQueue.drain([&](const dfti::VN200Data &d) {
+            const qint64 sentNs = static_cast<qint64>(
+                dfti::gpsToUnixNsec(d.gpsTimeNs)) - realToMonoNs;
+            result.latencyUsec.push_back(
+                1e-3 * (static_cast<qint64>(d.rxTimeNs) - sentNs));
+        });
+    };
+
+    for (auto thread : threads) {
+        thread->start();
+    }
+    for (auto &sim : sims) {
+        sim->start();
+    }
+    struct rusage before;
+    struct rusage after;
+    getrusage(RUSAGE_SELF, &before);
+    QElapsedTimer wall;
+    wall.start();
+    while (wall.nsecsElapsed() < 1e9 * seconds) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        consume();
+    }
+    getrusage(RUSAGE_SELF, &after);
+    const double elapsed = 1e-9 * wall.nsecsElapsed();
+    for (auto &sim : sims) {
+        sim->stop();
+        result.sent += sim->stats().packets;
+    }
+
+    // Let the sensors finish what is in flight, then shut down.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    consume();
+    result.dropped = apQueue.overflows() + rioQueue.overflows() +
+        adcQueue.overflows() + insQueue.overflows();
+    if (reactor) {
+        reactor->stop();
+        reactor->deleteLater();
+    }
+    for (auto sensor : sensors) {
+        sensor->deleteLater();
+    }
+    for (auto thread : threads) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+
+    auto usec = [](const struct timeval &tv) {
+        return 1e6 * tv.tv_sec + tv.tv_usec;
+    };
+    const double cpuUsec = usec(after.ru_utime) - usec(before.ru_utime) +
+        usec(after.ru_stime) - usec(before.ru_stime);
+    result.cpuPct = 100.0 * 1e-6 * cpuUsec / elapsed;
+    result.switchesPerSec = (after.ru_nvcsw - before.ru_nvcsw +
+        after.ru_nivcsw - before.ru_nivcsw) / elapsed;
+    std::sort(result.latencyUsec.begin(), result.latencyUsec.end());
+    return true;
+}
+
+
+//! Print the layout results table header.
+static void
+printLayoutHeader(void)
+{
+    printf("%16s %10s %10s %8s %8s %10s %8s %8s %8s\n", "layout", "sent",
+        "received", "dropped", "cpu_%", "csw/s", "p50_us", "p99_us",
+        "max_us");
+}
+
+
+//! Print a layout result.
+/*!
+ *  \param name Layout name.
+ *  \param r Results.
+ *  \return False if measurements were lost.
+ */
+static bool
+printLayout(const char *name, const LayoutResult &r)
+{
+    auto percentile = [&r](double p) {
+        return r.latencyUsec.empty() ? 0.0 :
+            r.latencyUsec[static_cast<size_t>(
+                p * (r.latencyUsec.size() - 1))];
+    };
+    printf("%16s %10llu %10llu %8llu %8.2f %10.0f %8.1f %8.1f %8.1f\n",
+        name, static_cast<unsigned long long>(r.sent),
+        static_cast<unsigned long long>(r.received),
+        static_cast<unsigned long long>(r.dropped), r.cpuPct,
+        r.switchesPerSec, percentile(0.5), percentile(0.99),
+        percentile(1.0));
+    return !r.dropped && r.received >= 0.95 * r.sent;
+}
+
+
+//! Compare the thread-per-sensor layout with the epoll reactor.
+/*!
+ *  Runs the four serial sensors against simulated pseudo-terminals at the
+ *  rates of a fast flight configuration (VN-200 800 Hz at 921600 baud, RIO
+ *  325.5 Hz, uADC 100 Hz, autopilot 50 Hz), once with a thread per sensor
+ *  and once with a single Reactor thread, while this thread drains their
+ *  queues the way the logger does. Reports process CPU time and context
+ *  switches (the simulators and this thread included, which are the same
+ *  in both runs) and the latency from each VN-200 packet being written to
+ *  it being parsed. Checks that nearly every packet sent is received in
+ *  both layouts.
+ *
+ *  \param seconds Run time per layout.
+ *  \return Exit code; nonzero if a check fails.
+ */
+static int
+benchReactor(quint32 seconds)
+{
+    const dfti::ThreadMode modes[] = {dfti::ThreadMode::SENSOR_THREADS,
+        dfti::ThreadMode::REACTOR};
+    const char *names[] = {"threads", "reactor"};
+    bool ok = true;
+    printLayoutHeader();
+    for (quint32 i = 0; i < 2; ++i) {
+        LayoutResult r;
+        if (!runLayout(modes[i], dfti::SerialBackend::QT, seconds, r)) {
+            qWarning() << "Failed to open simulated ports";
+            return 1;
+        }
+        ok = printLayout(names[i], r) && ok;
+    }
+    printf("verify: %s\n", ok ?
+        "both layouts received the simulated packets" : "measurements lost");
+    return ok ? 0 : 1;
+}
+
+
+//! Compare the QSerialPort and termios serial backends.
+/*!
+ *  Runs the same simulated sensors as the reactor benchmark with each
+ *  serial backend, in both threading layouts. With termios the VN-200 port
+ *  waits for a whole packet (VMIN) before it is reported readable. Checks
+ *  that nearly every packet sent is received with either backend.
+ *
+ *  \param seconds Run time per case.
+ *  \return Exit code; nonzero if a check fails.
+ */
+static int
+benchTermios(quint32 seconds)
+{
+    const dfti::ThreadMode modes[] = {dfti::ThreadMode::SENSOR_THREADS,
+        dfti::ThreadMode::REACTOR};
+    const dfti::SerialBackend backends[] = {dfti::SerialBackend::QT,
+        dfti::SerialBackend::TERMIOS};
+    const char *names[] = {"qt/threads", "qt/reactor", "termios/threads",
+        "termios/reactor"};
+    bool ok = true;
+    printLayoutHeader();
+    for (quint32 b = 0; b < 2; ++b) {
+        for (quint32 m = 0; m < 2; ++m) {
+            LayoutResult r;
+            if (!runLayout(modes[m], backends[b], seconds, r)) {
+                qWarning() << "Failed to open simulated ports";
+                return 1;
+            }
+            ok = printLayout(names[2 * b + m], r) && ok;
+        }
+    }
+    printf("verify: %s\n", ok ?
+        "both backends received the simulated packets" : "measurements lost");
+    return ok ? 0 : 1;
+}
+
+
+//! Synthesize random VN-200 packets with correct checksums.
+/*!
+ *  \param count Number of packets.
+ *  \return Packets.
+ */
+static QByteArray
+synthesizeVN200(quint32 count)
+{
+    QByteArray stream;
+    quint32 seed = 5;
+    char pkt[dfti::vn200PacketLen];
+    for (quint32 i = 0; i < count; ++i) {
+        memcpy(pkt, dfti::vn200Header, dfti::vn200HeaderLen);
+        for (quint32 j = dfti::vn200HeaderLen; j < sizeof(pkt) - 2; ++j) {
+            seed = 1664525 * seed + 1013904223;
+            pkt[j] = static_cast<char>(seed >> 24);
+        }
+        const quint16 crc = dfti::crc16CCITT(pkt + 1, sizeof(pkt) - 3);
+        pkt[sizeof(pkt) - 2] = static_cast<char>(crc >> 8);
+        pkt[sizeof(pkt) - 1] = static_cast<char>(crc & 0xff);
+        stream.append(pkt, sizeof(pkt));
+    }
+    return stream;
+}
+
+
+//! Corrupt a packet stream.
+/*!
+ *  Flips a bit in every tenth packet and, if junk is set, puts bytes that
+ *  cannot start a packet in front of every 25th.
+ *
+ *  \param stream Packets.
+ *  \param offsets Offset of each packet, plus the stream end.
+ *  \param junk Insert junk between packets.
+ *  \param corrupted Set to the number of packets with a flipped bit.
+ *  \return Corrupted stream.
+ */
+static QByteArray
+corruptStream(const QByteArray &stream, const std::vector<qint64> &offsets,
+    bool junk, quint32 &corrupted)
+{
+    QByteArray out;
+    corrupted = 0;
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+        QByteArray pkt = stream.mid(offsets[i], offsets[i + 1] - offsets[i]);
+        if (junk && !(i % 25)) {
+            out.append(7, '\0');
+        }
+        if (!(i % 10)) {
+            pkt[8] = static_cast<char>(pkt[8] ^ 0x01);
+            ++corrupted;
+        }
+        out.append(pkt);
+    }
+    return out;
+}
+
+
+//! Framing results for one driver.
+struct FramingResult
+{
+    //! Packets in the stream.
+    quint32 packets{0};
+    //! Packets corrupted.
+    quint32 corrupted{0};
+    //! Receive statistics after the corrupted stream.
+    dfti::RxStats stats;
+    //! Clean stream throughput, MB/s.
+    double mbPerSec{0};
+    //! Clean stream parse time, ns per packet.
+    double nsPerPacket{0};
+    //! Heap allocations per packet.
+    double allocsPerPacket{0};
+};
+
+
+//! Run a clean and a corrupted stream through a sensor driver.
+/*!
+ *  \param sensor Driver; a fresh one, as its statistics are reported.
+ *  \param stream Clean packets.
+ *  \param offsets Offset of each packet, plus the stream end.
+ *  \param junk Insert junk between packets of the corrupted stream.
+ *  \param seconds Run time of the throughput measurement.
+ *  \param check Driver to check the clean stream with.
+ *  \param result Results.
+ *  \return False if the driver did not frame the streams as expected.
+ */
+static bool
+runFraming(dfti::SerialSensor &sensor, const QByteArray &stream,
+    const std::vector<qint64> &offsets, bool junk, quint32 seconds,
+    dfti::SerialSensor &check, FramingResult &result)
+{
+    std::mt19937 rng(7);
+    auto feed = [&rng](dfti::SerialSensor &s, const QByteArray &bytes) {
+        for (qint64 pos = 0; pos < bytes.size(); ) {
+            const qint64 len = qMin<qint64>(1 + rng() % 256,
+                bytes.size() - pos);
+            s.processBytes(bytes.constData() + pos, len,
+                dfti::getMonotonicNsec());
+            pos += len;
+        }
+    };
+    result.packets = offsets.size() - 1;
+
+    // Clean stream in random chunks: every packet and nothing else.
+    feed(check, stream);
+    const dfti::RxStats clean = check.rxStats();
+    bool ok = (clean.packetsParsed == result.packets) &&
+        !clean.checksumFailures && !clean.bytesDiscarded && !clean.resyncs;
+
+    // Corrupted stream: every intact packet is still recovered.
+    feed(sensor, corruptStream(stream, offsets, junk, result.corrupted));
+    result.stats = sensor.rxStats();
+    ok = ok && (result.stats.packetsParsed ==
+        result.packets - result.corrupted) &&
+        (result.stats.checksumFailures >= result.corrupted);
+
+    // Throughput, in 64 byte chunks as a UART delivers them.
+    quint64 packets = 0;
+    QElapsedTimer timer;
+    allocations = 0;
+    countAllocations = true;
+    timer.start();
+    do {
+        for (qint64 pos = 0; pos < stream.size(); pos += 64) {
+            check.processBytes(stream.constData() + pos,
+                qMin<qint64>(64, stream.size() - pos),
+                dfti::getMonotonicNsec());
+        }
+        packets += result.packets;
+    } while (timer.nsecsElapsed() < 1e9 * seconds);
+    const qint64 ns = timer.nsecsElapsed();
+    countAllocations = false;
+    result.mbPerSec = 1e3 * packets / result.packets * stream.size() / ns;
+    result.nsPerPacket = static_cast<double>(ns) / packets;
+    result.allocsPerPacket = allocationsPerPacket(packets);
+    return ok;
+}
+
+
+//! Verify and benchmark the packet framers of every sensor driver.
+/*!
+ *  Feeds each driver (VN-200 and RIO binary with sync framing, uADC and RIO
+ *  ASCII with line framing, and the autopilot with MAVLink framing) a clean
+ *  stream in random chunks, checking that every packet is framed and
+ *  nothing discarded, and then a stream with a bit flipped in every tenth
+ *  packet and, for the sync framings, junk in front of every 25th, checking
+ *  that every intact packet is still recovered. Then reports the resync
+ *  statistics and the parse throughput and allocations of each driver.
+ *
+ *  \param seconds Approximate run time per throughput case.
+ *  \return Exit code; nonzero if a driver misframes a stream.
+ */
+static int
+benchFramer(quint32 seconds)
+{
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) {
+        qWarning() << "Failed to create temporary directory";
+        return -1;
+    }
+    QDir dir(tmp.path());
+    dfti::Settings settings(writeRCFile(dir, "[dfti]\n"),
+        dfti::DebugMode::DEBUG_NONE);
+    dfti::Settings binarySettings(writeRCFile(dir,
+        "[rio]\nprotocol = binary\n"), dfti::DebugMode::DEBUG_NONE);
+
+    const quint32 count = 2000;
+    QByteArray streams[5];
+    std::vector<qint64> streamOffsets[5];
+    // VN-200 and uADC packets are a fixed size.
+    streams[0] = synthesizeVN200(count);
+    streams[1] = synthesizeUADC(count);
+    const qint64 sizes[] = {dfti::vn200PacketLen, dfti::uadcPktLen + 1};
+    for (quint32 i = 0; i < 2; ++i) {
+        for (quint32 j = 0; j <= count; ++j) {
+            streamOffsets[i].push_back(j * sizes[i]);
+        }
+    }
+    streams[2] = synthesizeRIO(count, streamOffsets[2]);
+    // RIO binary frames.
+    for (quint32 i = 0; i < count; ++i) {
+        quint16 counts[5];
+        for (quint32 ch = 0; ch < 5; ++ch) {
+            counts[ch] = static_cast<quint16>((i + ch) % 1024);
+        }
+        streamOffsets[3].push_back(streams[3].size());
+        streams[3].append(dfti::encodeRIOBinaryPacket(
+            static_cast<quint16>(i), i * 1000, counts, 5,
+            static_cast<quint16>(3000 + i)));
+    }
+    streamOffsets[3].push_back(streams[3].size());
+    // MAVLink packets carry their payload length.
+    streams[4] = synthesizeMAVLink(count / 50);
+    for (qint64 pos = 0; pos < streams[4].size(); ) {
+        streamOffsets[4].push_back(pos);
+        pos += static_cast<quint8>(streams[4].at(static_cast<int>(pos + 1))) +
+            8;
+    }
+    streamOffsets[4].push_back(streams[4].size());
+
+    const char *names[] = {"vn200", "uadc", "rio", "rio_bin", "mavlink"};
+    const char *framings[] = {"sync", "line", "line", "sync", "mavlink"};
+    const bool junk[] = {true, false, false, true, true};
+    bool ok = true;
+    printf("%8s %8s %8s %8s %8s %8s %10s %8s %10s %12s\n", "sensor",
+        "framing", "packets", "flipped", "failures", "resyncs", "discarded",
+        "MB/s", "ns/packet", "allocs/pkt");
+    for (quint32 i = 0; i < 5; ++i) {
+        auto make = [&](void) -> dfti::SerialSensor * {
+            switch (i) {
+                case 0:
+                    return new dfti::VN200(&settings);
+                case 1:
+                    return new dfti::uADC(&settings);
+                case 2:
+                    return new dfti::RIO(&settings);
+                case 3:
+                    return new dfti::RIO(&binarySettings);
+                default:
+                    return new dfti::Autopilot(&settings);
+            }
+        };
+        std::unique_ptr<dfti::SerialSensor> sensor(make());
+        std::unique_ptr<dfti::SerialSensor> check(make());
+        FramingResult r;
+        const bool framed = runFraming(*sensor, streams[i], streamOffsets[i],
+            junk[i], seconds, *check, r);
+        printf("%8s %8s %8u %8u %8llu %8llu %10llu %8.1f %10.1f %12.3f\n",
+            names[i], framings[i], r.packets, r.corrupted,
+            static_cast<unsigned long long>(r.stats.checksumFailures),
+            static_cast<unsigned long long>(r.stats.resyncs),
+            static_cast<unsigned long long>(r.stats.bytesDiscarded),
+            r.mbPerSec, r.nsPerPacket, r.allocsPerPacket);
+        ok = ok && framed;
+    }
+    printf("verify: %s\n", ok ? "every intact packet framed" :
+        "packets misframed");
+    return ok ? 0 : 1;
+}
+
+
+//! Telemetry results for one server mode.
+struct TelemetryResult
+{
+    //! VN-200 packets written to the driver.
+    quint32 sent{0};
+    //! Datagrams received.
+    quint32 received{0};
+    //! Datagrams missing from the sequence.
+    quint32 lost{0};
+    //! Server send statistics.
+    dfti::ServerStats stats;
+    //! VN-200 receive to datagram receive latencies, us, sorted.
+    std::vector<double> latencyUsec;
+};
+
+
+//! Run the server against VN-200 packets at the sensor's 800 Hz rate.
+/*!
+ *  The packets are fed to a VN200 driver from a thread of their own, as the
+ *  sensor thread would, and the datagrams are received on localhost. Only
+ *  datagrams carrying a new VN-200 measurement count towards the latency.
+ *
+ *  \param mode Server mode.
+ *  \param coalesceUsec Coalescing window in event mode, us.
+ *  \param seconds Run time.
+ *  \param result Results.
+ *  \return False if the client socket could not be bound.
+ */
+static bool
+runTelemetry(dfti::ServerMode mode, quint32 coalesceUsec, quint32 seconds,
+    TelemetryResult &result)
+{
+    QUdpSocket client;
+    if (!client.bind(QHostAddress::LocalHost, 0)) {
+        return false;
+    }
+    QTemporaryDir tmp;
+    dfti::Settings settings(writeRCFile(QDir(tmp.path()),
+        QString("[dfti]\nlog_rate_hz = 1000\n"
+                "[server]\nenabled = true\nport = %1\nrate_hz = 50\n"
+                "mode = %2\ncoalesce_usec = %3\n")
+            .arg(client.localPort())
+            .arg(mode == dfti::ServerMode::EVENT ? "event" : "periodic")
+            .arg(coalesceUsec)),
+        dfti::DebugMode::DEBUG_NONE);
+
+    dfti::VN200 ins(&settings);
+    QThread thread;
+    dfti::Server *server = new dfti::Server(&settings);
+    server->enableVN200(&ins);
+    server->moveToThread(&thread);
+    QObject::connect(&thread, &QThread::started, server,
+        &dfti::Server::start);
+    // The server is read and deleted in its own thread as it finishes.
+    QObject::connect(&thread, &QThread::finished, server, [&]() {
+        result.stats = server->stats();
+        delete server;
+    }, Qt::DirectConnection);
+    thread.start();
+
+    const QByteArray packets = synthesizeVN200(1000);
+    std::atomic<bool> running{true};
+    std::thread producer([&]() {
+        const auto period = std::chrono::microseconds(1250);
+        auto next = std::chrono::steady_clock::now() + period;
+        for (quint32 i = 0; running; ++i, next += period) {
+            std::this_thread::sleep_until(next);
+            ins.processBytes(packets.constData() +
+                (i % 1000) * dfti::vn200PacketLen, dfti::vn200PacketLen,
+                dfti::getMonotonicNsec());
+            ++result.sent;
+        }
+    });
+
+    dfti::StateData state;
+    quint64 lastRxTimeNs = 0;
+    quint32 nextSequence = 0;
+    QElapsedTimer wall;
+    wall.start();
+    while (wall.nsecsElapsed() < 1e9 * seconds + 2e8) {
+        if (wall.nsecsElapsed() > 1e9 * seconds) {
+            running = false;
+        }
+        if (!client.waitForReadyRead(10)) {
+            continue;
+        }
+        while (client.hasPendingDatagrams()) {
+            const qint64 len = client.readDatagram(
+                reinterpret_cast<char *>(&state), sizeof(state));
+            const quint64 nowNs = dfti::getMonotonicNsec();
+            if (len != sizeof(state)) {
+                continue;
+            }
+            if (state.sequence > nextSequence) {
+                result.lost += state.sequence - nextSequence;
+            }
+            nextSequence = state.sequence + 1;
+            ++result.received;
+            if (state.insRxTimeNs != lastRxTimeNs) {
+                lastRxTimeNs = state.insRxTimeNs;
+                result.latencyUsec.push_back(1e-3 * (nowNs -
+                    state.insRxTimeNs));
+            }
+        }
+    }
+    running = false;
+    producer.join();
+    thread.quit();
+    thread.wait();
+    std::sort(result.latencyUsec.begin(), result.latencyUsec.end());
+    return true;
+}
+
+
+//! Compare the latency of the server's periodic and event modes.
+/*!
+ *  Runs the server periodically at 50 Hz, in event mode, and in event mode
+ *  with a 500 us coalescing window, against an 800 Hz VN-200, and prints the
+ *  time from each VN-200 packet being read to the datagram carrying it being
+ *  received.
+ *
+ *  \param seconds Run time per mode.
+ *  \return Zero if event mode sent every measurement in sequence with less
+ *  latency than periodic mode.
+ */
+static int
+benchTelemetry(quint32 seconds)
+{
+    const dfti::ServerMode modes[] = {dfti::ServerMode::PERIODIC,
+        dfti::ServerMode::EVENT, dfti::ServerMode::EVENT};
+    const quint32 coalesce[] = {0, 0, 500};
+    const char *names[] = {"periodic_50hz", "event", "event_500us"};
+    TelemetryResult results[3];
+    printf("%16s %8s %10s %8s %10s %8s %8s %8s %8s\n", "mode", "sent",
+        "datagrams", "lost", "coalesced", "mean_us", "p50_us", "p99_us",
+        "max_us");
+    for (quint32 i = 0; i < 3; ++i) {
+        TelemetryResult &r = results[i];
+        if (!runTelemetry(modes[i], coalesce[i], seconds, r)) {
+            printf("verify: failed to bind the client socket\n");
+            return 1;
+        }
+        auto pct = [&r](double p) {
+            return r.latencyUsec.empty() ? 0.0 :
+                r.latencyUsec[static_cast<size_t>(p *
+                    (r.latencyUsec.size() - 1))];
+        };
+        const double mean = r.latencyUsec.empty() ? 0.0 :
+            std::accumulate(r.latencyUsec.begin(), r.latencyUsec.end(), 0.0) /
+            r.latencyUsec.size();
+        printf("%16s %8u %10u %8u %10llu %8.1f %8.1f %8.1f %8.1f\n",
+            names[i], r.sent, r.received, r.lost,
+            static_cast<unsigned long long>(r.stats.coalesced), mean,
+            pct(0.5), pct(0.99), pct(1.0));
+    }
+
+    // Loopback datagrams are not lost, and at 800 Hz each measurement is
+    // sent on its own in both event modes.
+    bool ok = !results[0].latencyUsec.empty();
+    for (quint32 i = 1; i < 3; ++i) {
+        ok = ok && !results[i].lost &&
+            results[i].latencyUsec.size() >= 0.95 * results[i].sent &&
+            results[i].latencyUsec[results[i].latencyUsec.size() / 2] <
+                results[0].latencyUsec[results[0].latencyUsec.size() / 2];
+    }
+    printf("verify: %s\n", ok ?
+        "event mode sent every measurement sooner than periodic mode" :
+        "event mode lost or delayed measurements");
+    return ok ? 0 : 1;
+}
+
+
+//! Fan-out results for one number of clients.
+struct FanoutResult
+{
+    //! Datagrams per send.
+    double datagramsPerSend{0};
+    //! Batched send time, us per send.
+    double fanoutUsec{0};
+    //! One sendto() per client time, us per send.
+    double naiveUsec{0};
+    //! Time the per client sends spend packing, us per send.
+    double naivePackUsec{0};
+    //! Clients that received exactly their stream.
+    quint32 clientsOk{0};
+};
+
+
+//! Send state data to loopback clients with a Fanout and one at a time.
+/*!
+ *  Clients take turns at each field subset and rate; sends are at 100 Hz
+ *  on a simulated clock, so each client's stream is known exactly.
+ *
+ *  \param clients Number of clients.
+ *  \param sends Number of sends.
+ *  \param result Results.
+ *  \return False if a client socket could not be bound.
+ */
+static bool
+runFanout(quint32 clients, quint32 sends, FanoutResult &result)
+{
+    const QStringList fields[] = {QStringList(), QStringList({"ins"}),
+        QStringList({"ads", "euler"}), QStringList({"rio"})};
+    const quint32 periodUsec[] = {0, 20000, 100000, 0};
+    const quint64 sendPeriodNs = 10000000;
+
+    std::vector<std::unique_ptr<QUdpSocket>> sockets;
+    std::vector<quint32> masks(clients);
+    dfti::Fanout fanout;
+    if (!fanout.open(1, QHostAddress())) {
+        return false;
+    }
+    for (quint32 i = 0; i < clients; ++i) {
+        sockets.emplace_back(new QUdpSocket());
+        if (!sockets.back()->bind(QHostAddress::LocalHost, 0)) {
+            return false;
+        }
+        QStringList unknown;
+        masks[i] = dfti::stateFieldMask(fields[i % 4], unknown);
+        fanout.set(QHostAddress(QHostAddress::LocalHost),
+            sockets.back()->localPort(), periodUsec[i % 4], masks[i]);
+    }
+
+    // Clients check the length and sequence of every datagram.
+    std::vector<quint32> received(clients, 0);
+    std::vector<bool> inOrder(clients, true);
+    char buf[512];
+    auto drain = [&](void) {
+        for (quint32 i = 0; i < clients; ++i) {
+            while (sockets[i]->hasPendingDatagrams()) {
+                const qint64 len = sockets[i]->readDatagram(buf, sizeof(buf));
+                quint32 sequence = 0;
+                if (len >= 4) {
+                    memcpy(&sequence, buf + len - 4, sizeof(sequence));
+                }
+                inOrder[i] = inOrder[i] &&
+                    (len == static_cast<qint64>(fanout.packetSize(i))) &&
+                    (sequence == received[i]);
+                ++received[i];
+            }
+        }
+    };
+
+    dfti::TelemetryState state;
+    QElapsedTimer timer;
+    qint64 fanoutNs = 0;
+    quint64 datagrams = 0;
+    for (quint32 k = 0; k < sends; ++k) {
+        state.base.gpsTimeNs = k;
+        quint32 failed = 0;
+        timer.start();
+        datagrams += fanout.send(state, (k + 1) * sendPeriodNs,
+            sendPeriodNs / 2, failed);
+        fanoutNs += timer.nsecsElapsed();
+        drain();
+    }
+    for (quint32 i = 0; i < clients; ++i) {
+        const quint32 expected = periodUsec[i % 4] ?
+            (sends + 1000 * periodUsec[i % 4] / sendPeriodNs - 1) /
+                (1000 * periodUsec[i % 4] / sendPeriodNs) : sends;
+        if (inOrder[i] && received[i] == expected) {
+            ++result.clientsOk;
+        }
+    }
+
+    // The same streams, packed and sent to each client in turn.
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    std::vector<struct sockaddr_in> addrs(clients);
+    std::vector<quint64> nextNs(clients, 0);
+    for (quint32 i = 0; i < clients; ++i) {
+        memset(&addrs[i], 0, sizeof(addrs[i]));
+        addrs[i].sin_family = AF_INET;
+        addrs[i].sin_port = htons(sockets[i]->localPort());
+        addrs[i].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    }
+    qint64 naiveNs = 0;
+    qint64 packNs = 0;
+    QElapsedTimer packTimer;
+    for (quint32 k = 0; k < sends; ++k) {
+        const quint64 nowNs = (k + 1) * sendPeriodNs;
+        timer.start();
+        for (quint32 i = 0; i < clients; ++i) {
+            const quint64 periodNs = 1000ull * periodUsec[i % 4];
+            if (periodNs) {
+                if (nowNs + sendPeriodNs / 2 < nextNs[i]) {
+                    continue;
+                }
+                nextNs[i] = (nextNs[i] ? nextNs[i] : nowNs) + periodNs;
+            }
+            packTimer.start();
+            const quint32 len = dfti::packStateFields(state, masks[i], buf);
+            packNs += packTimer.nsecsElapsed();
+            sendto(fd, buf, len, 0,
+                reinterpret_cast<struct sockaddr *>(&addrs[i]),
+                sizeof(addrs[i]));
+        }
+        naiveNs += timer.nsecsElapsed();
+        for (auto &sock : sockets) {
+            while (sock->hasPendingDatagrams()) {
+                sock->readDatagram(buf, sizeof(buf));
+            }
+        }
+    }
+    close(fd);
+
+    result.datagramsPerSend = static_cast<double>(datagrams) / sends;
+    result.fanoutUsec = 1e-3 * fanoutNs / sends;
+    result.naiveUsec = 1e-3 * naiveNs / sends;
+    result.naivePackUsec = 1e-3 * packNs / sends;
+    return true;
+}
+
+
+//! Benchmark sending the state data to many clients.
+/*!
+ *  Sends to 1 to 64 loopback clients, each with its own rate and fields,
+ *  with a Fanout (one sendmmsg() gathering from the one state per send)
+ *  and, for comparison, by packing and sending to each client in turn.
+ *  Then sends to a multicast group joined on the loopback interface, if
+ *  the host allows it.
+ *
+ *  \param seconds Simulated run time at 100 Hz.
+ *  \return Zero if every client received exactly its stream.
+ */
+static int
+benchFanout(quint32 seconds)
+{
+    const quint32 sends = std::max(1000u, 100 * seconds);
+    const quint32 clientCounts[] = {1, 4, 16, 64};
+    bool ok = true;
+    printf("%8s %10s %12s %12s %12s %10s\n", "clients", "dgrams/send",
+        "fanout_us", "naive_us", "naive_pack", "clients_ok");
+    for (quint32 clients : clientCounts) {
+        FanoutResult r;
+        if (!runFanout(clients, sends, r)) {
+            printf("verify: failed to open the client sockets\n");
+            return 1;
+        }
+        printf("%8u %10.2f %12.2f %12.2f %12.2f %10u\n", clients,
+            r.datagramsPerSend, r.fanoutUsec, r.naiveUsec, r.naivePackUsec,
+            r.clientsOk);
+        ok = ok && (r.clientsOk == clients);
+    }
+
+    // Multicast, if there is a route for it.
+    const QHostAddress group("239.255.27.1");
+    QUdpSocket member;
+    dfti::Fanout fanout;
+    char buf[512];
+    quint32 multicast = 0;
+    if (member.bind(QHostAddress::AnyIPv4, 0, QUdpSocket::ShareAddress) &&
+            member.joinMulticastGroup(group)) {
+        fanout.open(1, QHostAddress());
+        fanout.set(group, member.localPort(), 0, dfti::allStateFields);
+        dfti::TelemetryState state;
+        quint32 failed = 0;
+        for (quint32 k = 0; k < 100; ++k) {
+            fanout.send(state, k, 0, failed);
+        }
+        for (quint32 wait = 0; wait < 10 && multicast < 100; ++wait) {
+            member.waitForReadyRead(10);
+            while (member.hasPendingDatagrams()) {
+                member.readDatagram(buf, sizeof(buf));
+                ++multicast;
+            }
+        }
+        printf("multicast: %u of 100 datagrams received\n", multicast);
+    } else {
+        printf("multicast: skipped, cannot join %s\n",
+            qPrintable(group.toString()));
+    }
+
+    printf("verify: %s\n", ok ? "every client received exactly its stream" :
+        "streams lost or misframed");
+    return ok ? 0 : 1;
+}
+
+
+//! A client of the subscription benchmark.
+struct Subscriber
+{
+    //! Constructor.
+    Subscriber(const char *_request, bool _renew, const char *_expected,
+        double _rateHz, const char *_source = "127.0.0.1")
+    : request(_request), renew(_renew), expected(_expected), rateHz(_rateHz),
+      source(QString(_source)), socket(new QUdpSocket())
+    {
+    }
+
+    //! Subscription request.
+    const char *request;
+    //! Renew the subscription while running.
+    bool renew;
+    //! Expected reply prefix, or empty for no reply.
+    const char *expected;
+    //! Expected datagram rate, Hz.
+    double rateHz;
+    //! Source address.
+    QHostAddress source;
+    //! Socket.
+    std::unique_ptr<QUdpSocket> socket;
+    //! Last reply.
+    QByteArray reply;
+    //! Datagram size given in the reply.
+    quint32 size{0};
+    //! Datagrams received.
+    quint32 datagrams{0};
+    //! Datagrams of another size.
+    quint32 badSize{0};
+    //! Datagrams received after the first second.
+    quint32 late{0};
+};
+
+
+//! Benchmark the server's subscription protocol.
+/*!
+ *  Runs a server at 100 Hz with subscriptions on, and clients that
+ *  subscribe to field subsets at different rates, let their subscription
+ *  expire, or are refused. The configured destination also asks to
+ *  subscribe, and must be refused and keep its full stream; a client
+ *  outside subscribe_allow must get no reply. Prints the bytes each client
+ *  receives against the full StateData at the same rate.
+ *
+ *  \param seconds Run time (at least 4 s, for the 1 s subscriptions to
+ *  expire).
+ *  \return Zero if every client got the reply and stream it asked for.
+ */
+static int
+benchSubscribe(quint32 seconds)
+{
+    Subscriber clients[] = {
+        // The configured destination.
+        {"subscribe 10 ias", true, "error configured destination", 100},
+        {"subscribe 100 ins", true, "ok", 100},
+        {"subscribe 10 ads rio_all", true, "ok", 10},
+        {"subscribe 0 position velocity", false, "ok", 0},
+        {"subscribe 10 ias", false, "error", 0},
+        {"subscribe 10 bogus", false, "error", 0},
+        {"subscribe 1000 ias", false, "error rate", 0},
+        {"subscribe 10 ias", false, "", 0, "127.0.0.2"}
+    };
+    const quint32 numClients = sizeof(clients) / sizeof(clients[0]);
+    // Its stream is the full StateData.
+    clients[0].size = sizeof(dfti::StateData);
+
+    // Find free ports for the server; the first client's is its
+    // destination.
+    QUdpSocket probe;
+    bool bound = probe.bind(QHostAddress::AnyIPv4, 0);
+    for (Subscriber &c : clients) {
+        bound = bound && c.socket->bind(c.source, 0);
+    }
+    if (!bound) {
+        printf("verify: failed to bind the client sockets\n");
+        return 1;
+    }
+    const quint16 subscribePort = probe.localPort();
+    probe.close();
+
+    QTemporaryDir tmp;
+    dfti::Settings settings(writeRCFile(QDir(tmp.path()),
+        QString("[dfti]\nlog_rate_hz = 1000\n"
+                "[server]\nenabled = true\nport = %1\nrate_hz = 100\n"
+                "subscribe_port = %2\nsubscribe_allow = 127.0.0.1\n"
+                "max_subscribers = 3\nsubscription_timeout_sec = 1\n")
+            .arg(clients[0].socket->localPort()).arg(subscribePort)),
+        dfti::DebugMode::DEBUG_NONE);
+    QThread thread;
+    dfti::Server *server = new dfti::Server(&settings);
+    server->moveToThread(&thread);
+    QObject::connect(&thread, &QThread::started, server,
+        &dfti::Server::start);
+    QObject::connect(&thread, &QThread::finished, server, [&]() {
+        delete server;
+    }, Qt::DirectConnection);
+    thread.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const QHostAddress local(QHostAddress::LocalHost);
+    auto request = [&](Subscriber &c, const QByteArray &text) {
+        c.socket->writeDatagram(text, local, subscribePort);
+    };
+    char buf[512];
+    QElapsedTimer wall;
+    auto receive = [&](Subscriber &c) {
+        QHostAddress from;
+        quint16 fromPort = 0;
+        while (c.socket->hasPendingDatagrams()) {
+            const qint64 len = c.socket->readDatagram(buf, sizeof(buf),
+                &from, &fromPort);
+            if (fromPort == subscribePort) {
+                c.reply = QByteArray(buf, static_cast<int>(len));
+                const QList<QByteArray> words = c.reply.split(' ');
+                if (words.size() > 1 && words[0] == "ok") {
+                    c.size = words[1].toUInt();
+                }
+                continue;
+            }
+            ++c.datagrams;
+            c.badSize += (len != c.size);
+            c.late += (wall.nsecsElapsed() > 3e9);
+        }
+    };
+
+    const quint32 runSeconds = std::max(4u, seconds);
+    wall.start();
+    qint64 renewNs = 0;
+    while (wall.nsecsElapsed() < 1e9 * runSeconds) {
+        if (wall.nsecsElapsed() >= renewNs) {
+            // Each client subscribes once in turn; some renew.
+            for (Subscriber &c : clients) {
+                if (!renewNs || c.renew) {
+                    request(c, c.request);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+            }
+            renewNs += 500000000;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (Subscriber &c : clients) {
+            receive(c);
+        }
+    }
+    // The third client leaves, and receives nothing more.
+    request(clients[2], "unsubscribe");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    receive(clients[2]);
+    const quint32 afterUnsubscribe = clients[2].datagrams;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    receive(clients[2]);
+    thread.quit();
+    thread.wait();
+
+    const double fullSize = sizeof(dfti::StateData);
+    bool ok = true;
+    printf("%-32s %-10s %8s %10s %10s %10s\n", "request", "reply",
+        "size", "datagrams", "bytes/s", "vs_full_%");
+    for (quint32 i = 0; i < numClients; ++i) {
+        Subscriber &c = clients[i];
+        const double perSec = static_cast<double>(c.datagrams) / runSeconds;
+        printf("%-32s %-10s %8u %10u %10.0f %10.1f\n", c.request,
+            c.reply.left(c.reply.indexOf(' ')).constData(), c.size,
+            c.datagrams, perSec * c.size,
+            c.size ? 100.0 * c.size / fullSize : 0.0);
+        bool clientOk = (*c.expected ? c.reply.startsWith(c.expected) :
+            c.reply.isEmpty()) && !c.badSize;
+        if (c.rateHz) {
+            // Renewed subscriptions run the whole time at their rate.
+            clientOk = clientOk && (perSec > 0.9 * c.rateHz) &&
+                (perSec < 1.1 * c.rateHz);
+        } else if (c.reply.startsWith("ok")) {
+            // The lapsed subscription ran for one to two seconds.
+            clientOk = clientOk && (c.datagrams >= 100) && !c.late;
+        } else {
+            clientOk = clientOk && !c.datagrams;
+        }
+        ok = ok && clientOk;
+    }
+    ok = ok && (clients[2].datagrams == afterUnsubscribe);
+    printf("verify: %s\n", ok ?
+        "every client got the reply and stream it asked for" :
+        "subscriptions misbehaved");
+    return ok ? 0 : 1;
+}
+
+
+//! Delta encoding results for one field subset.
+struct DeltaResult
+{
+    //! Constructor.
+    explicit DeltaResult(const char *_fields)
+    : fields(_fields)
+    {
+    }
+
+    //! Fields, as in a destination.
+    const char *fields;
+    //! Delta encoded datagrams received.
+    quint32 datagrams{0};
+    //! Raw bytes received.
+    quint64 rawBytes{0};
+    //! Delta encoded bytes received.
+    quint64 deltaBytes{0};
+    //! Keyframes received.
+    quint64 keyframes{0};
+    //! Bytes of the keyframes.
+    quint64 keyframeBytes{0};
+    //! Datagrams decoded from the whole stream.
+    quint32 decoded{0};
+    //! Datagrams dropped on the simulated lossy link.
+    quint32 dropped{0};
+    //! Datagrams decoded after the losses.
+    quint32 lossyDecoded{0};
+    //! Datagrams that should decode after the losses.
+    quint32 lossyExpected{0};
+    //! Datagrams missing, or decoded further than a quantum from the raw.
+    quint32 mismatched{0};
+};
+
+
+//! Check that a decoded channel is within its quantum of the raw value.
+/*!
+ *  \param channel Channel.
+ *  \param decoded Decoded record.
+ *  \param raw Raw record.
+ *  \return True if the values agree.
+ */
+static bool
+withinQuantum(const dfti::DeltaChannel &channel, const quint8 *decoded,
+    const quint8 *raw)
+{
+    const quint8 *a = decoded + channel.offset;
+    const quint8 *b = raw + channel.offset;
+    double x = 0;
+    double y = 0;
+    quint64 u = 0;
+    quint64 v = 0;
+    switch (channel.type) {
+        case dfti::ChannelType::U8:
+            u = *a;
+            v = *b;
+            break;
+        case dfti::ChannelType::U16: {
+            quint16 p, q;
+            memcpy(&p, a, sizeof(p));
+            memcpy(&q, b, sizeof(q));
+            u = p;
+            v = q;
+            break;
+        }
+        case dfti::ChannelType::U32: {
+            quint32 p, q;
+            memcpy(&p, a, sizeof(p));
+            memcpy(&q, b, sizeof(q));
+            u = p;
+            v = q;
+            break;
+        }
+        case dfti::ChannelType::U64:
+            memcpy(&u, a, sizeof(u));
+            memcpy(&v, b, sizeof(v));
+            break;
+        case dfti::ChannelType::F32: {
+            float f;
+            memcpy(&f, a, sizeof(f));
+            x = f;
+            memcpy(&f, b, sizeof(f));
+            y = f;
+            break;
+        }
+        case dfti::ChannelType::F64:
+            memcpy(&x, a, sizeof(x));
+            memcpy(&y, b, sizeof(y));
+            break;
+    }
+    if (channel.type == dfti::ChannelType::F32 ||
+            channel.type == dfti::ChannelType::F64) {
+        // NaN decodes as NaN and infinities saturate; allow for rounding
+        // the decoded value to the channel type.
+        if (std::isnan(y)) {
+            return std::isnan(x);
+        }
+        if (std::isinf(y)) {
+            return (x > 0) == (y > 0) && std::fabs(x) >= 9e18 * channel.quantum;
+        }
+        const double rounding = std::fabs(y) *
+            (channel.type == dfti::ChannelType::F32 ? 1e-6 : 1e-12);
+        return std::fabs(x - y) <= 0.5 * channel.quantum + rounding;
+    }
+    // Integers are rounded down to a multiple of the quantum.
+    const quint64 quantum = std::max(1.0, std::round(channel.quantum));
+    return u <= v && v - u < quantum;
+}
+
+
+//! Give a server the synthesized measurements of a 50 Hz send.
+/*!
+ *  \param server Server.
+ *  \param k Send index.
+ *  \param nowNs Monotonic time of the send, nanoseconds.
+ *  \param rng Random numbers for the receive times.
+ */
+static void
+giveSyntheticState(dfti::Server &server, quint32 k, quint64 nowNs,
+    std::mt19937 &rng)
+{
+    dfti::APData apData;
+    dfti::RIOData rioData;
+    dfti::uADCData adcData;
+    dfti::VN200Data insData;
+    rioData.numValues = 8;
+    fillSensorData(2 * k, apData, rioData, adcData, insData);
+    // Sensors are read a little before each send.
+    apData.rxTimeNs = nowNs - rng() % 100000;
+    rioData.rxTimeNs = nowNs - rng() % 100000;
+    adcData.rxTimeNs = nowNs - rng() % 100000;
+    insData.rxTimeNs = nowNs - rng() % 100000;
+    server.getAPData(apData);
+    server.getRIOData(rioData);
+    server.getUADCData(adcData);
+    server.getVN200Data(insData);
+}
+
+
+//! Send state data through a server to raw and delta encoded destinations.
+/*!
+ *  The server runs in event mode with each field subset sent to a raw and
+ *  a delta destination on localhost, and sends at 50 Hz of simulated time.
+ *  Every delta datagram is decoded as received and compared with the raw
+ *  datagram of the same send, and decoded again after dropping one in 20
+ *  at random, as a lossy radio link would.
+ *
+ *  \param input Capture file to replay, or empty for synthesized flight
+ *      data.
+ *  \param seconds Synthesized flight time.
+ *  \param keyframeInterval Datagrams from one keyframe to the next.
+ *  \param results Results, with their field subsets set.
+ *  \param durationSec Set to the simulated time sent.
+ *  \return False if a socket could not be bound or the capture read.
+ */
+static bool
+runDelta(const QString &input, quint32 seconds, quint32 keyframeInterval,
+    std::vector<DeltaResult> &results, double &durationSec)
+{
+    std::vector<std::unique_ptr<QUdpSocket>> rawClients;
+    std::vector<std::unique_ptr<QUdpSocket>> deltaClients;
+    std::vector<std::vector<dfti::DeltaChannel>> channels;
+    std::vector<dfti::DeltaDecoder> decoders;
+    std::vector<dfti::DeltaDecoder> lossyDecoders;
+    std::vector<bool> keyframeDropped(results.size(), false);
+    QStringList destinations;
+    for (const DeltaResult &r : results) {
+        rawClients.emplace_back(new QUdpSocket());
+        deltaClients.emplace_back(new QUdpSocket());
+        if (!rawClients.back()->bind(QHostAddress::LocalHost, 0) ||
+                !deltaClients.back()->bind(QHostAddress::LocalHost, 0)) {
+            return false;
+        }
+        destinations << QString("127.0.0.1:%1/%2").arg(
+            rawClients.back()->localPort()).arg(r.fields);
+        destinations << QString("127.0.0.1:%1/%2~delta").arg(
+            deltaClients.back()->localPort()).arg(r.fields);
+        QStringList unknown;
+        channels.push_back(dfti::stateFieldChannels(dfti::stateFieldMask(
+            QString(r.fields).split('+'), unknown)));
+        decoders.emplace_back(channels.back());
+        lossyDecoders.emplace_back(channels.back());
+    }
+
+    QTemporaryDir tmp;
+    dfti::Settings settings(writeRCFile(QDir(tmp.path()),
+        QString("[dfti]\nlog_rate_hz = 1000\n"
+                "[server]\nenabled = true\nmode = event\n"
+                "keyframe_interval = %1\ndestinations = %2\n")
+            .arg(keyframeInterval).arg(destinations.join(", "))),
+        dfti::DebugMode::DEBUG_NONE);
+    dfti::Autopilot ap(&settings);
+    dfti::RIO rio(&settings);
+    dfti::uADC adc(&settings);
+    dfti::VN200 ins(&settings);
+    dfti::Server server(&settings);
+
+    std::mt19937 rng(1);
+    char raw[512];
+    quint8 packet[1024];
+    quint8 record[512];
+    quint32 sends = 0;
+    auto send = [&](void) {
+        server.writeData();
+        ++sends;
+        for (size_t i = 0; i < results.size(); ++i) {
+            DeltaResult &r = results[i];
+            const qint64 rawLen = rawClients[i]->readDatagram(raw,
+                sizeof(raw));
+            const qint64 len = deltaClients[i]->readDatagram(
+                reinterpret_cast<char *>(packet), sizeof(packet));
+            if (rawLen <= 0 || len <= 0) {
+                ++r.mismatched;
+                continue;
+            }
+            ++r.datagrams;
+            r.rawBytes += rawLen;
+            r.deltaBytes += len;
+            const bool keyframe = (packet[0] == dfti::deltaKeyframe);
+            if (keyframe) {
+                ++r.keyframes;
+                r.keyframeBytes += len;
+            }
+            auto check = [&](void) {
+                for (const dfti::DeltaChannel &channel : channels[i]) {
+                    if (!withinQuantum(channel, record,
+                            reinterpret_cast<const quint8 *>(raw))) {
+                        ++r.mismatched;
+                        return;
+                    }
+                }
+            };
+            if (decoders[i].decode(packet, len, record) ==
+                    dfti::DeltaDecoder::Status::DECODED) {
+                ++r.decoded;
+                check();
+            }
+
+            // Deltas decode unless they or their keyframe were dropped.
+            const bool drop = !(rng() % 20);
+            if (keyframe) {
+                keyframeDropped[i] = drop;
+            }
+            if (drop) {
+                ++r.dropped;
+                continue;
+            }
+            r.lossyExpected += !keyframeDropped[i];
+            if (lossyDecoders[i].decode(packet, len, record) ==
+                    dfti::DeltaDecoder::Status::DECODED) {
+                ++r.lossyDecoded;
+                check();
+            }
+        }
+    };
+
+    const quint64 sendPeriodNs = 20000000;
+    if (input.isEmpty()) {
+        const quint64 startNs = dfti::getMonotonicNsec();
+        for (quint32 k = 0; k < 50 * seconds; ++k) {
+            giveSyntheticState(server, k, startNs + k * sendPeriodNs, rng);
+            send();
+        }
+    } else {
+        dfti::CaptureReader reader;
+        if (!reader.open(input)) {
+            qWarning() << "Failed to read capture" << input;
+            return false;
+        }
+        server.enableAutopilot(&ap);
+        server.enableRIO(&rio);
+        server.enableUADC(&adc);
+        server.enableVN200(&ins);
+        dfti::CaptureFrame frame;
+        quint64 nextNs = 0;
+        while (reader.next(frame)) {
+            if (!nextNs) {
+                nextNs = frame.timeNs + sendPeriodNs;
+            }
+            while (frame.timeNs >= nextNs) {
+                send();
+                nextNs += sendPeriodNs;
+            }
+            dfti::SerialSensor *sensor = &ins;
+            switch (frame.sensor) {
+                case dfti::CaptureSensor::AUTOPILOT:
+                    sensor = &ap;
+                    break;
+                case dfti::CaptureSensor::RIO:
+                    sensor = &rio;
+                    break;
+                case dfti::CaptureSensor::UADC:
+                    sensor = &adc;
+                    break;
+                case dfti::CaptureSensor::VN200:
+                    break;
+            }
+            sensor->processBytes(frame.bytes, frame.len, frame.timeNs);
+        }
+    }
+    durationSec = 1e-9 * sends * sendPeriodNs;
+    return true;
+}
+
+
+//! Benchmark delta encoded telemetry for narrowband links.
+/*!
+ *  Sends flight data, recorded in a capture file if one is given and
+ *  synthesized otherwise, through the server at 50 Hz to raw and delta
+ *  encoded destinations (see runDelta()) with keyframes every 10, 50 and
+ *  250 datagrams, and prints the bytes per second of each and the share of
+ *  a 57600 baud radio link the delta stream takes.
+ *
+ *  \param seconds Synthesized flight time.
+ *  \param input Capture file to replay, or empty.
+ *  \return Zero if every delta stream decodes to its raw stream within a
+ *  quantum, both whole and after losses, and is smaller.
+ */
+static int
+benchDelta(quint32 seconds, const QString &input)
+{
+    const quint32 intervals[] = {10, 50, 250};
+    const char *subsets[] = {"all", "ins", "euler+ias+aoa+aos",
+        "all+ins+ads+rio+ap"};
+    bool ok = true;
+    printf("%8s %20s %10s %10s %8s %8s %8s %8s %8s\n", "keyframe", "fields",
+        "raw_B/s", "delta_B/s", "saved_%", "key_B", "delta_B", "link_%",
+        "lossy_%");
+    for (quint32 interval : intervals) {
+        std::vector<DeltaResult> results;
+        for (const char *fields : subsets) {
+            results.emplace_back(fields);
+        }
+        double durationSec = 0;
+        if (!runDelta(input, seconds, interval, results, durationSec)) {
+            printf("verify: failed to set up the streams\n");
+            return 1;
+        }
+        for (const DeltaResult &r : results) {
+            const quint64 sends = r.datagrams;
+            const double deltaBytesPerSec = r.deltaBytes / durationSec;
+            printf("%8u %20s %10.0f %10.0f %8.1f %8.1f %8.1f %8.1f %8.1f\n",
+                interval, r.fields, r.rawBytes / durationSec,
+                deltaBytesPerSec, 100.0 - 100.0 * r.deltaBytes /
+                    std::max<quint64>(1, r.rawBytes),
+                static_cast<double>(r.keyframeBytes) /
+                    std::max<quint64>(1, r.keyframes),
+                static_cast<double>(r.deltaBytes - r.keyframeBytes) /
+                    std::max<quint64>(1, sends - r.keyframes),
+                100.0 * deltaBytesPerSec / 5760,
+                100.0 * r.lossyDecoded / std::max(1u, sends - r.dropped));
+            ok = ok && sends && r.decoded == sends && !r.mismatched &&
+                r.lossyDecoded == r.lossyExpected &&
+                r.deltaBytes < r.rawBytes;
+        }
+    }
+    printf("verify: %s\n", ok ? "delta streams decode to the raw streams "
+        "within a quantum and recover from losses at the next keyframe" :
+        "delta streams lost, misdecoded or larger than raw");
+    return ok ? 0 : 1;
+}
+
+
+//! Forward error correction results for one loss rate.
+struct FecResult
+{
+    //! Constructor.
+    explicit FecResult(double _loss)
+    : loss(_loss), rng(static_cast<quint32>(1000 * _loss))
+    {
+    }
+
+    //! Probability of dropping a packet.
+    double loss;
+    //! Random numbers for the drops.
+    std::mt19937 rng;
+    //! Datagrams sent.
+    quint32 datagrams{0};
+    //! Datagrams dropped.
+    quint32 lost{0};
+    //! Datagrams passed on by the decoder, received or recovered.
+    quint32 delivered{0};
+    //! Datagrams recovered from parity.
+    quint32 recovered{0};
+    //! Datagrams of groups with no more losses than parity packets.
+    quint32 recoverable{0};
+    //! Datagrams passed on that differ from those sent.
+    quint32 mismatched{0};
+    //! Packets dropped from the group being sent.
+    quint32 groupLost{0};
+    //! Datagrams dropped from the group being sent.
+    quint32 groupLostData{0};
+    //! Delta records decoded from the datagrams received.
+    quint32 deltaDecoded{0};
+    //! Delta records decoded with the recovered datagrams too.
+    quint32 deltaFecDecoded{0};
+    //! Delta datagrams sent.
+    quint32 deltaDatagrams{0};
+};
+
+
+//! Send state data through a server with forward error correction.
+/*!
+ *  The server sends the StateData fields to three destinations on
+ *  localhost at 50 Hz of simulated time: as they are, for reference; with
+ *  forward error correction; and delta encoded with forward error
+ *  correction. For each loss rate the packets of the last two are dropped
+ *  at random and the rest passed through a FecDecoder. Every datagram it
+ *  passes on must match the reference with the same sequence number, and
+ *  every datagram of a group that lost no more packets than it has parity
+ *  packets must be recovered. The delta records are decoded both from the
+ *  datagrams received alone and with the recovered ones.
+ *
+ *  \param dataPackets Datagrams per group.
+ *  \param parityPackets Parity packets per group.
+ *  \param seconds Simulated run time.
+ *  \param results Results, with their loss rates set.
+ *  \param overhead Set to the extra bytes sent over the reference, as a
+ *      fraction.
+ *  \return False if a socket could not be bound.
+ */
+static bool
+runFec(quint8 dataPackets, quint8 parityPackets, quint32 seconds,
+    std::vector<FecResult> &results, double &overhead)
+{
+    QUdpSocket reference;
+    QUdpSocket raw;
+    QUdpSocket delta;
+    if (!reference.bind(QHostAddress::LocalHost, 0) ||
+            !raw.bind(QHostAddress::LocalHost, 0) ||
+            !delta.bind(QHostAddress::LocalHost, 0)) {
+        return false;
+    }
+    QTemporaryDir tmp;
+    dfti::Settings settings(writeRCFile(QDir(tmp.path()),
+        QString("[dfti]\nlog_rate_hz = 1000\n"
+                "[server]\nenabled = true\nmode = event\n"
+                "fec_data_packets = %1\nfec_parity_packets = %2\n"
+                "destinations = 127.0.0.1:%3, 127.0.0.1:%4~fec, "
+                "127.0.0.1:%5~delta~fec\n")
+            .arg(dataPackets).arg(parityPackets).arg(reference.localPort())
+            .arg(raw.localPort()).arg(delta.localPort())),
+        dfti::DebugMode::DEBUG_NONE);
+    dfti::Server server(&settings);
+
+    const std::vector<dfti::DeltaChannel> channels =
+        dfti::stateFieldChannels(dfti::allStateFields);
+    std::vector<dfti::FecDecoder> rawDecoders;
+    std::vector<dfti::FecDecoder> deltaFecDecoders;
+    std::vector<dfti::DeltaDecoder> deltaDecoders;
+    std::vector<dfti::DeltaDecoder> deltaFecRecordDecoders;
+    for (size_t i = 0; i < results.size(); ++i) {
+        rawDecoders.emplace_back(sizeof(dfti::StateData));
+        deltaFecDecoders.emplace_back(dfti::deltaMaxPacketLen(
+            channels.size()));
+        deltaDecoders.emplace_back(channels);
+        deltaFecRecordDecoders.emplace_back(channels);
+    }
+
+    std::vector<QByteArray> sent;
+    quint64 referenceBytes = 0;
+    quint64 rawBytes = 0;
+    char buf[2048];
+    quint8 record[sizeof(dfti::TelemetryState)];
+    const qint64 headerLen = dfti::fecHeaderLen;
+    std::mt19937 rng(1);
+    const quint64 startNs = dfti::getMonotonicNsec();
+    for (quint32 k = 0; k < 50 * seconds; ++k) {
+        giveSyntheticState(server, k, startNs + k * 20000000ull, rng);
+        server.writeData();
+        const qint64 refLen = reference.readDatagram(buf, sizeof(buf));
+        if (refLen <= 0) {
+            return false;
+        }
+        sent.push_back(QByteArray(buf, refLen));
+        referenceBytes += refLen;
+
+        // The packets each loss rate lets through.
+        qint64 len;
+        while ((len = raw.readDatagram(buf, sizeof(buf))) > 0) {
+            rawBytes += len;
+            const quint8 *packet = reinterpret_cast<const quint8 *>(buf);
+            dfti::FecHeader header;
+            if (!dfti::fecParseHeader(packet, len, header)) {
+                continue;
+            }
+            for (size_t i = 0; i < results.size(); ++i) {
+                FecResult &r = results[i];
+                const bool drop = (r.rng() % 10000) < 10000 * r.loss;
+                r.datagrams += !header.parity;
+                r.lost += drop && !header.parity;
+                r.groupLost += drop;
+                r.groupLostData += drop && !header.parity;
+                if (header.parity && header.index == parityPackets - 1) {
+                    if (r.groupLost <= parityPackets) {
+                        r.recoverable += r.groupLostData;
+                    }
+                    r.groupLost = 0;
+                    r.groupLostData = 0;
+                }
+                if (drop) {
+                    continue;
+                }
+                const size_t n = rawDecoders[i].receive(packet, len);
+                for (size_t j = 0; j < n; ++j) {
+                    size_t payloadLen;
+                    const quint8 *payload = rawDecoders[i].payload(j,
+                        payloadLen);
+                    quint32 sequence;
+                    memcpy(&sequence, payload + payloadLen -
+                        sizeof(sequence), sizeof(sequence));
+                    ++r.delivered;
+                    r.recovered += rawDecoders[i].recovered(j);
+                    r.mismatched += (sequence >= sent.size() ||
+                        sent[sequence] != QByteArray(reinterpret_cast<
+                            const char *>(payload), payloadLen));
+                }
+            }
+        }
+        while ((len = delta.readDatagram(buf, sizeof(buf))) > 0) {
+            const quint8 *packet = reinterpret_cast<const quint8 *>(buf);
+            for (size_t i = 0; i < results.size(); ++i) {
+                FecResult &r = results[i];
+                r.deltaDatagrams += (packet[0] == dfti::fecDatagram);
+                if ((r.rng() % 10000) < 10000 * r.loss) {
+                    continue;
+                }
+                // Without recovery, only the datagrams received decode.
+                if (packet[0] == dfti::fecDatagram && len > headerLen) {
+                    r.deltaDecoded += (deltaDecoders[i].decode(packet +
+                        headerLen, len - headerLen, record) ==
+                        dfti::DeltaDecoder::Status::DECODED);
+                }
+                const size_t n = deltaFecDecoders[i].receive(packet, len);
+                for (size_t j = 0; j < n; ++j) {
+                    size_t payloadLen;
+                    const quint8 *payload = deltaFecDecoders[i].payload(j,
+                        payloadLen);
+                    r.deltaFecDecoded += (deltaFecRecordDecoders[i].decode(
+                        payload, payloadLen, record) ==
+                        dfti::DeltaDecoder::Status::DECODED);
+                }
+            }
+        }
+    }
+    overhead = referenceBytes ?
+        static_cast<double>(rawBytes) / referenceBytes - 1 : 0;
+    return true;
+}
+
+
+//! Benchmark forward error correction over a lossy link.
+/*!
+ *  Runs runFec() with XOR parity (8 + 1) and Reed-Solomon parity (8 + 2,
+ *  16 + 4) at 1, 5, 10 and 20 % random loss, and prints the bytes added,
+ *  the datagrams lost with and without it, and the delta records decoded
+ *  with and without it.
+ *
+ *  \param seconds Simulated run time per configuration.
+ *  \return Zero if every datagram passed on was intact, every recoverable
+ *  one was recovered, and recovery never decoded fewer delta records.
+ */
+static int
+benchFec(quint32 seconds)
+{
+    const quint8 dataPackets[] = {8, 8, 16};
+    const quint8 parityPackets[] = {1, 2, 4};
+    const double losses[] = {0.01, 0.05, 0.1, 0.2};
+    bool ok = true;
+    printf("%6s %7s %10s %8s %10s %10s %10s %8s %10s\n", "k+m", "loss_%",
+        "overhead_%", "lost_%", "residual_%", "recovered", "expected",
+        "delta_%", "delta_fec_%");
+    for (quint32 c = 0; c < 3; ++c) {
+        std::vector<FecResult> results;
+        for (double loss : losses) {
+            results.emplace_back(loss);
+        }
+        double overhead = 0;
+        if (!runFec(dataPackets[c], parityPackets[c], seconds, results,
+                overhead)) {
+            printf("verify: failed to set up the streams\n");
+            return 1;
+        }
+        for (const FecResult &r : results) {
+            const double datagrams = std::max(1u, r.datagrams);
+            const double deltaDatagrams = std::max(1u, r.deltaDatagrams);
+            printf("%3u+%-2u %7.1f %10.1f %8.2f %10.2f %10u %10u %8.1f "
+                "%10.1f\n", dataPackets[c], parityPackets[c], 100 * r.loss,
+                100 * overhead, 100 * r.lost / datagrams,
+                100 * (r.datagrams - r.delivered) / datagrams, r.recovered,
+                r.recoverable, 100 * r.deltaDecoded / deltaDatagrams,
+                100 * r.deltaFecDecoded / deltaDatagrams);
+            ok = ok && r.datagrams && !r.mismatched &&
+                r.recovered == r.recoverable &&
+                r.delivered == r.datagrams - r.lost + r.recovered &&
+                r.deltaFecDecoded >= r.deltaDecoded;
+        }
+    }
+    printf("verify: %s\n", ok ? "every datagram passed on was intact and "
+        "every recoverable loss was recovered" :
+        "datagrams corrupted or not recovered");
+    return ok ? 0 : 1;
+}
+
+
+//! Main benchmark application function.
+/*!
+ *  Main function file for the DFTI benchmark program. Runs the selected
+ *  benchmark in the main thread and prints the results to stdout.
+ *  \param argc Number of command line arguments.
+ *  \param argv Array of command line arguments.
+ */
+int
+main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(app_name);
+    QCoreApplication::setApplicationVersion(dfti::app_version);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("dfti_bench -- benchmark DFTI hot paths");
+    // Positional Arguments
+    parser.addPositionalArgument("benchmark",
+        QCoreApplication::translate("main",
+            "Benchmark to run, one of (log, every, crc, mavlink, uadc, rio,"
+            " clocksync, time, sched, reactor, termios, framer, telemetry,"
+            " fanout, subscribe, delta, fec)."));
+    // Options
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption(QCommandLineOption({"t", "seconds"},
+        "Simulated run time per case in seconds (default 60).", "seconds",
+        "60"));
+    parser.addOption(QCommandLineOption({"i", "input"},
+        "Recorded input stream for benchmarks that replay one.", "file"));
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    QString benchmark = args.isEmpty() ? QString("log") : args.first();
+    quint32 seconds = parser.value("seconds").toUInt();
+
+    if (benchmark == "log") {
+        return benchLog(seconds);
+    }
+    if (benchmark == "every") {
+        return benchEvery(seconds);
+    }
+    if (benchmark == "crc") {
+        return benchCRC(seconds);
+    }
+    if (benchmark == "mavlink") {
+        return benchMAVLink(seconds, parser.value("input"));
+    }
+    if (benchmark == "uadc") {
+        return benchUADC(seconds);
+    }
+    if (benchmark == "rio") {
+        return benchRIO(seconds);
+    }
+    if (benchmark == "clocksync") {
+        return benchClockSync(seconds);
+    }
+    if (benchmark == "time") {
+        return benchTime(seconds);
+    }
+    if (benchmark == "sched") {
+        return benchSchedule(seconds);
+    }
+    if (benchmark == "reactor") {
+        return benchReactor(seconds);
+    }
+    if (benchmark == "termios") {
+        return benchTermios(seconds);
+    }
+    if (benchmark == "framer") {
+        return benchFramer(seconds);
+    }
+    if (benchmark == "telemetry") {
+        return benchTelemetry(seconds);
+    }
+    if (benchmark == "fanout") {
+        return benchFanout(seconds);
+    }
+    if (benchmark == "subscribe") {
+        return benchSubscribe(seconds);
+    }
+    if (benchmark == "delta") {
+        return benchDelta(seconds, parser.value("input"));
+    }
+    if (benchmark == "fec") {
+        return benchFec(seconds);
+    }
+    qWarning() << "Benchmark must be one of {log, every, crc, mavlink, uadc,"
+               << "rio, clocksync, time, sched, reactor, termios, framer,"
+               << "telemetry, fanout, subscribe, delta, fec}";
+    return -1;
+}
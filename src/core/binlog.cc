@@ -0,0 +1,282 @@
+/*!
+ *  \file binlog.cc
+ *  \brief DFTI binary log record format implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "binlog.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Record schemas
+// ----------------------------------------------------------------------------
+
+//! Autopilot record fields.
+static const BinlogField apFields[] = {
+    {'Q', 1, "unix_time"},
+    {'Q', 1, "gps_rx_time_ns"},
+    {'I', 1, "rc_in_time"},
+    {'H', 8, "rc_in_pwm"},
+    {'I', 1, "rc_out_time"},
+    {'H', 8, "rc_out_pwm"}
+};
+
+//! RIO record fields.
+static const BinlogField rioFields[] = {
+    {'Q', 1, "unix_time"},
+    {'Q', 1, "gps_rx_time_ns"},
+    {'B', 1, "rio_num_values"},
+    {'f', binlogMaxRIOValues, "rio_value"}
+};
+
+//! uADC record fields.
+static const BinlogField uadcFields[] = {
+    {'Q', 1, "unix_time"},
+    {'Q', 1, "gps_rx_time_ns"},
+    {'I', 1, "uadc_id"},
+    {'f', 1, "ias_mps"},
+    {'f', 1, "aoa_deg"},
+    {'f', 1, "aos_deg"},
+    {'H', 1, "alt_m"},
+    {'I', 1, "pt_pa"},
+    {'I', 1, "ps_pa"}
+};
+
+//! VN-200 record fields.
+static const BinlogField vn200Fields[] = {
+    {'Q', 1, "unix_time"},
+    {'Q', 1, "gps_rx_time_ns"},
+    {'Q', 1, "gps_time_ns"},
+    {'f', 3, "euler_deg"},
+    {'f', 4, "quat"},
+    {'f', 3, "rates_rps"},
+    {'d', 3, "pos_deg_deg_m"},
+    {'f', 3, "vel_ned_mps"},
+    {'f', 3, "accel_mps2"}
+};
+
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+
+//! Get the field table for a sensor.
+static const BinlogField *
+fieldsFor(BinlogSensor sensor, quint16 &count)
+{
+    switch (sensor) {
+        case BinlogSensor::AUTOPILOT:
+            count = sizeof(apFields) / sizeof(BinlogField);
+            return apFields;
+        case BinlogSensor::RIO:
+            count = sizeof(rioFields) / sizeof(BinlogField);
+            return rioFields;
+        case BinlogSensor::UADC:
+            count = sizeof(uadcFields) / sizeof(BinlogField);
+            return uadcFields;
+        case BinlogSensor::VN200:  // fallthrough
+        default:
+            count = sizeof(vn200Fields) / sizeof(BinlogField);
+            return vn200Fields;
+    }
+}
+
+
+//! Size in bytes of a Python struct format character.
+static quint8
+typeSize(char type)
+{
+    switch (type) {
+        case 'B':
+            return 1;
+        case 'H':
+            return 2;
+        case 'I':  // fallthrough
+        case 'f':
+            return 4;
+        case 'Q':  // fallthrough
+        case 'd':  // fallthrough
+        default:
+            return 8;
+    }
+}
+
+
+//! Sequential little-endian writer over a record buffer.
+class RecordPacker
+{
+public:
+    explicit RecordPacker(uchar *buf) : start(buf), pos(buf) { };
+
+    template <typename T>
+    void put(T value)
+    {
+        qToLittleEndian<T>(value, pos);
+        pos += sizeof(T);
+    }
+
+    void put(float value)
+    {
+        quint32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        put<quint32>(bits);
+    }
+
+    void put(double value)
+    {
+        quint64 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        put<quint64>(bits);
+    }
+
+    quint16 size(void) const { return static_cast<quint16>(pos - start); }
+
+private:
+    uchar *start;
+    uchar *pos;
+};
+
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+bool
+writeBinlogHeader(QIODevice *dev, BinlogSensor sensor)
+{
+    quint16 count = 0;
+    const BinlogField *fields = fieldsFor(sensor, count);
+
+    QByteArray header(binlogMagic, 4);
+    uchar word[2];
+    qToLittleEndian<quint16>(binlogVersion, word);
+    header.append(reinterpret_cast<const char *>(word), 2);
+    header.append(static_cast<char>(sensor));
+    qToLittleEndian<quint16>(binlogRecordSize(sensor), word);
+    header.append(reinterpret_cast<const char *>(word), 2);
+    qToLittleEndian<quint16>(count, word);
+    header.append(reinterpret_cast<const char *>(word), 2);
+    for (quint16 i = 0; i < count; ++i) {
+        quint8 len = static_cast<quint8>(strlen(fields[i].name));
+        header.append(fields[i].type);
+        header.append(static_cast<char>(fields[i].count));
+        header.append(static_cast<char>(len));
+        header.append(fields[i].name, len);
+    }
+    return dev->write(header) == header.size();
+}
+
+
+quint16
+binlogRecordSize(BinlogSensor sensor)
+{
+    quint16 count = 0;
+    quint16 size = 0;
+    const BinlogField *fields = fieldsFor(sensor, count);
+    for (quint16 i = 0; i < count; ++i) {
+        size += fields[i].count * typeSize(fields[i].type);
+    }
+    return size;
+}
+
+
+quint16
+encodeAPRecord(uchar *buf, quint64 ts, quint64 gpsTs, const APData &data)
+{
+    RecordPacker rec(buf);
+    rec.put<quint64>(ts);
+    rec.put<quint64>(gpsTs);
+    rec.put<quint32>(data.rcInTime);
+    rec.put<quint16>(data.rcIn1);
+    rec.put<quint16>(data.rcIn2);
+    rec.put<quint16>(data.rcIn3);
+    rec.put<quint16>(data.rcIn4);
+    rec.put<quint16>(data.rcIn5);
+    rec.put<quint16>(data.rcIn6);
+    rec.put<quint16>(data.rcIn7);
+    rec.put<quint16>(data.rcIn8);
+    rec.put<quint32>(data.rcOutTime);
+    rec.put<quint16>(data.rcOut1);
+    rec.put<quint16>(data.rcOut2);
+    rec.put<quint16>(data.rcOut3);
+    rec.put<quint16>(data.rcOut4);
+    rec.put<quint16>(data.rcOut5);
+    rec.put<quint16>(data.rcOut6);
+    rec.put<quint16>(data.rcOut7);
+    rec.put<quint16>(data.rcOut8);
+    return rec.size();
+}
+
+
+quint16
+encodeRIORecord(uchar *buf, quint64 ts, quint64 gpsTs, const RIOData &data)
+{
+    RecordPacker rec(buf);
+    quint8 count = data.numValues > binlogMaxRIOValues ?
+        binlogMaxRIOValues : data.numValues;
+    rec.put<quint64>(ts);
+    rec.put<quint64>(gpsTs);
+    rec.put<quint8>(count);
+    for (quint8 i = 0; i < binlogMaxRIOValues; ++i) {
+        rec.put(i < count ? data.values[i] : 0.0f);
+    }
+    return rec.size();
+}
+
+
+quint16
+encodeUADCRecord(uchar *buf, quint64 ts, quint64 gpsTs, const uADCData &data)
+{
+    RecordPacker rec(buf);
+    rec.put<quint64>(ts);
+    rec.put<quint64>(gpsTs);
+    rec.put<quint32>(data.id);
+    rec.put(data.iasMps);
+    rec.put(data.aoaDeg);
+    rec.put(data.aosDeg);
+    rec.put<quint16>(data.altM);
+    rec.put<quint32>(data.ptPa);
+    rec.put<quint32>(data.psPa);
+    return rec.size();
+}
+
+
+quint16
+encodeVN200Record(uchar *buf, quint64 ts, quint64 gpsTs, const VN200Data &data)
+{
+    RecordPacker rec(buf);
+    rec.put<quint64>(ts);
+    rec.put<quint64>(gpsTs);
+    rec.put<quint64>(data.gpsTimeNs);
+    for (quint8 i = 0; i < 3; ++i) {
+        rec.put(data.eulerDeg[i]);
+    }
+    for (quint8 i = 0; i < 4; ++i) {
+        rec.put(data.quaternion[i]);
+    }
+    for (quint8 i = 0; i < 3; ++i) {
+        rec.put(data.angularRatesRPS[i]);
+    }
+    for (quint8 i = 0; i < 3; ++i) {
+        rec.put(data.posDegDegM[i]);
+    }
+    for (quint8 i = 0; i < 3; ++i) {
+        rec.put(data.velNedMps[i]);
+    }
+    for (quint8 i = 0; i < 3; ++i) {
+        rec.put(data.accelMps2[i]);
+    }
+    return rec.size();
+}
+
+
+};  // namespace dfti
@@ -0,0 +1,153 @@
+/*!
+ *  \file binlog.hh
+ *  \brief DFTI binary log record format.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cstring>
+// 3rd party
+#include <QIODevice>
+#include <QtEndian>
+// dfti
+#include "autopilot/autopilot.hh"
+#include "rio/rio.hh"
+#include "uadc/uadc.hh"
+#include "vn200/vn200.hh"
+
+
+namespace dfti {
+
+
+//! Binary log file magic bytes.
+const char binlogMagic[] = "DFTI";
+
+//! Binary log format version.
+/*!
+ *  \remark Bump this whenever a record layout changes so that offline tools
+ *      can reject or convert older files.
+ */
+const quint16 binlogVersion = 2;
+
+//! Maximum number of RIO values stored in a binary RIO record.
+const quint8 binlogMaxRIOValues = 16;
+
+//! Size of the largest binary record, in bytes.
+const quint16 binlogMaxRecordSize = 128;
+
+
+//! Sensor identifiers written to the binary log schema header.
+enum class BinlogSensor : quint8 {
+    AUTOPILOT = 1,  /// MAVLink-based autopilot
+    RIO       = 2,  /// Remote I/O unit
+    UADC      = 3,  /// Micro Air Data Computer
+    VN200     = 4   /// VN-200 INS
+};
+
+
+//! Binary log field descriptor.
+/*!
+ *  The type is given as a Python struct format character (B, H, I, Q, f, d)
+ *  so that the schema can be turned directly into a struct format string.
+ */
+struct BinlogField
+{
+    //! Python struct format character.
+    char type;
+    //! Number of consecutive values of this type.
+    quint8 count;
+    //! Field name.
+    const char *name;
+};
+
+
+//! Write the schema header for a binary log file.
+/*!
+ *  The header is laid out, little-endian, as
+ *
+ *  - the magic bytes "DFTI"
+ *  - the format version (quint16)
+ *  - the sensor identifier (quint8)
+ *  - the record size in bytes (quint16)
+ *  - the number of fields (quint16)
+ *
+ *  followed by one descriptor per field consisting of the struct format
+ *  character, the value count, the name length (each a quint8) and the name.
+ *  Fixed-size records follow the header until the end of the file.
+ *
+ *  \param dev Device to write to.
+ *  \param sensor Sensor type of the records in the file.
+ *  \return True if the header was written completely.
+ */
+bool writeBinlogHeader(QIODevice *dev, BinlogSensor sensor);
+
+
+//! Size of a binary record for a given sensor, in bytes.
+/*!
+ *  \param sensor Sensor type.
+ *  \return Record size in bytes.
+ */
+quint16 binlogRecordSize(BinlogSensor sensor);
+
+
+//! Encode an autopilot record.
+/*!
+ *  \param buf Output buffer, at least binlogMaxRecordSize bytes.
+ *  \param ts Host timestamp in microseconds.
+ *  \param gpsTs GPS time of the same instant in nanoseconds, or 0 if unknown.
+ *  \param data Autopilot data.
+ *  \return Number of bytes encoded.
+ */
+quint16 encodeAPRecord(uchar *buf, quint64 ts, quint64 gpsTs,
+    const APData &data);
+
+
+//! Encode a RIO record.
+/*!
+ *  \remark Values beyond binlogMaxRIOValues are dropped; unused slots are
+ *      zero and the value count field gives the number in use.
+ *  \param buf Output buffer, at least binlogMaxRecordSize bytes.
+ *  \param ts Host timestamp in microseconds.
+ *  \param gpsTs GPS time of the same instant in nanoseconds, or 0 if unknown.
+ *  \param data RIO data.
+ *  \return Number of bytes encoded.
+ */
+quint16 encodeRIORecord(uchar *buf, quint64 ts, quint64 gpsTs,
+    const RIOData &data);
+
+
+//! Encode a uADC record.
+/*!
+ *  \param buf Output buffer, at least binlogMaxRecordSize bytes.
+ *  \param ts Host timestamp in microseconds.
+ *  \param gpsTs GPS time of the same instant in nanoseconds, or 0 if unknown.
+ *  \param data uADC data.
+ *  \return Number of bytes encoded.
+ */
+quint16 encodeUADCRecord(uchar *buf, quint64 ts, quint64 gpsTs,
+    const uADCData &data);
+
+
+//! Encode a VN-200 record.
+/*!
+ *  \param buf Output buffer, at least binlogMaxRecordSize bytes.
+ *  \param ts Host timestamp in microseconds.
+ *  \param gpsTs GPS time of the same instant in nanoseconds, or 0 if unknown.
+ *  \param data VN-200 data.
+ *  \return Number of bytes encoded.
+ */
+quint16 encodeVN200Record(uchar *buf, quint64 ts, quint64 gpsTs,
+    const VN200Data &data);
+
+
+};  // namespace dfti
@@ -36,6 +36,48 @@ enum class AvailableSensors : quint8 {
 };
 
 
+//! Log file format enumeration.
+enum class LogFormat : quint8 {
+    CSV    = 0,  /// Comma-separated text, one row per log tick
+    BINARY = 1   /// Fixed-size little-endian records after a schema header
+};
+
+
+//! Log scheduling mode enumeration.
+enum class LogMode : quint8 {
+    SAMPLE_HOLD  = 0,  /// Latest value of each sensor written every log tick
+    EVERY_SAMPLE = 1   /// Every measurement written once with its own timestamp
+};
+
+
+//! Sensor threading layout enumeration.
+enum class ThreadMode : quint8 {
+    SENSOR_THREADS = 0,  /// One thread with a Qt event loop per sensor
+    REACTOR        = 1   /// All serial ports read by one epoll thread
+};
+
+
+//! Serial port backend enumeration.
+enum class SerialBackend : quint8 {
+    QT      = 0,  /// QSerialPort
+    TERMIOS = 1   /// tty opened directly with termios (see TermiosPort)
+};
+
+
+//! Server send mode enumeration.
+enum class ServerMode : quint8 {
+    PERIODIC = 0,  /// State data sent every send period
+    EVENT    = 1   /// State data sent on every VN-200 measurement
+};
+
+
+//! RIO serial protocol enumeration.
+enum class RIOProtocol : quint8 {
+    ASCII  = 1,  /// "$$$" delimited text frames with an XOR checksum
+    BINARY = 2   /// Binary frames with sequence counter and CRC (v2)
+};
+
+
 //! Debugging Mode enumeration
 enum class DebugMode : quint8
 {
@@ -23,13 +23,9 @@ namespace dfti {
 Logger::Logger(Settings *_settings, QObject* _parent)
 : settings(_settings), QObject(_parent)
 {
-    // Get ISO date timestamp.
-    QDateTime local(QDateTime::currentDateTime());
-    QDateTime UTC(local.toTimeSpec(Qt::UTC));
-    // QDateTime format doesn't support formatters without separators, so use
-    // a dummy value 'R' and then replace it.
-    timestamp = UTC.toString("yyyy'R'MM'R'dd'T'HH'R'mm");
-    timestamp.replace(QString("R"), QString(""));
+    timestamp = fileTimestamp();
+
+    binaryLog = settings->logFormat() == LogFormat::BINARY;
 }
 
 
@@ -44,8 +40,9 @@ void
 Logger::enableAutopilot(Autopilot *ap)
 {
     haveAP = true;
-    connect(ap, &Autopilot::measurementUpdate, this, &Logger::getAPData);
-    openLogFile(apLogFile, apLogFileOpen, "autopilot", timestamp);
+    ap->attachQueue(&apQueue);
+    openLogFile(apLogFile, apLogFileOpen, apOut, "autopilot", timestamp,
+        BinlogSensor::AUTOPILOT);
 }
 
 
@@ -53,8 +50,9 @@ void
 Logger::enableRIO(RIO *rio)
 {
     haveRIO = true;
-    connect(rio, &RIO::measurementUpdate, this, &Logger::getRIOData);
-    openLogFile(rioLogFile, rioLogFileOpen, "rio", timestamp);
+    rio->attachQueue(&rioQueue);
+    openLogFile(rioLogFile, rioLogFileOpen, rioOut, "rio", timestamp,
+        BinlogSensor::RIO);
 }
 
 
@@ -62,8 +60,9 @@ void
 Logger::enableUADC(uADC *adc)
 {
     haveUADC = true;
-    connect(adc, &uADC::measurementUpdate, this, &Logger::getUADCData);
-    openLogFile(uADCLogFile, uADCLogFileOpen, "uadc", timestamp);
+    adc->attachQueue(&uadcQueue);
+    openLogFile(uADCLogFile, uADCLogFileOpen, uADCOut, "uadc", timestamp,
+        BinlogSensor::UADC);
 }
 
 
@@ -71,39 +70,79 @@ void
 Logger::enableVN200(VN200 *ins)
 {
     haveVN200 = true;
-    connect(ins, &VN200::measurementUpdate, this, &Logger::getVN200Data);
+    ins->attachQueue(&vn200Queue);
     connect(ins, &VN200::gpsAvailable, this, &Logger::gpsAvailable);
-    openLogFile(vn200LogFile, vn200LogFileOpen, "vn200", timestamp);
+    openLogFile(vn200LogFile, vn200LogFileOpen, vn200Out, "vn200", timestamp,
+        BinlogSensor::VN200);
+}
+
+
+void
+Logger::setClockSync(ClockSync *sync)
+{
+    clockSync = sync;
 }
 
 
 void
 Logger::start(void)
 {
-    writeTimer = new QTimer(this);
-    connect(QTIMERPTR(writeTimer), &QTimer::timeout, this, &Logger::writeData);
+    writeScheduler = new Scheduler(this);
+    connect(SCHEDPTR(writeScheduler), &Scheduler::tick, this,
+        &Logger::writeData);
     flushTimer = new QTimer(this);
     connect(QTIMERPTR(flushTimer), &QTimer::timeout, this, &Logger::flush);
-    writeTimer->start(settings->logRateMs());
+    writeScheduler->start(settings->logPeriodUsec());
     flushTimer->start(settings->flushRateMs());
 }
 
+
+LogCounters
+Logger::counters(BinlogSensor sensor) const
+{
+    LogCounters c;
+    switch (sensor) {
+        case BinlogSensor::AUTOPILOT:
+            c.written = apWritten;
+            c.dropped = apQueue.overflows();
+            break;
+        case BinlogSensor::RIO:
+            c.written = rioWritten;
+            c.dropped = rioQueue.overflows();
+            break;
+        case BinlogSensor::UADC:
+            c.written = uadcWritten;
+            c.dropped = uadcQueue.overflows();
+            break;
+        case BinlogSensor::VN200:
+            c.written = vn200Written;
+            c.dropped = vn200Queue.overflows();
+            break;
+    }
+    return c;
+}
+
 // ----------------------------------------------------------------------------
 // Public Slots
 // ----------------------------------------------------------------------------
 void
 Logger::flush(void)
 {
+    reportOverflows();
     if (apLogFileOpen) {
+        apOut.flush();
         apLogFile.flush();
     }
     if (rioLogFileOpen) {
+        rioOut.flush();
         rioLogFile.flush();
     }
     if (uADCLogFileOpen) {
+        uADCOut.flush();
         uADCLogFile.flush();
     }
     if (vn200LogFileOpen) {
+        vn200Out.flush();
         vn200LogFile.flush();
     }
 }
@@ -112,24 +151,7 @@ Logger::flush(void)
 void
 Logger::getAPData(APData data)
 {
-    rcInTime = data.rcInTime;
-    rcIn1 = data.rcIn1;
-    rcIn2 = data.rcIn2;
-    rcIn3 = data.rcIn3;
-    rcIn4 = data.rcIn4;
-    rcIn5 = data.rcIn5;
-    rcIn6 = data.rcIn6;
-    rcIn7 = data.rcIn7;
-    rcIn8 = data.rcIn8;
-    rcOutTime = data.rcOutTime;
-    rcOut1 = data.rcOut1;
-    rcOut2 = data.rcOut2;
-    rcOut3 = data.rcOut3;
-    rcOut4 = data.rcOut4;
-    rcOut5 = data.rcOut5;
-    rcOut6 = data.rcOut6;
-    rcOut7 = data.rcOut7;
-    rcOut8 = data.rcOut8;
+    apData = data;
     newAPData = true;
     if (settings->debugSerial()) {
         qDebug() << "Logger::getAPData";
@@ -140,7 +162,7 @@ Logger::getAPData(APData data)
 void
 Logger::getRIOData(RIOData data)
 {
-    rioData = data.values;
+    rioData = data;
     newRIOData = true;
     if (settings->debugSerial()) {
         qDebug() << "Logger::getRIOData";
@@ -151,13 +173,7 @@ Logger::getRIOData(RIOData data)
 void
 Logger::getUADCData(uADCData data)
 {
-    uadcId = data.id;
-    iasMps = data.iasMps;
-    aoaDeg = data.aoaDeg;
-    aosDeg = data.aosDeg;
-    altM = data.altM;
-    ptPa = data.ptPa;
-    psPa = data.psPa;
+    uadcData = data;
     newUADCData = true;
     if (settings->debugSerial()) {
         qDebug() << "Logger::getuADCData";
@@ -168,16 +184,7 @@ Logger::getUADCData(uADCData data)
 void
 Logger::getVN200Data(VN200Data data)
 {
-    gpsTimeNs = data.gpsTimeNs;
-    for (quint8 i = 0; i < 3; ++i) {
-        eulerDeg[i] = data.eulerDeg[i];
-        quaternion[i] = data.quaternion[i];
-        angularRatesRPS[i] = data.angularRatesRPS[i];
-        posDegDegM[i] = data.posDegDegM[i];
-        velNedMps[i] = data.velNedMps[i];
-        accelMps2[i] = data.accelMps2[i];
-    }
-    quaternion[3] = data.quaternion[3];
+    vn200Data = data;
     newVN200Data = true;
     if (settings->debugSerial()) {
         qDebug() << "Logger::getVN200Data";
@@ -193,12 +200,13 @@ Logger::gpsAvailable(bool flag)
         // Make sure we haven't already set the system time and that the GPS
         // time value actually is GPS time. (Current GPS timestamp in
         // nanoseconds should always be greater than 1e18.)
-        if ((!setSystemTime) && (gpsTimeNs > 1e18)) {
+        if ((!setSystemTime) && (vn200Data.gpsTimeNs > 1e18)) {
             // See http://unix.stackexchange.com/a/84138
             QString program{"date"};
             QStringList arguments;
             arguments << "+%s" << "-s"
-                      << QString("@%1").arg(gpsToUnixSec(gpsTimeNs));
+                      << QString("@%1").arg(
+                             gpsToUnixSec(vn200Data.gpsTimeNs));
             QProcess process(this);
             process.start(program, arguments);
             // Assume we set the system time.
@@ -225,19 +233,195 @@ Logger::gpsAvailable(bool flag)
 void
 Logger::writeData(void)
 {
-    QTextStream apOut(&apLogFile);
-    QTextStream rioOut(&rioLogFile);
-    QTextStream uADCOut(&uADCLogFile);
-    QTextStream vn200Out(&vn200LogFile);
-    apOut.setRealNumberNotation(QTextStream::FixedNotation);
-    rioOut.setRealNumberNotation(QTextStream::FixedNotation);
-    uADCOut.setRealNumberNotation(QTextStream::FixedNotation);
-    vn200Out.setRealNumberNotation(QTextStream::FixedNotation);
-
-    if (firstWrite) {
-        // VN-200 data.
-        if (logVN200()) {
+    if (settings->logMode() == LogMode::EVERY_SAMPLE) {
+        writeSamples();
+        return;
+    }
+
+    // Pick up everything the sensors have published since the last tick.
+    drainQueues();
+
+    // Each row is stamped with the time its measurement was received, not
+    // the time of this tick, so rows from different sensors line up. Until a
+    // sensor has sent anything the tick time is used.
+    const quint64 ts = getTimeUsec();
+    auto stamp = [ts](quint64 rx) { return rx ? rx : ts; };
+
+    // VN-200 data.
+    if (logVN200()) {
+        writeVN200(stamp(vn200Data.timeUsec), vn200Data);
+        newVN200Data = false;
+    }
+
+    // RIO data.
+    if (logRIO()) {
+        writeRIO(stamp(rioData.timeUsec), rioData);
+        newRIOData = false;
+    }
+
+    // Air data system data.
+    if (logUADC()) {
+        writeUADC(stamp(uadcData.timeUsec), uadcData);
+        newUADCData = false;
+    }
+
+    // Autopilot data.
+    if (logAP()) {
+        writeAP(stamp(apData.timeUsec), apData);
+        newAPData = false;
+    }
+
+    if (settings->debugSerial()) {
+        qDebug() << "Logger:writeData";
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+void
+Logger::drainQueues(void)
+{
+    // Sample-and-hold: only the most recent measurement from each sensor is
+    // kept for the log tick.
+    APData ap;
+    if (apQueue.drain([&ap](const APData &d) { ap = d; })) {
+        getAPData(ap);
+    }
+    RIOData rio;
+    if (rioQueue.drain([&rio](const RIOData &d) { rio = d; })) {
+        getRIOData(rio);
+    }
+    uADCData adc;
+    if (uadcQueue.drain([&adc](const uADCData &d) { adc = d; })) {
+        getUADCData(adc);
+    }
+    VN200Data ins;
+    if (vn200Queue.drain([&ins](const VN200Data &d) { ins = d; })) {
+        getVN200Data(ins);
+    }
+}
+
+
+void
+Logger::writeSamples(void)
+{
+    // Every queued measurement is written exactly once, stamped with the time
+    // the sensor thread received it rather than the time of this tick. The
+    // latest value is still kept for anything that looks at it (e.g. the GPS
+    // time used to set the system clock).
+    if (apLogFileOpen) {
+        apQueue.drain([this](const APData &d) {
+            apData = d;
+            writeAP(d.timeUsec, d);
+        });
+    }
+    if (rioLogFileOpen) {
+        rioQueue.drain([this](const RIOData &d) {
+            rioData = d;
+            writeRIO(d.timeUsec, d);
+        });
+    }
+    if (uADCLogFileOpen) {
+        uadcQueue.drain([this](const uADCData &d) {
+            uadcData = d;
+            writeUADC(d.timeUsec, d);
+        });
+    }
+    if (vn200LogFileOpen) {
+        vn200Queue.drain([this](const VN200Data &d) {
+            vn200Data = d;
+            writeVN200(d.timeUsec, d);
+        });
+    }
+
+    if (settings->debugSerial()) {
+        qDebug() << "Logger:writeSamples";
+    }
+}
+
+
+void
+Logger::reportOverflows(void)
+{
+    quint32 total = apQueue.overflows() + rioQueue.overflows() +
+        uadcQueue.overflows() + vn200Queue.overflows();
+    if (total != overflows) {
+        qWarning() << "[WARN ]  logger queue overflows: ap"
+                   << apQueue.overflows() << "rio" << rioQueue.overflows()
+                   << "uadc" << uadcQueue.overflows()
+                   << "vn200" << vn200Queue.overflows();
+        overflows = total;
+    }
+    // Ticks are only scheduled once started; replay drives writeData itself.
+    const SchedulerStats ticks = writeScheduler ? writeScheduler->stats() :
+        SchedulerStats();
+    if (ticks.missed != missedTicks) {
+        qWarning() << "[WARN ]  logger missed" << ticks.missed - missedTicks
+                   << "ticks; worst tick" << 1e-3 * ticks.maxLateNs
+                   << "us late";
+        missedTicks = ticks.missed;
+    }
+    if (settings->debugSerial()) {
+        QStringList bins;
+        for (quint32 i = 0; i < numJitterBins; ++i) {
+            bins << QString::number(ticks.histogram[i]);
+        }
+        qDebug() << "Logger: tick lateness histogram (<1, 2, 4, ... us):"
+                 << bins.join(" ");
+        qDebug() << "Logger: records written: ap" << apWritten
+                 << "rio" << rioWritten
+                 << "uadc" << uadcWritten
+                 << "vn200" << vn200Written;
+    }
+}
+
+
+void
+Logger::writeCSVHeader(BinlogSensor sensor)
+{
+    switch (sensor) {
+        case BinlogSensor::AUTOPILOT:
+            apOut << "unix_time" << delim
+                  << "gps_rx_time_ns" << delim
+                  << "rc_in_time" << delim
+                  << "rc_in_1_pwm" << delim
+                  << "rc_in_2_pwm" << delim
+                  << "rc_in_3_pwm" << delim
+                  << "rc_in_4_pwm" << delim
+                  << "rc_in_5_pwm" << delim
+                  << "rc_in_6_pwm" << delim
+                  << "rc_in_7_pwm" << delim
+                  << "rc_in_8_pwm" << delim
+                  << "rc_out_time" << delim
+                  << "rc_out_1_pwm" << delim
+                  << "rc_out_2_pwm" << delim
+                  << "rc_out_3_pwm" << delim
+                  << "rc_out_4_pwm" << delim
+                  << "rc_out_5_pwm" << delim
+                  << "rc_out_6_pwm" << delim
+                  << "rc_out_7_pwm" << delim
+                  << "rc_out_8_pwm" << '\n';
+            break;
+        case BinlogSensor::RIO:
+            // The number of RIO values is only known from the first packet,
+            // so this header is written along with the first row.
+            break;
+        case BinlogSensor::UADC:
+            uADCOut << "unix_time" << delim
+                    << "gps_rx_time_ns" << delim
+                    << "uadc_id" << delim
+                    << "ias_mps" << delim
+                    << "aoa_deg" << delim
+                    << "aos_deg" << delim
+                    << "alt_m" << delim
+                    << "pt_pa" << delim
+                    << "ps_pa" << '\n';
+            break;
+        case BinlogSensor::VN200:
             vn200Out << "unix_time" << delim
+                     << "gps_rx_time_ns" << delim
                      << "gps_time_ns" << delim
                      << "psi_deg" << delim
                      << "theta_deg" << delim
@@ -258,152 +442,160 @@ Logger::writeData(void)
                      << "Ax_mps2" << delim
                      << "Ay_mps2" << delim
                      << "Az_mps2" << '\n';
-          firstWrite = false;
-        }
-        // RIO data.
-        if (logRIO()){
-          rioOut << "unix_time";
-          for (quint8 i = 0; i < rioData.size(); ++i) {
-            rioOut << delim << "rio_value_" << i;
-          }
-          rioOut << '\n';
-          firstWrite = false;
-        }
-        // Air data system data.
-        if (logUADC()) {
-            uADCOut << "unix_time" << delim
-                    << "uadc_id" << delim
-                    << "ias_mps" << delim
-                    << "aoa_deg" << delim
-                    << "aos_deg" << delim
-                    << "alt_m" << delim
-                    << "pt_pa" << delim
-                    << "ps_pa" << '\n';
-          firstWrite = false;
-        }
-        // Autopilot data.
-        if (logAP()) {
-            apOut << "unix_time" << delim
-                  << "rc_in_time" << delim
-                  << "rc_in_1_pwm" << delim
-                  << "rc_in_2_pwm" << delim
-                  << "rc_in_3_pwm" << delim
-                  << "rc_in_4_pwm" << delim
-                  << "rc_in_5_pwm" << delim
-                  << "rc_in_6_pwm" << delim
-                  << "rc_in_7_pwm" << delim
-                  << "rc_in_8_pwm" << delim
-                  << "rc_out_time" << delim
-                  << "rc_out_1_pwm" << delim
-                  << "rc_out_2_pwm" << delim
-                  << "rc_out_3_pwm" << delim
-                  << "rc_out_4_pwm" << delim
-                  << "rc_out_5_pwm" << delim
-                  << "rc_out_6_pwm" << delim
-                  << "rc_out_7_pwm" << delim
-                  << "rc_out_8_pwm" << '\n';
-          firstWrite = false;
-        }
+            break;
     }
+}
 
-    // System time in microseconds.
-    quint64 ts = getTimeUsec();
 
-    // VN-200 data.
-    if (logVN200()) {
-        vn200Out.setRealNumberPrecision(7);  // float
-        vn200Out << ts << delim
-                 << gpsTimeNs << delim
-                 << eulerDeg[0] << delim
-                 << eulerDeg[1] << delim
-                 << eulerDeg[2] << delim
-                 << quaternion[0] << delim
-                 << quaternion[1] << delim
-                 << quaternion[2] << delim
-                 << quaternion[3] << delim
-                 << angularRatesRPS[0] << delim
-                 << angularRatesRPS[1] << delim
-                 << angularRatesRPS[2] << delim;
-        vn200Out.setRealNumberPrecision(15);  // double
-        vn200Out << posDegDegM[0] << delim
-                 << posDegDegM[1] << delim
-                 << posDegDegM[2] << delim;
-        vn200Out.setRealNumberPrecision(7);  // float
-        vn200Out << velNedMps[0] << delim
-                 << velNedMps[1] << delim
-                 << velNedMps[2] << delim
-                 << accelMps2[0] << delim
-                 << accelMps2[1] << delim
-                 << accelMps2[2] << '\n';
-        newVN200Data = false;
+void
+Logger::writeAP(quint64 ts, const APData &data)
+{
+    if (binaryLog) {
+        uchar record[binlogMaxRecordSize];
+        apLogFile.write(reinterpret_cast<const char *>(record),
+            encodeAPRecord(record, ts, gpsTime(data.rxTimeNs), data));
+    } else {
+        apOut << ts << delim
+              << gpsTime(data.rxTimeNs) << delim
+              << data.rcInTime << delim
+              << data.rcIn1 << delim
+              << data.rcIn2 << delim
+              << data.rcIn3 << delim
+              << data.rcIn4 << delim
+              << data.rcIn5 << delim
+              << data.rcIn6 << delim
+              << data.rcIn7 << delim
+              << data.rcIn8 << delim
+              << data.rcOutTime << delim
+              << data.rcOut1 << delim
+              << data.rcOut2 << delim
+              << data.rcOut3 << delim
+              << data.rcOut4 << delim
+              << data.rcOut5 << delim
+              << data.rcOut6 << delim
+              << data.rcOut7 << delim
+              << data.rcOut8 << '\n';
     }
+    ++apWritten;
+}
 
-    // RIO data.
-    if (logRIO()) {
-      rioOut << ts;
-      for (auto value : rioData) {
-        rioOut << delim << value;
-      }
-      rioOut << '\n';
-      newRIOData = false;
+
+void
+Logger::writeRIO(quint64 ts, const RIOData &data)
+{
+    if (binaryLog) {
+        uchar record[binlogMaxRecordSize];
+        rioLogFile.write(reinterpret_cast<const char *>(record),
+            encodeRIORecord(record, ts, gpsTime(data.rxTimeNs), data));
+    } else {
+        if (!rioHeaderWritten) {
+            // Nothing to name the columns after until the RIO has reported.
+            if (!data.numValues) {
+                return;
+            }
+            rioOut << "unix_time" << delim << "gps_rx_time_ns";
+            for (quint8 i = 0; i < data.numValues; ++i) {
+                rioOut << delim << "rio_value_" << i;
+            }
+            rioOut << '\n';
+            rioHeaderWritten = true;
+        }
+        rioOut << ts << delim << gpsTime(data.rxTimeNs);
+        for (quint8 i = 0; i < data.numValues; ++i) {
+            rioOut << delim << data.values[i];
+        }
+        rioOut << '\n';
     }
+    ++rioWritten;
+}
 
-    // Air data system data.
-    if (logUADC()) {
+
+void
+Logger::writeUADC(quint64 ts, const uADCData &data)
+{
+    if (binaryLog) {
+        uchar record[binlogMaxRecordSize];
+        uADCLogFile.write(reinterpret_cast<const char *>(record),
+            encodeUADCRecord(record, ts, gpsTime(data.rxTimeNs), data));
+    } else {
         // We get two decimal places from the uADC...
         uADCOut.setRealNumberPrecision(2);
         uADCOut << ts << delim
-                << uadcId << delim
-                << iasMps << delim
-                << aoaDeg << delim
-                << aosDeg << delim
-                << altM << delim
-                << ptPa << delim
-                << psPa << '\n';
-        newUADCData = false;
+                << gpsTime(data.rxTimeNs) << delim
+                << data.id << delim
+                << data.iasMps << delim
+                << data.aoaDeg << delim
+                << data.aosDeg << delim
+                << data.altM << delim
+                << data.ptPa << delim
+                << data.psPa << '\n';
     }
+    ++uadcWritten;
+}
 
-    // Autopilot data.
-    if (logAP()) {
-        apOut << ts << delim
-              << rcInTime << delim
-              << rcIn1 << delim
-              << rcIn2 << delim
-              << rcIn3 << delim
-              << rcIn4 << delim
-              << rcIn5 << delim
-              << rcIn6 << delim
-              << rcIn7 << delim
-              << rcIn8 << delim
-              << rcOutTime << delim
-              << rcOut1 << delim
-              << rcOut2 << delim
-              << rcOut3 << delim
-              << rcOut4 << delim
-              << rcOut5 << delim
-              << rcOut6 << delim
-              << rcOut7 << delim
-              << rcOut8 << '\n';
-        newAPData = false;
-    }
 
-    if (settings->debugSerial()) {
-        qDebug() << "Logger:writeData";
+void
+Logger::writeVN200(quint64 ts, const VN200Data &data)
+{
+    if (binaryLog) {
+        uchar record[binlogMaxRecordSize];
+        vn200LogFile.write(reinterpret_cast<const char *>(record),
+            encodeVN200Record(record, ts, gpsTime(data.rxTimeNs), data));
+    } else {
+        vn200Out.setRealNumberPrecision(7);  // float
+        vn200Out << ts << delim
+                 << gpsTime(data.rxTimeNs) << delim
+                 << data.gpsTimeNs << delim
+                 << data.eulerDeg[0] << delim
+                 << data.eulerDeg[1] << delim
+                 << data.eulerDeg[2] << delim
+                 << data.quaternion[0] << delim
+                 << data.quaternion[1] << delim
+                 << data.quaternion[2] << delim
+                 << data.quaternion[3] << delim
+                 << data.angularRatesRPS[0] << delim
+                 << data.angularRatesRPS[1] << delim
+                 << data.angularRatesRPS[2] << delim;
+        vn200Out.setRealNumberPrecision(15);  // double
+        vn200Out << data.posDegDegM[0] << delim
+                 << data.posDegDegM[1] << delim
+                 << data.posDegDegM[2] << delim;
+        vn200Out.setRealNumberPrecision(7);  // float
+        vn200Out << data.velNedMps[0] << delim
+                 << data.velNedMps[1] << delim
+                 << data.velNedMps[2] << delim
+                 << data.accelMps2[0] << delim
+                 << data.accelMps2[1] << delim
+                 << data.accelMps2[2] << '\n';
     }
+    ++vn200Written;
 }
 
-// ----------------------------------------------------------------------------
-//  Private functions
-// ----------------------------------------------------------------------------
+
 void
-Logger::openLogFile(QFile &fd, bool &flag, QString type, QString timestamp)
+Logger::openLogFile(QFile &fd, bool &flag, QTextStream &out, QString type,
+    QString timestamp, BinlogSensor sensor)
 {
-    fd.setFileName(QString("%1-%2.csv").arg(type, timestamp));
+    fd.setFileName(QString("%1-%2.%3").arg(type, timestamp,
+        binaryLog ? "bin" : "csv"));
     flag = fd.open(QFile::WriteOnly | QFile::Truncate);
     if (flag) {
         if (settings->debugSerial()) {
             qDebug() << "Opened log file" << fd.fileName();
         }
+        if (binaryLog) {
+            // Binary logs are self-describing, so the schema goes in up front.
+            if (!writeBinlogHeader(&fd, sensor)) {
+                qWarning() << "Failed to write log header" << fd.fileName();
+                exit(-1);
+            }
+        } else {
+            // The stream lives as long as the file so rows are buffered
+            // across ticks instead of being rebuilt for every write.
+            out.setDevice(&fd);
+            out.setRealNumberNotation(QTextStream::FixedNotation);
+            writeCSVHeader(sensor);
+        }
     } else {
         qWarning() << "Failed to open log file" << fd.fileName();
         exit(-1);
@@ -411,6 +603,13 @@ Logger::openLogFile(QFile &fd, bool &flag, QString type, QString timestamp)
 }
 
 
+quint64
+Logger::gpsTime(quint64 rxTimeNs) const
+{
+    return clockSync && rxTimeNs ? clockSync->toGpsNs(rxTimeNs) : 0;
+}
+
+
 bool
 Logger::logAP(void) {
   return apLogFileOpen && haveAP && (!settings->waitForUpdate() || newAPData);
@@ -22,15 +22,19 @@
 #include <QFile>
 #include <QObject>
 #include <QProcess>
+#include <QStringList>
 #include <QTextStream>
 #include <QTimer>
 // dfti
 #include "autopilot/autopilot.hh"
+#include "core/binlog.hh"
 #include "core/consts.hh"
 #include "core/qptrutil.hh"
 #include "rio/rio.hh"
 #include "settings/settings.hh"
 #include "uadc/uadc.hh"
+#include "util/clocksync.hh"
+#include "util/scheduler.hh"
 #include "util/util.hh"
 #include "vn200/vn200.hh"
 
@@ -38,7 +42,27 @@
 namespace dfti {
 
 
+//! Per-sensor logging counters.
+struct LogCounters
+{
+    //! Records written to the log file.
+    quint64 written{0};
+    //! Measurements dropped because the sensor queue was full.
+    quint32 dropped{0};
+};
+
+
 //! Receives data and logs to file.
+/*!
+ *  Two scheduling modes are supported (see LogMode). In sample-and-hold mode
+ *  the latest measurement from each sensor is written at every log tick, so
+ *  fast sensors are decimated and slow ones repeated unless wait_for_update
+ *  is set. In every-sample mode the log tick only paces the writer: every
+ *  queued measurement is written exactly once, giving per-sensor files at
+ *  the native sensor rate. In both modes rows carry the receive timestamp of
+ *  their measurement, taken when the read that completed the packet
+ *  returned.
+ */
 class Logger : public QObject
 {
     Q_OBJECT;
@@ -78,12 +102,32 @@ public:
      */
     void enableVN200(VN200 *ins);
 
+    //! Write GPS referenced receive times.
+    /*!
+     *  Every record gets a gps_rx_time_ns column, the receive time of its
+     *  measurement converted with the clock correlation, or 0 while the
+     *  correlation is not locked.
+     *
+     *  \param sync Clock correlation fed by the VN-200.
+     */
+    void setClockSync(ClockSync *sync);
+
     //! Start logging.
     /*!
-     *  Connects QTimers to the flush and writeData slots.
+     *  Connects a Scheduler to the writeData slot, at the log rate, and a
+     *  QTimer to the flush slot. Sensor data is drained from the per-sensor
+     *  queues at every write tick.
      */
     void start(void);
 
+    //! Return the logging counters for a sensor.
+    /*!
+     *  \param sensor Sensor to report.
+     *  \remark The written count is owned by the logging thread; call this
+     *      from that thread or once it has stopped.
+     */
+    LogCounters counters(BinlogSensor sensor) const;
+
 public slots:
     //! Slot to flush the data buffer.
     void flush(void);
@@ -111,10 +155,63 @@ private:
     /*!
      *  \param fd Reference to QFile.
      *  \param flag Reference to file open flag.
-     *  \param time Sensor type.
+     *  \param out Reference to the text stream used for CSV output.
+     *  \param type Sensor type.
      *  \param timestamp Formatted current timestamp.
+     *  \param sensor Sensor identifier for the binary log header.
+     */
+    void openLogFile(QFile &fd, bool &flag, QTextStream &out, QString type,
+        QString timestamp, BinlogSensor sensor);
+
+    //! Drain the sensor queues, passing the latest of each to its slot.
+    void drainQueues(void);
+
+    //! Warn if any sensor queue has dropped measurements since last checked.
+    void reportOverflows(void);
+
+    //! Write every queued measurement with its own receive timestamp.
+    void writeSamples(void);
+
+    //! Write the CSV column header for a sensor.
+    /*!
+     *  \param sensor Sensor whose header is written.
      */
-    void openLogFile(QFile &fd, bool &flag, QString type, QString timestamp);
+    void writeCSVHeader(BinlogSensor sensor);
+
+    //! Write one autopilot record.
+    /*!
+     *  \param ts Host timestamp in microseconds.
+     *  \param data Measurement to write.
+     */
+    void writeAP(quint64 ts, const APData &data);
+
+    //! Write one RIO record.
+    /*!
+     *  \param ts Host timestamp in microseconds.
+     *  \param data Measurement to write.
+     */
+    void writeRIO(quint64 ts, const RIOData &data);
+
+    //! Write one uADC record.
+    /*!
+     *  \param ts Host timestamp in microseconds.
+     *  \param data Measurement to write.
+     */
+    void writeUADC(quint64 ts, const uADCData &data);
+
+    //! Write one VN-200 record.
+    /*!
+     *  \param ts Host timestamp in microseconds.
+     *  \param data Measurement to write.
+     */
+    void writeVN200(quint64 ts, const VN200Data &data);
+
+    //! GPS time of a measurement.
+    /*!
+     *  \param rxTimeNs Monotonic receive time, nanoseconds.
+     *  \return GPS time, nanoseconds, or 0 if unknown.
+     */
+    quint64 gpsTime(quint64 rxTimeNs) const;
 
     //! Function to determine if MAVLink data should be logged.
     bool logAP(void);
@@ -131,8 +228,11 @@ private:
     //! Pointer to settings object.
     QPointer<Settings> settings{nullptr};
 
-    //! QTimer for writing.
-    QPointer<QTimer> writeTimer{nullptr};
+    //! Clock correlation, if any.
+    ClockSync *clockSync{nullptr};
+
+    //! Scheduler for writing.
+    QPointer<Scheduler> writeScheduler{nullptr};
 
     //! QTimer for flushing log file.
     QPointer<QTimer> flushTimer{nullptr};
@@ -167,8 +267,11 @@ private:
     //! Flag to indicate VN-200 log file is opened.
     bool vn200LogFileOpen{false};
 
-    //! Flag to indicate if this is our first write.
-    bool firstWrite{true};
+    //! Flag to indicate binary rather than CSV logs.
+    bool binaryLog{false};
+
+    //! Flag to indicate the RIO CSV header has been written.
+    bool rioHeaderWritten{false};
 
     //! Flag to indicate an A/P data update.
     bool newAPData{false};
@@ -200,152 +303,59 @@ private:
     //! VN-200 log file.
     QFile vn200LogFile;
 
-    //! RC input timestamp.
-    quint32 rcInTime{0};
-
-    //! RC input channel 1 PPM value.
-    quint16 rcIn1{0};
-
-    //! RC input channel 2 PPM value.
-    quint16 rcIn2{0};
+    //! Autopilot CSV stream.
+    QTextStream apOut;
 
-    //! RC input channel 3 PPM value.
-    quint16 rcIn3{0};
+    //! RIO CSV stream.
+    QTextStream rioOut;
 
-    //! RC input channel 4 PPM value.
-    quint16 rcIn4{0};
+    //! uADC CSV stream.
+    QTextStream uADCOut;
 
-    //! RC input channel 5 PPM value.
-    quint16 rcIn5{0};
+    //! VN-200 CSV stream.
+    QTextStream vn200Out;
 
-    //! RC input channel 6 PPM value.
-    quint16 rcIn6{0};
+    //! Autopilot measurement queue.
+    Autopilot::Queue apQueue;
 
-    //! RC input channel 7 PPM value.
-    quint16 rcIn7{0};
+    //! RIO measurement queue.
+    RIO::Queue rioQueue;
 
-    //! RC input channel 8 PPM value.
-    quint16 rcIn8{0};
+    //! uADC measurement queue.
+    uADC::Queue uadcQueue;
 
-    //! RC output timestamp.
-    quint32 rcOutTime{0};
+    //! VN-200 measurement queue.
+    VN200::Queue vn200Queue;
 
-    //! RC output channel 1 PPM value.
-    quint16 rcOut1{0};
+    //! Total queue overflows at the last report.
+    quint32 overflows{0};
 
-    //! RC output channel 2 PPM value.
-    quint16 rcOut2{0};
+    //! Missed write ticks at the last report.
+    quint64 missedTicks{0};
 
-    //! RC output channel 3 PPM value.
-    quint16 rcOut3{0};
+    //! Autopilot records written.
+    quint64 apWritten{0};
 
-    //! RC output channel 4 PPM value.
-    quint16 rcOut4{0};
+    //! RIO records written.
+    quint64 rioWritten{0};
 
-    //! RC output channel 5 PPM value.
-    quint16 rcOut5{0};
+    //! uADC records written.
+    quint64 uadcWritten{0};
 
-    //! RC output channel 6 PPM value.
-    quint16 rcOut6{0};
+    //! VN-200 records written.
+    quint64 vn200Written{0};
 
-    //! RC output channel 7 PPM value.
-    quint16 rcOut7{0};
+    //! Latest autopilot data.
+    APData apData;
 
-    //! RC output channel 8 PPM value.
-    quint16 rcOut8{0};
+    //! Latest RIO data.
+    RIOData rioData;
 
-    //! RIO data vector.
-    std::vector<float> rioData;
+    //! Latest uADC data.
+    uADCData uadcData;
 
-    //! uADC packet ID.
-    /*!
-     *  \remark This is only useful for making sure we don't drop uADC packets.
-     */
-    quint32 uadcId{0};
-
-    //! Indicated Airspeed, meters / second.
-    /*!
-     *  The indicated airspeed is measured from the uADC 5-hole probe and is
-     *  read in with the format XX.XX, which means the highest representable
-     *  airspeed is 99.99 m/s, which is about 195 knots.
-     */
-    float iasMps{0};
-
-    //! Angle-of-Attack, degrees.
-    /*!
-     *  The angle-of-attack is represented as +/-XX.XX.
-     */
-    float aoaDeg{0};
-
-    //! Sideslip Angle, degrees.
-    /*!
-     *  The sideslip angle is represented as +/-XX.XX.
-     */
-    float aosDeg{0};
-
-    //! Pressure altitude, meters.
-    quint16 altM{0};
-
-    //! Total Pressure, Pa.
-    quint32 ptPa{0};
-
-    //! Static Pressure, Pa.
-    quint32 psPa{0};
-
-    //! GPS time
-    /*!
-     *  The GPS time is represented as the absolute number of nanoseconds from
-     *  the GPS epoch, January 6, 1980 at 0000 UTC.
-     */
-    quint64 gpsTimeNs{0};
-
-    //! Euler Angles
-    /*!
-     *  Stores the 3-2-1 Euler angles psi, theta, phi in degrees. Order is yaw,
-     *  pitch, roll.
-     */
-    float eulerDeg[3] = {0};
-
-    //! Quaternion
-    /*!
-     *  Stores the attitude quaternion giving the body frame with respect to
-     *  the local North East Down frame.
-     *
-     *  Note that the VN-200 uses the last term as the scalar value in its
-     *  output, but DFTI uses the first term as the scalar as is common.
-     */
-    float quaternion[4]{0};
-
-    //! Angular Rates
-    /*!
-     *  Stores the body-axis angular rates P, Q, and R in radians per second.
-     *  Order is P, Q, R.
-     */
-    float angularRatesRPS[3]{0};
-
-    //! Lat-Long-Alt Position
-    /*!
-     *  Contains the latitude, longitude, and altitude position of the aircraft
-     *  in inertial space. The lat/long are in degrees, and the altitude is in
-     *  meters.
-     *
-     *  Order is lat, long, alt.
-     */
-    float posDegDegM[3]{0};
-
-    //! NED Velocity
-    /*!
-     *  Stores the estimated velocity in the North-East-Down frame in m/s.
-     *  Order is Vx, Vy, Vz.
-     */
-    float velNedMps[3]{0};
-
-    //! Accelerations
-    /*!
-     *  Body-axis accelerations in m/s^2. Includes the effect of gravity and is
-     *  bias compensated by the EKF. Order is Ax, Ay, Az.
-     */
-    float accelMps2[3]{0};
+    //! Latest VN-200 data.
+    VN200Data vn200Data;
 };
 
 
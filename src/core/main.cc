@@ -29,8 +29,11 @@
 #include "qptrutil.hh"
 #include "autopilot/autopilot.hh"
 #include "rio/rio.hh"
+#include "sensor/capture.hh"
+#include "sensor/reactor.hh"
 #include "server/server.hh"
 #include "uadc/uadc.hh"
+#include "util/clocksync.hh"
 #include "util/util.hh"
 #include "vn200/vn200.hh"
 
@@ -91,6 +94,10 @@ main(int argc, char* argv[])
     QPointer<dfti::RIO> rio = nullptr;
     QPointer<dfti::uADC> uadc = nullptr;
     QPointer<dfti::VN200> vn200 = nullptr;
+    QPointer<dfti::Reactor> reactor = nullptr;
+    dfti::ClockSync clockSync;
+    const bool useReactor =
+        settings.threadMode() == dfti::ThreadMode::REACTOR;
 
     // Instantiate server if enabled.
     if (settings.serverEnabled()) {
@@ -113,6 +120,29 @@ main(int argc, char* argv[])
     if (settings.useVN200()) {
         vn200 = new dfti::VN200(&settings);
         vn200->configureSerial(settings.vn200SerialPort());
+        // Correlate the host clock with GPS time, so every sensor's records
+        // get GPS referenced timestamps.
+        vn200->setClockSync(&clockSync);
+        logger->setClockSync(&clockSync);
+    }
+
+    // Capture the raw serial streams if requested. The capture file is never
+    // destroyed, like the sensors, since the application runs until killed.
+    if (settings.captureRaw()) {
+        dfti::CaptureFile *capture = new dfti::CaptureFile(
+            QString("capture-%1.cap").arg(dfti::fileTimestamp()));
+        if (settings.useMavlink()) {
+            pixhawk->enableCapture(capture, dfti::CaptureSensor::AUTOPILOT);
+        }
+        if (settings.useRIO()) {
+            rio->enableCapture(capture, dfti::CaptureSensor::RIO);
+        }
+        if (settings.useUADC()) {
+            uadc->enableCapture(capture, dfti::CaptureSensor::UADC);
+        }
+        if (settings.useVN200()) {
+            vn200->enableCapture(capture, dfti::CaptureSensor::VN200);
+        }
     }
 
     // Set up threads.
@@ -122,71 +152,113 @@ main(int argc, char* argv[])
     QPointer<QThread> rioThread = nullptr;
     QPointer<QThread> uadcThread = nullptr;
     QPointer<QThread> vn200Thread = nullptr;
+    QPointer<QThread> reactorThread = nullptr;
 
-    // Move objects to threads, and initialize sensor threads.
+    // Move objects to threads, and initialize sensor threads. In reactor
+    // mode every sensor shares the reactor's thread, which starts them.
     logger->moveToThread(loggingThread);
     if (settings.serverEnabled()) {
         serverThread = new QThread();
         server->moveToThread(serverThread);
     }
+    if (useReactor) {
+        reactor = new dfti::Reactor(&settings);
+        reactorThread = new QThread();
+        reactor->moveToThread(reactorThread);
+    }
     if (settings.useMavlink()) {
-        pixhawkThread = new QThread();
+        pixhawkThread = useReactor ? reactorThread.data() : new QThread();
         pixhawk->moveToThread(pixhawkThread);
     }
     if (settings.useRIO()) {
-        rioThread = new QThread();
+        rioThread = useReactor ? reactorThread.data() : new QThread();
         rio->moveToThread(rioThread);
     }
     if (settings.useUADC()) {
-        uadcThread = new QThread();
+        uadcThread = useReactor ? reactorThread.data() : new QThread();
         uadc->moveToThread(uadcThread);
     }
     if (settings.useVN200()) {
-        vn200Thread = new QThread();
+        vn200Thread = useReactor ? reactorThread.data() : new QThread();
         vn200->moveToThread(vn200Thread);
     }
 
     // Connect everything.
     if (settings.useMavlink()) {
         logger->enableAutopilot(APPTR(pixhawk));
-        QObject::connect(QTHREADPTR(pixhawkThread), &QThread::started,
-            APPTR(pixhawk), &dfti::Autopilot::threadStart);
+        if (settings.serverEnabled()) {
+            server->enableAutopilot(APPTR(pixhawk));
+        }
+        if (useReactor) {
+            reactor->addSensor(APPTR(pixhawk));
+        } else {
+            QObject::connect(QTHREADPTR(pixhawkThread), &QThread::started,
+                APPTR(pixhawk), &dfti::Autopilot::threadStart);
+        }
     }
     if (settings.useRIO()) {
         logger->enableRIO(RIOPTR(rio));
-        server->enableRIO(RIOPTR(rio));
-        QObject::connect(QTHREADPTR(rioThread), &QThread::started, RIOPTR(rio),
-            &dfti::RIO::threadStart);
+        if (settings.serverEnabled()) {
+            server->enableRIO(RIOPTR(rio));
+        }
+        if (useReactor) {
+            reactor->addSensor(RIOPTR(rio));
+        } else {
+            QObject::connect(QTHREADPTR(rioThread), &QThread::started,
+                RIOPTR(rio), &dfti::RIO::threadStart);
+        }
     }
     if (settings.useUADC()) {
         logger->enableUADC(UADCPTR(uadc));
-        server->enableUADC(UADCPTR(uadc));
-        QObject::connect(QTHREADPTR(uadcThread), &QThread::started,
-            UADCPTR(uadc), &dfti::uADC::threadStart);
+        if (settings.serverEnabled()) {
+            server->enableUADC(UADCPTR(uadc));
+        }
+        if (useReactor) {
+            reactor->addSensor(UADCPTR(uadc));
+        } else {
+            QObject::connect(QTHREADPTR(uadcThread), &QThread::started,
+                UADCPTR(uadc), &dfti::uADC::threadStart);
+        }
     }
     if (settings.useVN200()) {
         logger->enableVN200(VN200PTR(vn200));
-        server->enableVN200(VN200PTR(vn200));
-        QObject::connect(QTHREADPTR(vn200Thread), &QThread::started,
-            VN200PTR(vn200), &dfti::VN200::threadStart);
+        if (settings.serverEnabled()) {
+            server->enableVN200(VN200PTR(vn200));
+        }
+        if (useReactor) {
+            reactor->addSensor(VN200PTR(vn200));
+        } else {
+            QObject::connect(QTHREADPTR(vn200Thread), &QThread::started,
+                VN200PTR(vn200), &dfti::VN200::threadStart);
+        }
+    }
+    if (useReactor) {
+        QObject::connect(QTHREADPTR(reactorThread), &QThread::started,
+            REACTORPTR(reactor), &dfti::Reactor::threadStart);
     }
     QObject::connect(QTHREADPTR(loggingThread), &QThread::started,
         LOGPTR(logger), &dfti::Logger::start);
-    QObject::connect(QTHREADPTR(serverThread), &QThread::started,
-        SRVPTR(server), &dfti::Server::start);
+    if (settings.serverEnabled()) {
+        QObject::connect(QTHREADPTR(serverThread), &QThread::started,
+            SRVPTR(server), &dfti::Server::start);
+    }
 
     // Start the threads.
-    if (settings.useMavlink()) {
-        pixhawkThread->start();
-    }
-    if (settings.useRIO()) {
-        rioThread->start();
-    }
-    if (settings.useUADC()) {
-        uadcThread->start();
-    }
-    if (settings.useVN200()) {
-        vn200Thread->start();
+    if (useReactor) {
+        reactorThread->start();
+    } else {
+        if (settings.useMavlink()) {
+            pixhawkThread->start();
+        }
+        if (settings.useRIO()) {
+            rioThread->start();
+        }
+        if (settings.useUADC()) {
+            uadcThread->start();
+        }
+        if (settings.useVN200()) {
+            vn200Thread->start();
+        }
     }
     loggingThread->start();
     if (settings.serverEnabled()) {
@@ -20,20 +20,28 @@
 #define QSERIALPORTPTR(P) static_cast<QSerialPort *>(P)
 #define QTHREADPTR(P) static_cast<QThread *>(P)
 #define QTIMERPTR(P) static_cast<QTimer *>(P)
+#define QUDPSOCKETPTR(P) static_cast<QUdpSocket *>(P)
 #define APPTR(P) static_cast<dfti::Autopilot *>(P)
 #define LOGPTR(P) static_cast<dfti::Logger *>(P)
+#define REACTORPTR(P) static_cast<dfti::Reactor *>(P)
 #define RIOPTR(P) static_cast<dfti::RIO *>(P)
+#define SCHEDPTR(P) static_cast<dfti::Scheduler *>(P)
 #define SRVPTR(P) static_cast<dfti::Server *>(P)
 #define UADCPTR(P) static_cast<dfti::uADC *>(P)
 #define VN200PTR(P) static_cast<dfti::VN200 *>(P)
+#define WAKEUPPTR(P) static_cast<dfti::Wakeup *>(P)
 #else
 #define QSERIALPORTPTR(P) P
 #define QTHREADPTR(P) P
 #define QTIMERPTR(P) P
+#define QUDPSOCKETPTR(P) P
 #define APPTR(P) P
 #define LOGPTR(P) P
+#define REACTORPTR(P) P
 #define RIOPTR(P) P
+#define SCHEDPTR(P) P
 #define SRVPTR(P) P
 #define UADCPTR(P) P
 #define VN200PTR(P) P
+#define WAKEUPPTR(P) P
 #endif
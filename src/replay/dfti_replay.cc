@@ -0,0 +1,318 @@
+/*!
+ *  \file dfti_replay.cc
+ *  \brief DFTI raw capture replay program.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+
+
+// stdlib
+#include <chrono>
+#include <cstdio>
+#include <thread>
+// 3rd party
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+// project
+#include "autopilot/autopilot.hh"
+#include "core/consts.hh"
+#include "core/logger.hh"
+#include "rio/rio.hh"
+#include "sensor/capture.hh"
+#include "settings/settings.hh"
+#include "uadc/uadc.hh"
+#include "util/clocksync.hh"
+#include "util/util.hh"
+#include "vn200/vn200.hh"
+
+
+//! App info.
+const QString app_name{"dftireplay"};
+
+
+//! Number of sensor identifiers (including the unused 0).
+const quint8 numSensors = 5;
+
+
+//! Recorded receive time of the data being replayed, Unix microseconds.
+static quint64 replayTimeUsec = 0;
+
+
+//! Clock used in place of the system clock during replay.
+static quint64
+replayClock(void)
+{
+    return replayTimeUsec;
+}
+
+
+//! Host to GPS clock correlation, fed by the replayed VN-200.
+static dfti::ClockSync clockSync;
+
+
+//! Per-sensor replay state.
+struct SensorReplay
+{
+    //! Sensor driver, or nullptr if the capture has no data for it.
+    dfti::SerialSensor *sensor{nullptr};
+    //! Display name.
+    const char *name{""};
+    //! Raw bytes replayed.
+    quint64 bytes{0};
+    //! Time spent in the parser, nanoseconds.
+    qint64 parseNs{0};
+};
+
+
+//! Create the driver for a captured sensor and hook it up to the logger.
+/*!
+ *  \param id Sensor identifier from the capture.
+ *  \param settings Settings object.
+ *  \param logger Logger, or nullptr if logs are not written.
+ *  \param replay Replay state to fill in.
+ *  \return False if the sensor identifier is unknown.
+ */
+static bool
+createSensor(dfti::CaptureSensor id, dfti::Settings *settings,
+    dfti::Logger *logger, SensorReplay &replay)
+{
+    switch (id) {
+        case dfti::CaptureSensor::AUTOPILOT: {
+            dfti::Autopilot *ap = new dfti::Autopilot(settings);
+            if (logger) {
+                logger->enableAutopilot(ap);
+            }
+            replay.sensor = ap;
+            replay.name = "ap";
+            return true;
+        }
+        case dfti::CaptureSensor::RIO: {
+            dfti::RIO *rio = new dfti::RIO(settings);
+            if (logger) {
+                logger->enableRIO(rio);
+            }
+            replay.sensor = rio;
+            replay.name = "rio";
+            return true;
+        }
+        case dfti::CaptureSensor::UADC: {
+            dfti::uADC *adc = new dfti::uADC(settings);
+            if (logger) {
+                logger->enableUADC(adc);
+            }
+            replay.sensor = adc;
+            replay.name = "uadc";
+            return true;
+        }
+        case dfti::CaptureSensor::VN200: {
+            dfti::VN200 *ins = new dfti::VN200(settings);
+            ins->setClockSync(&clockSync);
+            if (logger) {
+                logger->enableVN200(ins);
+            }
+            replay.sensor = ins;
+            replay.name = "vn200";
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Main replay application function.
+/*!
+ *  Reads a raw capture written with capture_raw enabled and pushes every
+ *  chunk through the same processBytes() parsers the live system uses,
+ *  stamped with its recorded receive time, and with getTimeUsec() returning
+ *  the recorded time. The Logger is ticked at log_rate_hz in recorded time,
+ *  so the logs match what the live system would have written. Runs as fast
+ *  as possible unless --paced is given, and prints per-parser throughput at
+ *  the end.
+ *  \param argc Number of command line arguments.
+ *  \param argv Array of command line arguments.
+ */
+int
+main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(app_name);
+    QCoreApplication::setApplicationVersion(dfti::app_version);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "dftireplay -- replay DFTI raw captures through the sensor parsers");
+    // Positional Arguments
+    parser.addPositionalArgument("capture",
+        QCoreApplication::translate("main", "Raw capture file (.cap)."));
+    // Options
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption(QCommandLineOption({"c", "config"},
+        "Specify RC file.", "rc.ini"));
+    parser.addOption(QCommandLineOption({"o", "output"},
+        "Directory to write logs to (default: current directory).", "dir"));
+    parser.addOption(QCommandLineOption({"n", "no-log"},
+        "Only parse; don't write logs."));
+    parser.addOption(QCommandLineOption({"p", "paced"},
+        "Replay at the recorded timing instead of as fast as possible."));
+    parser.addOption(QCommandLineOption({"d", "debug-data"},
+        "Display sensor data for debugging."));
+    parser.addOption(QCommandLineOption({"r", "debug-rc"},
+        "Display settings for debugging."));
+    parser.addOption(QCommandLineOption({"s", "debug-serial"},
+        "Display serial i/o for debugging."));
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        qWarning() << "Must provide a capture file.";
+        exit(-1);
+    }
+
+    // Settings
+    dfti::DebugMode debug = dfti::DebugMode::DEBUG_NONE;
+    debug |= parser.isSet("debug-data") ?
+        dfti::DebugMode::DEBUG_DATA : dfti::DebugMode::DEBUG_NONE;
+    debug |= parser.isSet("debug-rc") ?
+        dfti::DebugMode::DEBUG_RC : dfti::DebugMode::DEBUG_NONE;
+    debug |= parser.isSet("debug-serial") ?
+        dfti::DebugMode::DEBUG_SERIAL : dfti::DebugMode::DEBUG_NONE;
+    dfti::Settings settings(parser.value("config"), debug);
+    if (settings.setSystemTime()) {
+        qWarning() << "set_system_time must be false for replay.";
+        exit(-1);
+    }
+
+    dfti::CaptureReader reader;
+    if (!reader.open(args.first())) {
+        qWarning() << "Failed to read capture file" << args.first();
+        exit(-1);
+    }
+
+    if (parser.isSet("output") && !QDir::setCurrent(parser.value("output"))) {
+        qWarning() << "Failed to change to directory" << parser.value("output");
+        exit(-1);
+    }
+    dfti::Logger *logger = parser.isSet("no-log") ? nullptr :
+        new dfti::Logger(&settings);
+    if (logger) {
+        logger->setClockSync(&clockSync);
+    }
+    const bool paced = parser.isSet("paced");
+
+    // Everything that asks for the time now gets the recorded time.
+    dfti::setTimeSource(replayClock);
+
+    SensorReplay sensors[numSensors];
+    const quint64 tickUsec = settings.logPeriodUsec();
+    const quint64 flushUsec = 1000ull * settings.flushRateMs();
+    quint64 nextTick = 0;
+    quint64 nextFlush = 0;
+    quint64 firstNs = 0;
+    quint64 lastNs = 0;
+    quint64 frames = 0;
+    auto wallStart = std::chrono::steady_clock::now();
+    QElapsedTimer wall;
+    QElapsedTimer timer;
+    wall.start();
+
+    dfti::CaptureFrame frame;
+    while (reader.next(frame)) {
+        const quint64 now = reader.toUnixUsec(frame.timeNs);
+        if (!frames++) {
+            firstNs = frame.timeNs;
+            nextTick = now + tickUsec;
+            nextFlush = now + flushUsec;
+        }
+        lastNs = frame.timeNs;
+
+        // Run the log ticks that would have happened before these bytes
+        // arrived.
+        if (logger) {
+            while (nextTick <= now) {
+                replayTimeUsec = nextTick;
+                logger->writeData();
+                nextTick += tickUsec;
+            }
+            if (nextFlush <= now) {
+                logger->flush();
+                nextFlush += flushUsec;
+            }
+        }
+
+        if (paced) {
+            std::this_thread::sleep_until(wallStart +
+                std::chrono::nanoseconds(frame.timeNs - firstNs));
+        }
+
+        const quint8 id = static_cast<quint8>(frame.sensor);
+        if ((id >= numSensors) || (!sensors[id].sensor &&
+            !createSensor(frame.sensor, &settings, logger, sensors[id]))) {
+            qWarning() << "[WARN ]  skipping frame from unknown sensor" << id;
+            continue;
+        }
+        replayTimeUsec = now;
+        timer.start();
+        sensors[id].sensor->processBytes(frame.bytes, frame.len,
+            frame.timeNs);
+        sensors[id].parseNs += timer.nsecsElapsed();
+        sensors[id].bytes += frame.len;
+    }
+    if (reader.position() != reader.size()) {
+        qWarning() << "[WARN ]  capture truncated at byte" << reader.position();
+    }
+    if (logger) {
+        logger->writeData();
+        logger->flush();
+    }
+    const qint64 wallNs = wall.nsecsElapsed();
+
+    printf("%8s %12s %10s %10s %8s %10s %10s %12s %10s\n", "sensor",
+        "bytes", "packets", "failures", "lost", "seq_resync", "parse_s",
+        "packets/s", "MB/s");
+    for (auto &replay : sensors) {
+        if (!replay.sensor) {
+            continue;
+        }
+        const dfti::RxStats stats = replay.sensor->rxStats();
+        const double parseSec = 1e-9 * replay.parseNs;
+        printf("%8s %12llu %10llu %10llu %8llu %10llu %10.3f %12.0f %10.2f\n",
+            replay.name, static_cast<unsigned long long>(replay.bytes),
+            static_cast<unsigned long long>(stats.packetsParsed),
+            static_cast<unsigned long long>(stats.checksumFailures),
+            static_cast<unsigned long long>(stats.packetsLost),
+            static_cast<unsigned long long>(stats.sequenceResyncs),
+            parseSec, parseSec > 0 ? stats.packetsParsed / parseSec : 0.0,
+            parseSec > 0 ? 1e-6 * replay.bytes / parseSec : 0.0);
+    }
+    printf("replayed %llu frames, %.3f s recorded in %.3f s\n",
+        static_cast<unsigned long long>(frames), 1e-9 * (lastNs - firstNs),
+        1e-9 * wallNs);
+    if (clockSync.locked()) {
+        const dfti::ClockSyncStats sync = clockSync.stats();
+        printf("gps clock: drift %.1f ppb, rms %.1f us over %u s, "
+            "%llu outliers, %u resets\n", sync.driftPpb, 1e-3 * sync.rmsNs,
+            sync.points, static_cast<unsigned long long>(sync.rejected),
+            sync.resets);
+    }
+
+    for (auto &replay : sensors) {
+        delete replay.sensor;
+    }
+    delete logger;
+    dfti::setTimeSource(nullptr);
+    return 0;
+}
@@ -23,6 +23,7 @@ namespace dfti {
 RIO::RIO(Settings *_settings, QObject* _parent) :
 SerialSensor(_settings, _parent)
 {
+    protocol = settings->rioProtocol();
     if (settings->rioBaudRate()) {
         setBaudRate(settings->rioBaudRate());
         if (settings->debugSerial()) {
@@ -35,64 +36,101 @@ SerialSensor(_settings, _parent)
 // ----------------------------------------------------------------------------
 //  Public functions
 // ----------------------------------------------------------------------------
+void
+RIO::parseBytes(const char *bytes, qint64 len)
+{
+    // Parsing empties the framer down to one partial packet, so feeding it
+    // in pieces of at most its capacity never drops bytes.
+    while (len > 0) {
+        quint32 n = 0;
+        if (protocol == RIOProtocol::BINARY) {
+            n = binaryFramer.write(bytes, len);
+            parseBinaryPackets();
+        } else {
+            n = lineFramer.write(bytes, len);
+            parsePackets();
+        }
+        bytes += n;
+        len -= n;
+    }
+}
 
 // ----------------------------------------------------------------------------
-// Public Slots
+//  Private functions
 // ----------------------------------------------------------------------------
 void
-RIO::readData(void)
+RIO::parsePackets(void)
 {
-    // Add available bytes to the buffer up to the first newline.
-    _buf.append(_port->readLine());
-    // If there is a newline in the buffer, then we should have a full packet
-    // from the μC, which we extract from the buffer and then parse.
-    if (_buf.contains(rioTerm)) {
-        quint8 termIdx = _buf.lastIndexOf(rioTerm) + 1;
-        // Extract one packet.
-        QByteArray pkt = _buf.left(termIdx);
-        // Remove terminator.
-        pkt.replace(rioTermStr, 0);
-        // Print buffer, packet, and RIO if we are debugging.
+    // Every newline in the buffer ends a packet from the μC.
+    const quint64 failures = stats.checksumFailures;
+    FrameView frame;
+    while (lineFramer.next(frame)) {
+        // Print packet if we are debugging.
         if (settings->debugSerial()) {
-            qDebug() << "buffer:" << _buf;
-            qDebug() << "packet:" << pkt;
+            qDebug() << "packet:" << QByteArray(frame.data, frame.len);
         }
-        // We remove everything up to the terminating character, which should
-        // make sure after the first time we get the terminator every packet
-        // after is valid.
-        _buf.remove(0, termIdx);
-        // Calculate checksum.
-        if (validateRIOChecksum(pkt)) {
-            // Split packet, removing start indicator.
-            auto pktItems = pkt.replace(rioStart, 0).split(rioSep);
-            // Remove checksum.
-            pktItems.removeLast();
-            // Get RIO values.
-            quint8 count = 0;
-            for (auto value : pktItems) {
-                if (count < data.values.size()) {
-                    data.values.at(count++) = value.toFloat();
-                } else {
-                    data.values.push_back(value.toFloat());
-                    ++count;
+        decodeRIOFields(frame.data,
+            rioStripTerminator(frame.data, frame.len), data);
+        publishPacket();
+    }
+    if (settings->debugData() && (stats.checksumFailures != failures)) {
+        qDebug() << "[INFO ]  RIO packets failed validation:"
+                 << stats.checksumFailures - failures;
+    }
+}
+
+
+void
+RIO::parseBinaryPackets(void)
+{
+    const quint64 failures = stats.checksumFailures;
+    FrameView frame;
+    while (binaryFramer.next(frame)) {
+        decodeRIOBinaryFields(frame.data, data);
+        // Count the frames missing from the sequence. A repeated frame
+        // wraps the gap to 0xffff, and a restarted RIO jumps anywhere.
+        if (haveSequence) {
+            const quint16 gap = data.sequence - lastSequence - 1;
+            if (gap > rioMaxSequenceGap) {
+                ++stats.sequenceResyncs;
+                if (settings->debugSerial()) {
+                    qDebug() << "RIO: sequence jumped from" << lastSequence
+                             << "to" << data.sequence;
                 }
-            }
-            // Emit the signal.
-            emit measurementUpdate(data);
-            // If we are in the verbose debugging mode, print the parsed data.
-            if (settings->debugData()) {
-                count = 1;
-                for (auto value : data.values) {
-                    qDebug() << "Value" << count++ << ":" << value;
+            } else {
+                stats.packetsLost += gap;
+                if (gap && settings->debugSerial()) {
+                    qDebug() << "RIO: lost" << gap << "frames before"
+                             << data.sequence;
                 }
             }
-        } else {
-            if (settings->debugData()) {
-                qDebug() << "[INFO ]  RIO packet failed validation";
-            }
+        }
+        lastSequence = data.sequence;
+        haveSequence = true;
+        publishPacket();
+    }
+    if (settings->debugData() && (stats.checksumFailures != failures)) {
+        qDebug() << "[INFO ]  RIO frames failed validation:"
+                 << stats.checksumFailures - failures;
+    }
+}
+
+
+void
+RIO::publishPacket(void)
+{
+    // Stamp, hand the measurement to the consumer queues and emit the
+    // signal.
+    data.timeUsec = rxTimeUsec;
+    data.rxTimeNs = rxTimeNs;
+    publish(data);
+    emit measurementUpdate(data);
+    // If we are in the verbose debugging mode, print the parsed data.
+    if (settings->debugData()) {
+        for (quint8 i = 0; i < data.numValues; ++i) {
+            qDebug() << "Value" << i + 1 << ":" << data.values[i];
         }
     }
-    return;
 }
 
 
@@ -100,19 +138,109 @@ RIO::readData(void)
 //  Functions
 // ----------------------------------------------------------------------------
 bool
-validateRIOChecksum(QByteArray pkt)
+RIOLineFormat::check(const char *frame, quint32 len)
+{
+    return validateRIOChecksum(frame, rioStripTerminator(frame, len));
+}
+
+
+bool
+validateRIOChecksum(const char *pkt, size_t len)
 {
     bool ok;
     quint8 cksum = 0;
+    if (len < ONE_BYTE) {
+        return false;
+    }
     // Extract checksum byte.
-    QByteArray _cksumBytes = pkt.right(ONE_BYTE);
-    quint8 cksumByte = static_cast<quint8>(_cksumBytes.toInt(&ok, 16));
+    quint8 cksumByte = static_cast<quint8>(
+        hexToInt(pkt + len - ONE_BYTE, ONE_BYTE, &ok));
     // Calculate checksum.
-    for (quint8 i = 0; i < pkt.length() - ONE_BYTE; ++i) {
-        cksum ^= static_cast<quint8>(pkt.at(i));
+    for (size_t i = 0; i < len - ONE_BYTE; ++i) {
+        cksum ^= static_cast<quint8>(pkt[i]);
     }
     return ok ? (cksum == cksumByte ? true : false) : false;
 }
 
 
+bool
+validateRIOChecksum(QByteArray pkt)
+{
+    return validateRIOChecksum(pkt.constData(), pkt.size());
+}
+
+
+bool
+decodeRIOPacket(const char *pkt, size_t len, RIOData &data)
+{
+    // Remove terminator.
+    len = rioStripTerminator(pkt, len);
+    // Calculate checksum.
+    if (!validateRIOChecksum(pkt, len)) {
+        return false;
+    }
+    decodeRIOFields(pkt, len, data);
+    return true;
+}
+
+
+void
+decodeRIOFields(const char *pkt, size_t len, RIOData &data)
+{
+    // Step over the start indicator; the values run up to the separator in
+    // front of the checksum.
+    const char *end = pkt + len - ONE_BYTE;
+    const char *field = pkt;
+    const size_t startLen = sizeof(rioStart) - 1;
+    if (len >= ONE_BYTE + startLen && !memcmp(pkt, rioStart, startLen)) {
+        field += startLen;
+    }
+    quint8 count = 0;
+    for (const char *p = field; p < end; ++p) {
+        if (*p == rioSep) {
+            if (count < rioMaxValues) {
+                data.values[count++] = decimalToFloat(field, p - field);
+            }
+            field = p + 1;
+        }
+    }
+    data.numValues = count;
+}
+
+
+bool
+decodeRIOBinaryPacket(const char *pkt, size_t len, RIOData &data)
+{
+    if (len < rioBinFrameLen(0) || memcmp(pkt, rioSync, 2)) {
+        return false;
+    }
+    const quint8 channels = static_cast<quint8>(pkt[2]);
+    if (channels > rioBinMaxChannels || len != rioBinFrameLen(channels)) {
+        return false;
+    }
+    // The CRC covers everything after the sync bytes and is sent big-endian,
+    // so the CRC of a good frame including it is zero.
+    if (crc16CCITT(pkt + 2, len - 2)) {
+        return false;
+    }
+    decodeRIOBinaryFields(pkt, data);
+    return true;
+}
+
+
+void
+decodeRIOBinaryFields(const char *pkt, RIOData &data)
+{
+    const quint8 channels = static_cast<quint8>(pkt[2]);
+    const uchar *p = reinterpret_cast<const uchar *>(pkt) + 3;
+    data.sequence = qFromLittleEndian<quint16>(p);
+    data.deviceTimeUsec = qFromLittleEndian<quint32>(p + 2);
+    p += 6;
+    for (quint8 i = 0; i <= channels; ++i) {
+        data.values[i] = qFromLittleEndian<quint16>(p + 2 * i);
+    }
+    data.numValues = channels + 1;
+}
+
+
 };  // namespace dfti
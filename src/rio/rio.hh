@@ -15,14 +15,20 @@
 
 
 // stdlib
-#include <vector>
+#include <cstring>
 // 3rd party
 #include <QByteArray>
 #include <QDebug>
 #include <QObject>
+#include <QtEndian>
 // dfti
 #include "sensor/serialsensor.hh"
+#include "core/consts.hh"
 #include "settings/settings.hh"
+#include "util/crc.hh"
+#include "util/decimal.hh"
+#include "util/spscqueue.hh"
+#include "util/util.hh"
 
 
 //! Byte length for hex characters (1 byte is two hex chars, e.g. 0xFF).
@@ -37,9 +43,53 @@ const char rioSep = '$';
 //! RIO packet terminator.
 const char rioTerm = '\n';
 //! RIO packet start.
-const QString rioStart{"$$$"};
-//! RIO packet terminator string.
-const QString rioTermStr{"\r\n"};
+const char rioStart[] = "$$$";
+//! Longest RIO packet, including the terminator.
+const int rioMaxPktLen = 256;
+//! Most values a RIO packet can carry.
+const quint8 rioMaxValues = 16;
+//! RIO binary frame sync bytes.
+const char rioSync[] = "\xa5\x5a";
+//! RIO binary frame header length: sync, channel count, sequence, time.
+const quint8 rioBinHeaderLen = 9;
+//! Most ADC channels in a RIO binary frame; the RPM takes the last value.
+const quint8 rioBinMaxChannels = rioMaxValues - 1;
+//! Longest RIO binary frame.
+const quint32 rioBinMaxFrameLen = rioBinHeaderLen + 2 * rioBinMaxChannels + 4;
+//! Longest sequence gap counted as lost RIO binary frames, about 3 s.
+/*!
+ *  Larger jumps, and a repeated sequence number, come from a RIO reset or
+ *  reconnect or a duplicated frame rather than from frames lost in transit.
+ */
+const quint16 rioMaxSequenceGap = 1000;
+
+
+//! Length of a RIO binary frame.
+/*!
+ *  \param channels Number of ADC channels in the frame.
+ *  \return Frame length in bytes, including the RPM and the CRC.
+ */
+inline quint32
+rioBinFrameLen(quint8 channels)
+{
+    return rioBinHeaderLen + 2 * channels + 2 + 2;
+}
+
+
+//! Length of a RIO packet without its line terminator.
+/*!
+ *  \param pkt A full packet.
+ *  \param len Packet length, with or without the terminator.
+ *  \return Packet length without the terminator.
+ */
+inline size_t
+rioStripTerminator(const char *pkt, size_t len)
+{
+    while (len && (pkt[len - 1] == '\n' || pkt[len - 1] == '\r')) {
+        --len;
+    }
+    return len;
+}
 
 
 //! Validate the RIO packet checksum.
@@ -47,29 +97,151 @@ const QString rioTermStr{"\r\n"};
  *  The checksum is a simple byte-wise XOR up to but not including the
  *  checksum byte itself.
  *
+ *  \param pkt A full packet to validate, without the terminator.
+ *  \param len Packet length.
+ *  \return True if the packet checksum is correct.
+*/
+bool validateRIOChecksum(const char *pkt, size_t len);
+
+
+//! Validate the RIO packet checksum.
+/*!
  *  \param pkt A full packet to validate.
  *  \return True if the packet checksum is correct.
 */
 bool validateRIOChecksum(QByteArray pkt);
 
 
+//! RIO ASCII packet format, for DelimitedFraming.
+struct RIOLineFormat
+{
+    //! Longer lines are dropped.
+    static const quint32 maxFrameLen = rioMaxPktLen;
+    //! Line terminator.
+    static char terminator(void) { return rioTerm; }
+    //! Check the checksum of a line, including its terminator.
+    static bool check(const char *frame, quint32 len);
+};
+
+
+//! RIO binary frame format, for SyncFraming.
+struct RIOBinaryFormat
+{
+    //! Sync bytes and channel count.
+    static const quint32 headerLen = 3;
+    //! Frame with the most channels.
+    static const quint32 maxFrameLen = rioBinMaxFrameLen;
+    //! First sync byte.
+    static char syncByte(void) { return rioSync[0]; }
+    //! Frame length from the channel count, if the header is valid.
+    static quint32 frameLen(const char *header)
+    {
+        const quint8 channels = static_cast<quint8>(header[2]);
+        return (header[1] != rioSync[1]) || (channels > rioBinMaxChannels) ?
+            0 : rioBinFrameLen(channels);
+    }
+    //! Check the CRC.
+    static bool check(const char *frame, quint32 len)
+    {
+        return !crc16CCITT(frame + 2, len - 2);
+    }
+};
+
+
 //! Structure to hold control effector data.
+/*!
+ *  The values are stored inline, so copying a measurement into a queue or
+ *  a signal never allocates.
+ */
 struct RIOData
 {
-    //! Vector of RIO values.
-    std::vector<float> values;
+    //! RIO values; only the first numValues are in use.
+    float values[rioMaxValues] = {0};
+    //! Number of RIO values in the last packet.
+    quint8 numValues{0};
+    //! Frame sequence counter (binary protocol only).
+    quint16 sequence{0};
+    //! RIO clock at the start of the scan, us, wrapping (binary only).
+    quint32 deviceTimeUsec{0};
+    //! Host receive time, microseconds since the Unix epoch.
+    quint64 timeUsec{0};
+    //! Host monotonic receive time, nanoseconds (see getMonotonicNsec).
+    quint64 rxTimeNs{0};
 };
 
 
+//! Validate and decode a RIO packet.
+/*!
+ *  Tokenizes the packet in a single pass, decoding each value in place (to
+ *  the value QByteArray::toFloat gives) straight into the data structure,
+ *  without allocating. Values beyond rioMaxValues are ignored.
+ *
+ *  \param pkt A full packet, with or without the terminator.
+ *  \param len Packet length.
+ *  \param data Structure to decode into; only written if the packet is
+ *      valid, and the receive time is left alone.
+ *  \return True if the packet checksum is correct.
+ */
+bool decodeRIOPacket(const char *pkt, size_t len, RIOData &data);
+
+
+//! Decode a RIO packet that has already been validated.
+/*!
+ *  \param pkt A full packet with a correct checksum, without the
+ *      terminator.
+ *  \param len Packet length.
+ *  \param data Structure to decode into; the receive time is left alone.
+ */
+void decodeRIOFields(const char *pkt, size_t len, RIOData &data);
+
+
+//! Validate and decode a RIO binary frame.
+/*!
+ *  The raw ADC counts become the first values and the RPM the last, the
+ *  same order as the ASCII protocol.
+ *
+ *  \param pkt A full frame, starting at the sync bytes.
+ *  \param len Frame length.
+ *  \param data Structure to decode into; only written if the frame is
+ *      valid, and the receive time is left alone.
+ *  \return True if the frame length and CRC are correct.
+ */
+bool decodeRIOBinaryPacket(const char *pkt, size_t len, RIOData &data);
+
+
+//! Decode a RIO binary frame that has already been validated.
+/*!
+ *  \param pkt A full frame with a correct length and CRC.
+ *  \param data Structure to decode into; the receive time is left alone.
+ */
+void decodeRIOBinaryFields(const char *pkt, RIOData &data);
+
+
 //! Serial driver to acquire data from a generic Remote I/O device.
 /*!
  *  Reads in data from a generic RIO over a serial port and parses the data.
  *
- *  The data packet format is
+ *  The ASCII packet format is
  *      <tt>$$$field_1$field_2$...$field_n$checksum\\r\\n</tt>
  *  with the checksum byte being represented in hex.
+ *
+ *  With <tt>protocol = binary</tt> the RIO sends little-endian frames of
+ *
+ *  - the sync bytes 0xa5 0x5a
+ *  - the number of ADC channels n (quint8)
+ *  - a sequence counter (quint16), incremented every frame
+ *  - the RIO clock when the scan started, microseconds (quint32)
+ *  - n raw 10-bit ADC counts (quint16 each)
+ *  - the engine RPM (quint16)
+ *  - a CRC-16-CCITT of everything after the sync bytes, big-endian, as the
+ *    VN-200 uses
+ *
+ *  which is 23 bytes for five channels, so several hundred frames a second
+ *  fit in 115200 baud. Gaps in the sequence counter are counted as lost
+ *  packets, and a counter that repeats or jumps, as after a RIO reset, as a
+ *  resync.
  */
-class RIO : public SerialSensor
+class RIO : public SerialSensor, public MeasurementPublisher<RIOData>
 {
     Q_OBJECT;
 
@@ -81,23 +253,51 @@ public:
      */
     explicit RIO(Settings *_settings, QObject* _parent = nullptr);
 
-public slots:
-    //! Slot to read in data over serial and parse complete packets.
-    void readData(void);
-
 signals:
     //! Emitted to share new RIOData.
     void measurementUpdate(RIOData data);
 
+protected:
+    //! Parse a chunk of raw bytes from the RIO.
+    /*!
+     *  \param bytes Raw bytes.
+     *  \param len Number of bytes.
+     */
+    void parseBytes(const char *bytes, qint64 len);
+
 private:
-    //! Buffer
+    //! ASCII packet framer
     /*!
-     *  Buffer to hold the raw bytes we read in from the serial port. Since we
-     *  do not necessarily read in complete packets at a time, we need to let
-     *  the buffer fill up until we have a complete packet and then parse it,
-     *  which is the purpose of this buffer.
+     *  Buffers the raw bytes we read in from the serial port until complete
+     *  packets can be parsed out of them.
      */
-    QByteArray _buf;
+    Framer<DelimitedFraming<RIOLineFormat>, 1024> lineFramer{stats};
+
+    //! Binary frame framer.
+    Framer<SyncFraming<RIOBinaryFormat>, 1024> binaryFramer{stats};
+
+    //! Publish every complete, valid line in the framer.
+    void parsePackets(void);
+
+    //! Publish every complete, valid binary frame in the framer.
+    /*!
+     *  Gaps in the sequence counter of up to rioMaxSequenceGap frames are
+     *  counted as lost packets; anything else is counted as a sequence
+     *  resync.
+     */
+    void parseBinaryPackets(void);
+
+    //! Publish a decoded packet.
+    void publishPacket(void);
+
+    //! Serial protocol.
+    RIOProtocol protocol{RIOProtocol::ASCII};
+
+    //! Flag to indicate a binary frame has been received.
+    bool haveSequence{false};
+
+    //! Sequence counter of the last binary frame.
+    quint16 lastSequence{0};
 
     //! Data structure.
     RIOData data;
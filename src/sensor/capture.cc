@@ -0,0 +1,175 @@
+/*!
+ *  \file capture.cc
+ *  \brief Raw serial stream capture implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "capture.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+CaptureFile::CaptureFile(const QString &fileName)
+{
+    file.setFileName(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Unbuffered)) {
+        qWarning() << "Failed to open capture file" << file.fileName();
+        exit(-1);
+    }
+    uchar header[captureHeaderSize];
+    memcpy(header, captureMagic, 4);
+    qToLittleEndian<quint16>(captureVersion, header + 4);
+    qToLittleEndian<quint64>(getTimeUsec(), header + 6);
+    qToLittleEndian<quint64>(getMonotonicNsec(), header + 14);
+    const qint64 len = sizeof(header);
+    if (file.write(reinterpret_cast<const char *>(header), len) != len) {
+        qWarning() << "Failed to write capture header" << file.fileName();
+        exit(-1);
+    }
+}
+
+
+CaptureBuffer::CaptureBuffer(CaptureFile *_file, CaptureSensor _sensor)
+: file(_file), sensor(_sensor)
+{
+    staging.reserve(captureStagingSize);
+}
+
+
+CaptureBuffer::~CaptureBuffer()
+{
+    flush();
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+void
+CaptureFile::write(const QByteArray &block)
+{
+    QMutexLocker lock(&mutex);
+    if (file.write(block) != block.size()) {
+        qWarning() << "[WARN ]  short write to capture file"
+                   << file.fileName();
+    }
+}
+
+
+void
+CaptureFile::flush(void)
+{
+    QMutexLocker lock(&mutex);
+    file.flush();
+}
+
+
+void
+CaptureBuffer::append(quint64 timeNs, const char *bytes, qint64 len)
+{
+    while (len > 0) {
+        const quint16 n = static_cast<quint16>(qMin<qint64>(len, 0xffff));
+        if (staging.size() + captureFrameHeaderSize + n >
+            static_cast<int>(captureStagingSize)) {
+            flush();
+        }
+        if (staging.isEmpty()) {
+            oldestNs = timeNs;
+        }
+        uchar header[captureFrameHeaderSize];
+        header[0] = static_cast<uchar>(sensor);
+        header[1] = 0;
+        qToLittleEndian<quint16>(n, header + 2);
+        qToLittleEndian<quint64>(timeNs, header + 4);
+        staging.append(reinterpret_cast<const char *>(header),
+            captureFrameHeaderSize);
+        staging.append(bytes, n);
+        bytes += n;
+        len -= n;
+    }
+    // Slow sensors would otherwise sit on their bytes for a long time.
+    if (timeNs - oldestNs > captureMaxAgeNs) {
+        flush();
+    }
+}
+
+
+void
+CaptureBuffer::flush(void)
+{
+    if (file && !staging.isEmpty()) {
+        file->write(staging);
+        // Keeps the reserved capacity.
+        staging.resize(0);
+    }
+}
+
+
+bool
+CaptureReader::open(const QString &fileName)
+{
+    file.setFileName(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    len = file.size();
+    data = len ? file.map(0, len) : nullptr;
+    if (!data || (len < captureHeaderSize) ||
+        memcmp(data, captureMagic, 4)) {
+        return false;
+    }
+    if (qFromLittleEndian<quint16>(data + 4) != captureVersion) {
+        qWarning() << "[WARN ]  unsupported capture version"
+                   << qFromLittleEndian<quint16>(data + 4);
+        return false;
+    }
+    startUnixUsec = qFromLittleEndian<quint64>(data + 6);
+    startMonoNsec = qFromLittleEndian<quint64>(data + 14);
+    pos = captureHeaderSize;
+    return true;
+}
+
+
+bool
+CaptureReader::next(CaptureFrame &frame)
+{
+    if (pos + captureFrameHeaderSize > len) {
+        return false;
+    }
+    const uchar *header = data + pos;
+    const quint16 n = qFromLittleEndian<quint16>(header + 2);
+    if (pos + captureFrameHeaderSize + n > len) {
+        return false;
+    }
+    frame.sensor = static_cast<CaptureSensor>(header[0]);
+    frame.timeNs = qFromLittleEndian<quint64>(header + 4);
+    frame.bytes = reinterpret_cast<const char *>(header) +
+        captureFrameHeaderSize;
+    frame.len = n;
+    pos += captureFrameHeaderSize + n;
+    return true;
+}
+
+
+quint64
+CaptureReader::toUnixUsec(quint64 timeNs) const
+{
+    // Frames can't predate the file, but be safe about it.
+    if (timeNs < startMonoNsec) {
+        return startUnixUsec - (startMonoNsec - timeNs) / 1000;
+    }
+    return startUnixUsec + (timeNs - startMonoNsec) / 1000;
+}
+
+
+};  // namespace dfti
@@ -0,0 +1,236 @@
+/*!
+ *  \file capture.hh
+ *  \brief Raw serial stream capture interface.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cstring>
+// 3rd party
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QtEndian>
+// dfti
+#include "util/util.hh"
+
+
+namespace dfti {
+
+
+//! Capture file magic bytes.
+const char captureMagic[] = "DCAP";
+
+//! Capture file format version.
+const quint16 captureVersion = 1;
+
+//! Size of the capture file header, in bytes.
+const quint8 captureHeaderSize = 22;
+
+//! Size of a capture frame header, in bytes.
+const quint8 captureFrameHeaderSize = 12;
+
+//! Bytes a sensor stages before handing them to the capture file.
+const quint32 captureStagingSize = 64 * 1024;
+
+//! Longest a sensor holds staged bytes before writing them, in ns.
+const quint64 captureMaxAgeNs = 1000000000ull;
+
+
+//! Sensor identifiers written to capture frames.
+/*!
+ *  \remark The values match BinlogSensor so the two file types can share
+ *      offline tooling.
+ */
+enum class CaptureSensor : quint8 {
+    AUTOPILOT = 1,  /// MAVLink-based autopilot
+    RIO       = 2,  /// Remote I/O unit
+    UADC      = 3,  /// Micro Air Data Computer
+    VN200     = 4   /// VN-200 INS
+};
+
+
+//! Raw serial capture ("black box") file.
+/*!
+ *  Holds every chunk of bytes read from every sensor's serial port, exactly
+ *  as received, so that the streams can be decoded again after the flight
+ *  with whatever the live decoders left out.
+ *
+ *  The file is laid out, little-endian, as a header
+ *
+ *  - the magic bytes "DCAP"
+ *  - the format version (quint16)
+ *  - the Unix time the file was opened, microseconds (quint64)
+ *  - the monotonic clock at the same instant, nanoseconds (quint64)
+ *
+ *  followed by frames of
+ *
+ *  - the sensor identifier (quint8, see CaptureSensor)
+ *  - reserved, zero (quint8)
+ *  - the payload length (quint16)
+ *  - the monotonic receive time, nanoseconds (quint64)
+ *  - the payload bytes
+ *
+ *  Frames from different sensors are interleaved in blocks; each sensor's
+ *  frames are in order. Sensors stage frames in a CaptureBuffer and hand
+ *  them over in large blocks, so the file only sees big sequential writes.
+ */
+class CaptureFile
+{
+public:
+    //! Constructor
+    /*!
+     *  Opens the file and writes the header. Exits on failure, like the
+     *  log files.
+     *
+     *  \param fileName Path of the capture file.
+     */
+    explicit CaptureFile(const QString &fileName);
+
+    //! Write a block of frames.
+    /*!
+     *  Thread safe; called from the sensor threads.
+     *
+     *  \param block Whole frames to append.
+     */
+    void write(const QByteArray &block);
+
+    //! Flush the file to disk.
+    void flush(void);
+
+private:
+    //! Capture file.
+    QFile file;
+
+    //! Serializes writes from the sensor threads.
+    QMutex mutex;
+};
+
+
+//! One frame read back from a capture file.
+struct CaptureFrame
+{
+    //! Sensor the bytes came from.
+    CaptureSensor sensor{CaptureSensor::VN200};
+    //! Monotonic receive time, nanoseconds.
+    quint64 timeNs{0};
+    //! Raw bytes; points into the mapped capture file.
+    const char *bytes{nullptr};
+    //! Number of bytes.
+    quint16 len{0};
+};
+
+
+//! Sequential reader for capture files.
+/*!
+ *  The file is memory mapped, so frames are handed out without copying.
+ */
+class CaptureReader
+{
+public:
+    //! Open a capture file and read its header.
+    /*!
+     *  \param fileName Path of the capture file.
+     *  \return False if the file can't be read or isn't a capture file.
+     */
+    bool open(const QString &fileName);
+
+    //! Read the next frame.
+    /*!
+     *  \param frame Set to the next frame.
+     *  \return False at the end of the file or on a truncated frame.
+     */
+    bool next(CaptureFrame &frame);
+
+    //! Convert a frame's monotonic time to Unix time.
+    /*!
+     *  \param timeNs Monotonic receive time, nanoseconds.
+     *  \return Unix time, microseconds.
+     */
+    quint64 toUnixUsec(quint64 timeNs) const;
+
+    //! Bytes read so far, including the header.
+    qint64 position(void) const { return pos; };
+
+    //! Size of the capture file.
+    qint64 size(void) const { return len; };
+
+private:
+    //! Capture file.
+    QFile file;
+
+    //! Mapped file contents.
+    const uchar *data{nullptr};
+
+    //! Mapped length.
+    qint64 len{0};
+
+    //! Read position.
+    qint64 pos{0};
+
+    //! Unix time the capture was opened, microseconds.
+    quint64 startUnixUsec{0};
+
+    //! Monotonic time the capture was opened, nanoseconds.
+    quint64 startMonoNsec{0};
+};
+
+
+//! Per-sensor staging buffer for a CaptureFile.
+/*!
+ *  Owned and used by a single sensor thread. Frames are appended to a
+ *  preallocated buffer that is written out once it is nearly full or its
+ *  oldest frame is more than captureMaxAgeNs old.
+ */
+class CaptureBuffer
+{
+public:
+    //! Constructor
+    /*!
+     *  \param _file Capture file to write to.
+     *  \param _sensor Sensor identifier for the frames.
+     */
+    CaptureBuffer(CaptureFile *_file, CaptureSensor _sensor);
+
+    //! Dtor; writes out anything staged.
+    ~CaptureBuffer();
+
+    //! Stage a chunk of raw bytes.
+    /*!
+     *  \param timeNs Monotonic receive time, nanoseconds.
+     *  \param bytes Raw bytes.
+     *  \param len Number of bytes, at most 65535.
+     */
+    void append(quint64 timeNs, const char *bytes, qint64 len);
+
+    //! Write out everything staged.
+    void flush(void);
+
+private:
+    //! Capture file.
+    CaptureFile *file{nullptr};
+
+    //! Sensor identifier.
+    CaptureSensor sensor;
+
+    //! Staged frames.
+    QByteArray staging;
+
+    //! Receive time of the oldest staged frame.
+    quint64 oldestNs{0};
+};
+
+
+};  // namespace dfti
@@ -0,0 +1,343 @@
+/*!
+ *  \file framer.hh
+ *  \brief Policy-based packet framing over a byte ring.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cstring>
+// 3rd party
+#include <QtGlobal>
+// dfti
+#include "util/bytering.hh"
+#include "util/crc.hh"
+
+
+namespace dfti {
+
+
+//! Receive path statistics for a packet-oriented sensor.
+struct RxStats
+{
+    //! Complete packets that passed validation.
+    quint64 packetsParsed{0};
+    //! Packets that failed checksum validation.
+    quint64 checksumFailures{0};
+    //! Bytes dropped while searching for a packet start.
+    quint64 bytesDiscarded{0};
+    //! Times framing was lost and the next packet start searched for.
+    quint64 resyncs{0};
+    //! Packets missing from the sensor's sequence counter, if it has one.
+    quint64 packetsLost{0};
+    //! Times the sequence counter repeated or jumped too far to be a gap.
+    quint64 sequenceResyncs{0};
+    //! Largest number of bytes buffered at once.
+    quint32 peakBuffered{0};
+};
+
+
+//! A frame in a Framer's buffer.
+struct FrameView
+{
+    //! First byte of the frame, contiguous for len bytes.
+    const char *data{nullptr};
+    //! Frame length in bytes.
+    quint32 len{0};
+};
+
+
+//! Result of scanning the front of a Framer's buffer.
+enum class FrameScan
+{
+    WAIT,   /// More bytes are needed
+    SKIP,   /// Bytes in front of the next frame must be dropped
+    FRAME   /// A complete frame, still to be validated
+};
+
+
+//! Framing of packets that start with sync bytes.
+/*!
+ *  The Format describes the packets:
+ *
+ *  - <tt>static const quint32 headerLen</tt>, bytes needed to tell the
+ *    frame length, including the sync bytes
+ *  - <tt>static const quint32 maxFrameLen</tt>, longest frame
+ *  - <tt>static char syncByte(void)</tt>, first byte of every frame
+ *  - <tt>static quint32 frameLen(const char *header)</tt>, frame length
+ *    given headerLen bytes starting at a sync byte, or 0 if they are not a
+ *    valid header; a constant for fixed length packets
+ *  - <tt>static bool check(const char *frame, quint32 len)</tt>, checksum
+ *
+ *  A frame that fails its checksum only loses its sync byte, so framing
+ *  resyncs on the next sync byte rather than skipping a whole frame.
+ */
+template <class Format>
+struct SyncFraming
+{
+    //! Longest frame.
+    static const quint32 maxFrameLen = Format::maxFrameLen;
+
+    //! Check a frame.
+    static bool check(const char *frame, quint32 len)
+    {
+        return Format::check(frame, len);
+    }
+
+    //! Bytes dropped from a frame that fails its checksum.
+    static quint32 badFrameSkip(quint32) { return 1; }
+
+    //! Find the frame at the front of the buffer.
+    /*!
+     *  \param buf Buffered bytes.
+     *  \param len Set to the frame length, or the bytes to skip.
+     *  \return What is at the front of the buffer.
+     */
+    template <class Ring>
+    static FrameScan scan(const Ring &buf, quint32 &len)
+    {
+        // Drop anything in front of the next sync byte.
+        len = buf.indexOf(Format::syncByte());
+        if (len) {
+            return FrameScan::SKIP;
+        }
+        if (buf.size() < Format::headerLen) {
+            return FrameScan::WAIT;
+        }
+        // The sync byte can show up in the payload, so check the rest of the
+        // header before waiting for a whole frame.
+        char header[Format::headerLen];
+        buf.peek(header, Format::headerLen);
+        len = Format::frameLen(header);
+        if (!len) {
+            len = 1;
+            return FrameScan::SKIP;
+        }
+        return buf.size() < len ? FrameScan::WAIT : FrameScan::FRAME;
+    }
+};
+
+
+//! Framing of packets that end with a terminator, such as text lines.
+/*!
+ *  The Format describes the packets:
+ *
+ *  - <tt>static const quint32 maxFrameLen</tt>, longest frame including the
+ *    terminator; longer ones are dropped
+ *  - <tt>static char terminator(void)</tt>, last byte of every frame
+ *  - <tt>static bool check(const char *frame, quint32 len)</tt>, checksum
+ *    of a frame including its terminator
+ *
+ *  A frame that fails its checksum is dropped whole.
+ */
+template <class Format>
+struct DelimitedFraming
+{
+    //! Longest frame.
+    static const quint32 maxFrameLen = Format::maxFrameLen;
+
+    //! Check a frame.
+    static bool check(const char *frame, quint32 len)
+    {
+        return Format::check(frame, len);
+    }
+
+    //! Bytes dropped from a frame that fails its checksum.
+    static quint32 badFrameSkip(quint32 len) { return len; }
+
+    //! Find the frame at the front of the buffer.
+    /*!
+     *  \param buf Buffered bytes.
+     *  \param len Set to the frame length, or the bytes to skip.
+     *  \return What is at the front of the buffer.
+     */
+    template <class Ring>
+    static FrameScan scan(const Ring &buf, quint32 &len)
+    {
+        const quint32 end = buf.indexOf(Format::terminator());
+        if (end < buf.size()) {
+            len = end + 1;
+            return len > maxFrameLen ? FrameScan::SKIP : FrameScan::FRAME;
+        }
+        // Keep the partial frame at the end, unless it is too long to be one.
+        if (buf.size() >= maxFrameLen) {
+            len = buf.size();
+            return FrameScan::SKIP;
+        }
+        return FrameScan::WAIT;
+    }
+};
+
+
+//! MAVLink v1 packet format, for SyncFraming.
+/*!
+ *  A packet is the start byte 0xfe, the payload length, sequence number,
+ *  system, component and message IDs, the payload, and a CRC-16/X.25 of
+ *  everything after the start byte and the message's CRC extra byte,
+ *  little-endian.
+ *
+ *  \tparam CrcExtra Function giving the CRC extra byte of a message ID,
+ *      from the MAVLink dialect's MAVLINK_MESSAGE_CRCS.
+ */
+template <quint8 (*CrcExtra)(quint8)>
+struct MavlinkFormat
+{
+    //! Start byte through message ID.
+    static const quint32 headerLen = 6;
+    //! Header, the longest payload and the CRC.
+    static const quint32 maxFrameLen = headerLen + 255 + 2;
+    //! Start byte.
+    static char syncByte(void) { return '\xfe'; }
+    //! Frame length from the payload length.
+    static quint32 frameLen(const char *header)
+    {
+        return headerLen + static_cast<quint8>(header[1]) + 2;
+    }
+    //! Check the CRC.
+    static bool check(const char *frame, quint32 len)
+    {
+        quint16 crc = crc16X25(frame + 1, len - 3);
+        const char extra = static_cast<char>(
+            CrcExtra(static_cast<quint8>(frame[5])));
+        crc = crc16X25(&extra, 1, crc);
+        return (static_cast<quint8>(frame[len - 2]) == (crc & 0xff)) &&
+            (static_cast<quint8>(frame[len - 1]) == (crc >> 8));
+    }
+};
+
+
+//! Framing of MAVLink v1 packets.
+template <quint8 (*CrcExtra)(quint8)>
+using MavlinkFraming = SyncFraming<MavlinkFormat<CrcExtra>>;
+
+
+//! Splits a serial byte stream into validated packets.
+/*!
+ *  Bytes are copied once, into a ring buffer, and every frame is handed out
+ *  as a view into it, so drivers decode straight from the buffer. Frames
+ *  that wrap around the end of the ring are mirrored into slack after it,
+ *  so each view is contiguous. The framing itself is a compile-time policy
+ *  (SyncFraming, DelimitedFraming or MavlinkFraming), so every sensor runs
+ *  the same inlined loop, and the framer keeps the sensor's RxStats:
+ *  packets, checksum failures, discarded bytes, resyncs and peak buffered.
+ *
+ *  Not thread safe; the framer is owned by the sensor thread.
+ *
+ *  \tparam Policy Framing policy.
+ *  \tparam Capacity Ring buffer size in bytes, a power of two larger than
+ *      the longest frame.
+ */
+template <class Policy, quint32 Capacity>
+class Framer
+{
+    static_assert(Capacity > Policy::maxFrameLen,
+        "Framer capacity must exceed the longest frame");
+
+public:
+    //! Constructor
+    /*!
+     *  \param _stats Receive statistics to update.
+     */
+    explicit Framer(RxStats &_stats) : stats(_stats) { };
+
+    //! Copy received bytes into the buffer.
+    /*!
+     *  Call next() until it returns false before writing again, which
+     *  leaves room for at least Capacity less one frame.
+     *
+     *  \param bytes Raw bytes.
+     *  \param len Number of bytes.
+     *  \return Number of bytes copied, less than len if the buffer filled.
+     */
+    quint32 write(const char *bytes, qint64 len)
+    {
+        const quint32 n = buf.write(bytes,
+            static_cast<quint32>(qMin<qint64>(len, Capacity)));
+        if (buf.size() > stats.peakBuffered) {
+            stats.peakBuffered = buf.size();
+        }
+        return n;
+    }
+
+    //! Get the next valid frame.
+    /*!
+     *  Drops the frame returned by the previous call, then anything that is
+     *  not a valid frame in front of the next one.
+     *
+     *  \param frame Set to the frame, valid until the next call.
+     *  \return True if a frame was found, false if more bytes are needed.
+     */
+    bool next(FrameView &frame)
+    {
+        buf.discard(pending);
+        pending = 0;
+        quint32 len = 0;
+        for (;;) {
+            switch (Policy::scan(buf, len)) {
+                case FrameScan::WAIT:
+                    return false;
+                case FrameScan::SKIP:
+                    buf.discard(len);
+                    stats.bytesDiscarded += len;
+                    lostSync();
+                    break;
+                case FrameScan::FRAME: {
+                    const char *data = buf.view(len);
+                    if (Policy::check(data, len)) {
+                        frame.data = data;
+                        frame.len = len;
+                        pending = len;
+                        synced = true;
+                        ++stats.packetsParsed;
+                        return true;
+                    }
+                    ++stats.checksumFailures;
+                    const quint32 skip = Policy::badFrameSkip(len);
+                    buf.discard(skip);
+                    if (skip < len) {
+                        stats.bytesDiscarded += skip;
+                        lostSync();
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    //! Number of bytes buffered, including the frame last returned.
+    quint32 buffered(void) const { return buf.size(); }
+
+private:
+    //! Count a resync, once per loss of framing.
+    void lostSync(void)
+    {
+        if (synced) {
+            ++stats.resyncs;
+            synced = false;
+        }
+    }
+
+    //! Buffered bytes, with slack for the longest frame.
+    ByteRing<Capacity, Policy::maxFrameLen> buf;
+
+    //! Length of the frame last returned, dropped on the next call.
+    quint32 pending{0};
+
+    //! Flag to indicate the last bytes framed were a valid frame.
+    bool synced{true};
+
+    //! Receive statistics.
+    RxStats &stats;
+};
+
+
+};  // namespace dfti
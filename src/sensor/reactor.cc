@@ -0,0 +1,138 @@
+/*!
+ *  \file reactor.cc
+ *  \brief Single thread serial port reactor implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "reactor.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+Reactor::Reactor(Settings *_settings, QObject* _parent)
+: settings(_settings), QObject(_parent)
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        qWarning() << "[ERROR]  Reactor: failed to create epoll instance:"
+                   << strerror(errno);
+        return;
+    }
+    // The wake-up eventfd is the only entry with no sensor.
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+}
+
+
+Reactor::~Reactor()
+{
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+void
+Reactor::addSensor(SerialSensor *sensor)
+{
+    sensor->setReactor(this);
+    sensors.push_back(sensor);
+}
+
+
+bool
+Reactor::watch(SerialSensor *sensor)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = sensor;
+    if (epollFd < 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, sensor->handle(), &ev) < 0) {
+        qWarning() << "[ERROR]  Reactor: failed to watch serial port:"
+                   << strerror(errno);
+        return false;
+    }
+    if (settings->debugSerial()) {
+        qDebug() << "[INFO ]  reactor watching fd" << sensor->handle();
+    }
+    return true;
+}
+
+
+void
+Reactor::stop(void)
+{
+    stopped = true;
+    const quint64 one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0 && settings->debugSerial()) {
+        qDebug() << "Reactor: failed to wake:" << strerror(errno);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Public Slots
+// ----------------------------------------------------------------------------
+void
+Reactor::threadStart(void)
+{
+    // Sensors open their ports and register them from this thread.
+    for (auto sensor : sensors) {
+        sensor->threadStart();
+    }
+
+    struct epoll_event events[maxEvents];
+    while (!stopped) {
+        const int n = epoll_wait(epollFd, events, maxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            qWarning() << "[ERROR]  Reactor: epoll_wait failed:"
+                       << strerror(errno);
+            return;
+        }
+        ++m_stats.wakeups;
+        for (int i = 0; i < n; ++i) {
+            SerialSensor *sensor =
+                static_cast<SerialSensor *>(events[i].data.ptr);
+            if (!sensor) {
+                // Woken by stop(); drain the eventfd.
+                quint64 count = 0;
+                while (read(wakeFd, &count, sizeof(count)) > 0) {
+                }
+                continue;
+            }
+            ++m_stats.reads;
+            sensor->readHandle();
+            // A port that hung up would be reported ready forever.
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                qWarning() << "[WARN ]  Reactor: serial port closed";
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, sensor->handle(), nullptr);
+            }
+        }
+    }
+}
+
+
+};  // namespace dfti
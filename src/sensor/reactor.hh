@@ -0,0 +1,132 @@
+/*!
+ *  \file reactor.hh
+ *  \brief Single thread serial port reactor interface.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+// 3rd party
+#include <QDebug>
+#include <QObject>
+#include <QPointer>
+// dfti
+#include "sensor/serialsensor.hh"
+#include "settings/settings.hh"
+
+
+namespace dfti {
+
+
+//! Reactor statistics.
+struct ReactorStats
+{
+    //! Returns from epoll_wait.
+    quint64 wakeups{0};
+    //! Ready serial ports handled.
+    quint64 reads{0};
+};
+
+
+//! Reads every serial sensor from one thread with epoll.
+/*!
+ *  In the default layout each sensor has its own thread, and its Qt event
+ *  loop wakes up for every readyRead. On a single core computer that is a
+ *  context switch per packet per sensor. The reactor instead starts all of
+ *  its sensors in one thread and waits on all of their file descriptors
+ *  with a single epoll_wait; each ready port is read to exhaustion and
+ *  parsed inline, and the measurements reach the logger and server through
+ *  the same lock-free queues as before.
+ *
+ *  The reactor thread never runs a Qt event loop, so QSerialPort never
+ *  reads the ports itself; writes queued on a port are flushed after each
+ *  read (see SerialSensor::readHandle). Signals the sensors emit are still
+ *  delivered to receivers in other threads.
+ */
+class Reactor : public QObject
+{
+    Q_OBJECT;
+
+public:
+    //! Constructor
+    /*!
+     *  \param _settings Pointer to settings object.
+     *  \param _parent Pointer to parent QObject.
+     */
+    explicit Reactor(Settings *_settings, QObject* _parent = nullptr);
+
+    //! Dtor.
+    ~Reactor();
+
+    //! Add a sensor to be started and read by the reactor.
+    /*!
+     *  Must be called before the reactor thread starts, and the sensor must
+     *  be moved to the reactor's thread.
+     *
+     *  \param sensor Sensor to add.
+     */
+    void addSensor(SerialSensor *sensor);
+
+    //! Watch an open sensor port.
+    /*!
+     *  Called by the sensor once its port is open.
+     *
+     *  \param sensor Sensor whose port to watch.
+     *  \return True if the port was added.
+     */
+    bool watch(SerialSensor *sensor);
+
+    //! Make threadStart() return; may be called from any thread.
+    void stop(void);
+
+    //! Return the reactor statistics.
+    /*!
+     *  \remark Updated by the reactor thread; read them once it has stopped.
+     */
+    ReactorStats stats(void) const { return m_stats; };
+
+public slots:
+    //! Start the sensors and read them until stopped.
+    void threadStart(void);
+
+private:
+    //! Most events handled per epoll_wait.
+    static const int maxEvents{8};
+
+    //! Pointer to settings object.
+    QPointer<Settings> settings{nullptr};
+
+    //! epoll instance.
+    int epollFd{-1};
+
+    //! eventfd that wakes the loop to stop it.
+    int wakeFd{-1};
+
+    //! Sensors started by the reactor.
+    std::vector<SerialSensor *> sensors;
+
+    //! Set to make the loop return.
+    std::atomic<bool> stopped{false};
+
+    //! Reactor statistics.
+    ReactorStats m_stats;
+};
+
+
+};  // namespace dfti
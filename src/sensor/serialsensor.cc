@@ -12,6 +12,7 @@
  * in rendering engineering or other professional services associate with their use.
  */
 #include "serialsensor.hh"
+#include "reactor.hh"
 
 
 namespace dfti {
@@ -22,7 +23,7 @@ namespace dfti {
 // ----------------------------------------------------------------------------
 SerialSensor::~SerialSensor(void)
 {
-    if (_port->isOpen()) {
+    if (_port && _port->isOpen()) {
         _port->close();
     }
 }
@@ -42,6 +43,13 @@ void
 SerialSensor::init()
 {
     QString port = validateSerialPort(portName);
+    if (settings->serialBackend() == SerialBackend::TERMIOS) {
+        // Termios settings are applied when the port is opened.
+        termios.reset(new TermiosPort());
+        devicePath = port;
+        _valid_serial = port != "";
+        return;
+    }
     _port = new QSerialPort(this);
     if (port != "") {
         _port->setPortName(port);
@@ -66,8 +74,22 @@ SerialSensor::init()
 void
 SerialSensor::open(void)
 {
+    if (_valid_serial && !isOpen() && termios) {
+        if (termios->open(devicePath, baudRate)) {
+            if (settings->debugSerial()) {
+                qDebug() << "Opened serial port:" << devicePath
+                         << "(termios, low latency"
+                         << (termios->lowLatency() ? "on)" : "off)");
+            }
+            watchPort();
+        } else {
+            qWarning() << "[ERROR]  failed to open serial port" << devicePath
+                       << ":" << termios->errorString();
+        }
+        return;
+    }
     if (_valid_serial && !isOpen()) {
-        if (_port->open(QIODevice::ReadOnly)) {
+        if (_port->open(openMode)) {
             if (settings->debugSerial()) {
                 qDebug() << "Opened serial port:"
                          << _port->portName();
@@ -78,8 +100,7 @@ SerialSensor::open(void)
                          << _port->errorString();
             }
         };
-        connect(QSERIALPORTPTR(_port), &QIODevice::readyRead, this,
-            &SerialSensor::readData);
+        watchPort();
     }
 }
 
@@ -87,6 +108,9 @@ SerialSensor::open(void)
 bool
 SerialSensor::isOpen(void)
 {
+    if (termios) {
+        return termios->isOpen();
+    }
     return _port != nullptr ? _port->isOpen() : false;
 }
 
@@ -94,14 +118,12 @@ SerialSensor::isOpen(void)
 void
 SerialSensor::setBaudRate(quint32 rate)
 {
-    switch (rate) {
-        case 115200:
-            baudRate = QSerialPort::Baud115200;
-            break;
-        case 57600:  // fallthrough
-        default:
-            baudRate = QSerialPort::Baud57600;
-            break;
+    if (TermiosPort::supportedBaudRate(rate)) {
+        baudRate = rate;
+    } else {
+        qWarning() << "[WARN ]  unsupported baud rate" << rate
+                   << "- using 57600";
+        baudRate = 57600;
     }
 }
 
@@ -114,16 +136,147 @@ SerialSensor::threadStart(void)
 }
 
 
+void
+SerialSensor::enableCapture(CaptureFile *file, CaptureSensor sensor)
+{
+    capture.reset(new CaptureBuffer(file, sensor));
+}
+
+
+int
+SerialSensor::handle(void) const
+{
+    if (termios) {
+        return termios->handle();
+    }
+    return _port && _port->isOpen() ? _port->handle() : -1;
+}
+
+
+void
+SerialSensor::readHandle(void)
+{
+    const int fd = handle();
+    char chunk[readChunkSize];
+    ssize_t len = 0;
+    while ((len = ::read(fd, chunk, sizeof(chunk))) > 0) {
+        receiveChunk(chunk, len);
+    }
+    if (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        if (settings->debugSerial()) {
+            qDebug() << "Failed to read serial port:" << strerror(errno);
+        }
+    }
+    if (termios) {
+        termios->setReadMinimum(bytesWanted());
+    } else if (_port->bytesToWrite()) {
+        _port->flush();
+    }
+}
+
+
+void
+SerialSensor::processBytes(const char *bytes, qint64 len, quint64 _rxTimeNs)
+{
+    // Both clocks are read once per chunk: the monotonic one to align
+    // sensors with, the Unix one for the logs.
+    rxTimeNs = _rxTimeNs;
+    rxTimeUsec = getTimeUsec();
+    parseBytes(bytes, len);
+}
+
+// ----------------------------------------------------------------------------
+// Public Slots
+// ----------------------------------------------------------------------------
+void
+SerialSensor::readData(void)
+{
+    char chunk[readChunkSize];
+    qint64 len = 0;
+    while ((len = _port->read(chunk, sizeof(chunk))) > 0) {
+        receiveChunk(chunk, len);
+    }
+    if (len < 0) {
+        if (settings->debugSerial()) {
+            qDebug() << "Failed to read serial port!";
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+void
+SerialSensor::watchPort(void)
+{
+    if (reactor) {
+        if (isOpen()) {
+            reactor->watch(this);
+        }
+    } else if (termios) {
+        // String based, as activated() is overloaded from Qt 5.15.
+        readNotifier = new QSocketNotifier(handle(), QSocketNotifier::Read,
+            this);
+        connect(readNotifier.data(), SIGNAL(activated(int)), this,
+            SLOT(readHandle()));
+    } else {
+        connect(QSERIALPORTPTR(_port), &QIODevice::readyRead, this,
+            &SerialSensor::readData);
+    }
+}
+
+
+qint64
+SerialSensor::writePort(const char *data, qint64 len)
+{
+    if (termios) {
+        return termios->write(data, len);
+    }
+    const qint64 written = _port->write(data, len);
+    _port->flush();
+    return written;
+}
+
+
+void
+SerialSensor::receiveChunk(const char *chunk, qint64 len)
+{
+    const quint64 now = getMonotonicNsec();
+    // The capture path only copies bytes, so it stays ahead of parsing.
+    if (capture) {
+        capture->append(now, chunk, len);
+    }
+    processBytes(chunk, len, now);
+}
+
+
+
 QString
 SerialSensor::validateSerialPort(QString _port)
 {
+    // Compare canonical paths so that udev symlinks such as
+    // /dev/serial/by-id/... match the device they point to.
+    const QString target = QFileInfo(_port).canonicalFilePath();
     for (auto port : QSerialPortInfo::availablePorts()) {
         QString candidate = port.portName();
         candidate.prepend("/dev/");
-        if (_port == candidate) {
+        if (_port == candidate ||
+            (!target.isEmpty() &&
+             target == QFileInfo(candidate).canonicalFilePath())) {
             return _port;
         }
     }
+    // Pseudo-terminals (e.g. from dftisim) and other tty drivers aren't
+    // enumerated, but any existing character device can be opened.
+    struct stat st;
+    if (!target.isEmpty() &&
+        ::stat(target.toLocal8Bit().constData(), &st) == 0 &&
+        S_ISCHR(st.st_mode)) {
+        if (settings->debugSerial()) {
+            qDebug() << "[INFO ]  using unlisted character device" << target;
+        }
+        return target;
+    }
     qWarning() << "[WARN ]  validation of serial port" << _port << "failed!";
     return QString{""};
 }
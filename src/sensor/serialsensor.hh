@@ -14,16 +14,27 @@
 #pragma once
 
 
+// stdlib
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
 // 3rd party
 #include <QByteArray>
 #include <QDebug>
+#include <QFileInfo>
 #include <QIODevice>
 #include <QObject>
 #include <QPointer>
+#include <QScopedPointer>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QSocketNotifier>
 // dfti
 #include "core/qptrutil.hh"
+#include "sensor/capture.hh"
+#include "sensor/framer.hh"
+#include "sensor/termiosport.hh"
 #include "settings/settings.hh"
 #include "util/util.hh"
 
@@ -31,7 +42,19 @@
 namespace dfti {
 
 
+class Reactor;
+
+
 //! Base class for interfacing with sensors over a serial port (UART/RS-232).
+/*!
+ *  By default the sensor reads its port from the Qt event loop of its own
+ *  thread (see readData). With setReactor() a shared Reactor thread reads
+ *  the port's file descriptor instead (see readHandle).
+ *
+ *  The port is a QSerialPort unless serial_backend is termios, in which
+ *  case it is a TermiosPort read directly from its file descriptor (see
+ *  readHandle), in low latency mode and with VMIN set to bytesWanted().
+ */
 class SerialSensor : public QObject
 {
     Q_OBJECT;
@@ -74,7 +97,8 @@ public:
 
     //! Set the serial port baud rate.
     /*!
-     *  \param rate The serial port baud rate. Must be one of 57600, 115200.
+     *  \param rate The serial port baud rate. Must be a standard rate from
+     *      9600 to 921600 (see TermiosPort::supportedBaudRate).
      *  \remark If an unsupported baud rate is given, the sensor falls back to
      *      57600 baud.
      */
@@ -83,11 +107,130 @@ public:
     //! Start the sensor in a thread.
     void threadStart(void);
 
+    //! Capture every raw chunk read from the serial port.
+    /*!
+     *  Must be called before the sensor thread starts.
+     *
+     *  \param file Capture file shared by all sensors.
+     *  \param sensor Identifier for this sensor's frames.
+     */
+    void enableCapture(CaptureFile *file, CaptureSensor sensor);
+
+    //! Parse a chunk of raw bytes from the sensor.
+    /*!
+     *  Records the receive time of the chunk, which every measurement it
+     *  completes is stamped with, and passes the bytes to parseBytes().
+     *
+     *  \param bytes Raw bytes.
+     *  \param len Number of bytes.
+     *  \param _rxTimeNs Monotonic time the bytes were read, nanoseconds
+     *      (see getMonotonicNsec).
+     */
+    void processBytes(const char *bytes, qint64 len, quint64 _rxTimeNs);
+
+    //! Receive statistics.
+    /*!
+     *  \remark Updated by the sensor thread; read them from that thread or
+     *      once it has stopped.
+     */
+    RxStats rxStats(void) const { return stats; };
+
+    //! Have a Reactor read the serial port instead of a Qt event loop.
+    /*!
+     *  Must be called before the sensor is started; the reactor then starts
+     *  the sensor in its own thread (see Reactor::addSensor).
+     *
+     *  \param _reactor Reactor to register the port with.
+     */
+    void setReactor(Reactor *_reactor) { reactor = _reactor; };
+
+    //! Native file descriptor of the serial port.
+    /*!
+     *  \return File descriptor, or -1 if the port is not open.
+     */
+    int handle(void) const;
+
 public slots:
     //! Slot to read in data over serial and parse complete packets.
-    virtual void readData(void) = 0;
+    /*!
+     *  Reads everything the port has buffered, in chunks of up to
+     *  readChunkSize bytes, stamps each chunk with the monotonic clock as soon
+     *  as it is read, captures it if enabled and passes it to processBytes().
+     */
+    virtual void readData(void);
+
+    //! Read and parse everything buffered on the native port.
+    /*!
+     *  The reactor counterpart of readData(): reads the file descriptor
+     *  directly, bypassing QSerialPort's buffer, until it would block, then
+     *  writes out anything queued on the port, since the reactor thread has
+     *  no event loop to do it. This is also how the termios backend is read
+     *  from the sensor's own thread; it then sets VMIN to bytesWanted().
+     */
+    void readHandle(void);
 
 protected:
+    //! Parse a chunk of raw bytes from the sensor.
+    /*!
+     *  Bytes are handed over exactly as read; implementations keep whatever
+     *  partial packet is left at the end for the next call, and stamp the
+     *  measurements they complete with rxTimeNs and rxTimeUsec.
+     *
+     *  \param bytes Raw bytes.
+     *  \param len Number of bytes.
+     */
+    virtual void parseBytes(const char *bytes, qint64 len) = 0;
+
+    //! Arrange for the open port to be read.
+    /*!
+     *  Connects readyRead to readData(), or registers the port with the
+     *  reactor if one is set.
+     */
+    void watchPort(void);
+
+    //! Bytes needed to complete the packet being received.
+    /*!
+     *  Used as VMIN by the termios backend, so the port is only reported
+     *  readable once a whole packet can be parsed. Drivers with variable
+     *  length packets keep the default of 1.
+     *
+     *  \return Bytes, at least 1.
+     */
+    virtual quint32 bytesWanted(void) const { return 1; };
+
+    //! Write bytes to the port.
+    /*!
+     *  Writes through at once rather than waiting for the event loop, which
+     *  the reactor thread doesn't run.
+     *
+     *  \param data Bytes to write.
+     *  \param len Number of bytes.
+     *  \return Bytes written, or -1 on error.
+     */
+    qint64 writePort(const char *data, qint64 len);
+
+    //! Stamp, capture and parse one chunk just read from the port.
+    /*!
+     *  \param chunk Raw bytes.
+     *  \param len Number of bytes.
+     */
+    void receiveChunk(const char *chunk, qint64 len);
+
+    //! Largest chunk read from the port at once.
+    static const quint32 readChunkSize{4096};
+
+    //! Receive statistics.
+    RxStats stats;
+
+    //! Monotonic time the chunk being parsed was read, nanoseconds.
+    quint64 rxTimeNs{0};
+
+    //! Unix time the chunk being parsed was read, microseconds.
+    quint64 rxTimeUsec{0};
+
+    //! Raw capture staging buffer, if capture is enabled.
+    QScopedPointer<CaptureBuffer> capture;
+
     //! Settings object.
     QPointer<Settings> settings = nullptr;
 
@@ -95,7 +238,11 @@ protected:
     QString portName{""};
 
     //! Serial port baud rate.
-    QSerialPort::BaudRate baudRate{QSerialPort::Baud115200};
+    quint32 baudRate{115200};
+
+    //! Mode the QSerialPort is opened in; the termios backend is always
+    //! opened read/write.
+    QIODevice::OpenMode openMode{QIODevice::ReadOnly};
 
     //! Indicates if serial port passed validation.
     bool _valid_serial = false;
@@ -103,12 +250,27 @@ protected:
     //! Serial port object.
     QPointer<QSerialPort> _port = nullptr;
 
+    //! Termios serial port, if that backend is used.
+    QScopedPointer<TermiosPort> termios;
+
+    //! Validated device path for the termios backend.
+    QString devicePath{""};
+
+    //! Watches the termios port when not using a reactor.
+    QPointer<QSocketNotifier> readNotifier{nullptr};
+
+    //! Reactor reading the port, if any.
+    Reactor *reactor{nullptr};
+
     //! Validates a proposed serial port.
     /*!
-     *  Checks to see if the given serial port name is a valid serial port.
+     *  Checks to see if the given serial port name is a valid serial port,
+     *  either one Qt enumerates (directly or through a symlink) or any other
+     *  existing character device, such as a pseudo-terminal.
      *
      *  \param _port Proposed serial port.
-     *  \return True if the port name corresponds to a valid system serial port.
+     *  \return The port name to open, or an empty string if the port is
+     *      invalid.
      */
     QString validateSerialPort(QString _port);
 };
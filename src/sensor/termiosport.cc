@@ -0,0 +1,193 @@
+/*!
+ *  \file termiosport.cc
+ *  \brief Native termios serial port implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "termiosport.hh"
+
+
+namespace dfti {
+
+
+//! Map a baud rate to its termios speed.
+/*!
+ *  \param rate Baud rate.
+ *  \param speed Termios speed constant.
+ *  \return False if the rate is not supported.
+ */
+static bool
+baudSpeed(quint32 rate, speed_t &speed)
+{
+    switch (rate) {
+        case 9600:
+            speed = B9600;
+            return true;
+        case 19200:
+            speed = B19200;
+            return true;
+        case 38400:
+            speed = B38400;
+            return true;
+        case 57600:
+            speed = B57600;
+            return true;
+        case 115200:
+            speed = B115200;
+            return true;
+        case 230400:
+            speed = B230400;
+            return true;
+        case 460800:
+            speed = B460800;
+            return true;
+        case 921600:
+            speed = B921600;
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+TermiosPort::~TermiosPort()
+{
+    close();
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+bool
+TermiosPort::supportedBaudRate(quint32 rate)
+{
+    speed_t speed;
+    return baudSpeed(rate, speed);
+}
+
+
+bool
+TermiosPort::open(const QString &path, quint32 baud)
+{
+    close();
+    speed_t speed;
+    if (!baudSpeed(baud, speed)) {
+        error = QString("unsupported baud rate %1").arg(baud);
+        return false;
+    }
+    fd = ::open(path.toLocal8Bit().constData(),
+        O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        setError("open");
+        return false;
+    }
+    if (tcgetattr(fd, &tio) < 0) {
+        setError("tcgetattr");
+        close();
+        return false;
+    }
+
+    // Raw 8N1, receiver on, modem lines ignored, no flow control.
+    cfmakeraw(&tio);
+    tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    tio.c_cflag |= CS8 | CLOCAL | CREAD;
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    tio.c_cc[VMIN] = readMinimum = 1;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        setError("tcsetattr");
+        close();
+        return false;
+    }
+    // Drop whatever arrived before we were configured.
+    tcflush(fd, TCIFLUSH);
+
+    struct serial_struct serial;
+    m_lowLatency = false;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        m_lowLatency = ioctl(fd, TIOCSSERIAL, &serial) == 0;
+    }
+    return true;
+}
+
+
+void
+TermiosPort::close(void)
+{
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+
+bool
+TermiosPort::setReadMinimum(quint32 bytes)
+{
+    bytes = qBound<quint32>(1, bytes, 255);
+    if (bytes == readMinimum || fd < 0) {
+        return true;
+    }
+    tio.c_cc[VMIN] = static_cast<cc_t>(bytes);
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        setError("tcsetattr");
+        return false;
+    }
+    readMinimum = bytes;
+    return true;
+}
+
+
+qint64
+TermiosPort::write(const char *data, qint64 len)
+{
+    qint64 written = 0;
+    while (written < len) {
+        const ssize_t n = ::write(fd, data + written, len - written);
+        if (n > 0) {
+            written += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            setError("write");
+            break;
+        }
+        // Output buffer full; wait for room.
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if (poll(&pfd, 1, writeTimeoutMs) <= 0) {
+            error = "write timed out";
+            break;
+        }
+    }
+    return written;
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+void
+TermiosPort::setError(const char *what)
+{
+    error = QString("%1: %2").arg(what).arg(strerror(errno));
+}
+
+
+};  // namespace dfti
@@ -0,0 +1,127 @@
+/*!
+ *  \file termiosport.hh
+ *  \brief Native termios serial port interface.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+// 3rd party
+#include <QString>
+#include <QtGlobal>
+
+
+namespace dfti {
+
+
+//! Serial port opened directly with termios.
+/*!
+ *  The alternative to QSerialPort behind SerialSensor: the tty is opened
+ *  non-blocking in raw 8N1 mode with no flow control, and reads go
+ *  straight to the file descriptor, with no buffer or notifier in between.
+ *
+ *  Two settings cut read latency. The port is put in ASYNC_LOW_LATENCY
+ *  mode, which for USB serial adapters such as the FTDI sets the latency
+ *  timer to 1 ms; ports that don't support it (e.g. pseudo-terminals) are
+ *  left as they are. VMIN can be set to the number of bytes a sensor still
+ *  needs to complete its next packet: with VTIME 0, poll() and epoll only
+ *  report the port readable once that many bytes are buffered, so a
+ *  reader wakes once per packet instead of once per few bytes.
+ */
+class TermiosPort
+{
+public:
+    //! Dtor; closes the port.
+    ~TermiosPort();
+
+    //! Returns true if a baud rate is supported.
+    /*!
+     *  \param rate Baud rate; one of the standard rates from 9600 to 921600.
+     */
+    static bool supportedBaudRate(quint32 rate);
+
+    //! Open and configure the port.
+    /*!
+     *  \param path Device path.
+     *  \param baud Baud rate; see supportedBaudRate.
+     *  \return True on success; see errorString otherwise.
+     */
+    bool open(const QString &path, quint32 baud);
+
+    //! Close the port.
+    void close(void);
+
+    //! Returns true if the port is open.
+    bool isOpen(void) const { return fd >= 0; };
+
+    //! File descriptor, or -1 if the port is not open.
+    int handle(void) const { return fd; };
+
+    //! Set the bytes a read waits for (VMIN).
+    /*!
+     *  Only calls tcsetattr() when the value changes.
+     *
+     *  \param bytes Bytes wanted, clamped to 1 to 255.
+     *  \return True on success.
+     */
+    bool setReadMinimum(quint32 bytes);
+
+    //! Write bytes, waiting briefly if the output buffer is full.
+    /*!
+     *  \param data Bytes to write.
+     *  \param len Number of bytes.
+     *  \return Bytes written.
+     */
+    qint64 write(const char *data, qint64 len);
+
+    //! Returns true if low latency mode was set.
+    bool lowLatency(void) const { return m_lowLatency; };
+
+    //! Description of the last error.
+    QString errorString(void) const { return error; };
+
+private:
+    //! Record the current errno as the last error.
+    /*!
+     *  \param what Call that failed.
+     */
+    void setError(const char *what);
+
+    //! Longest write() waits for room in the output buffer, ms.
+    static const int writeTimeoutMs{100};
+
+    //! File descriptor.
+    int fd{-1};
+
+    //! Current terminal settings.
+    struct termios tio;
+
+    //! Current VMIN.
+    quint32 readMinimum{1};
+
+    //! Low latency mode set.
+    bool m_lowLatency{false};
+
+    //! Description of the last error.
+    QString error;
+};
+
+
+};  // namespace dfti
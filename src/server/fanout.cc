@@ -0,0 +1,285 @@
+/*!
+ *  \file fanout.cc
+ *  \brief Batched state data sender implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "fanout.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+Fanout::~Fanout()
+{
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+bool
+Fanout::open(quint8 ttl, const QHostAddress &multicastInterface)
+{
+    fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        qWarning() << "[WARN ]  Fanout: socket failed:" << strerror(errno);
+        return false;
+    }
+
+    // Only multicast datagrams use these.
+    int hops = ttl;
+    if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &hops,
+            sizeof(hops)) < 0) {
+        qWarning() << "[WARN ]  Fanout: cannot set multicast TTL:"
+                   << strerror(errno);
+    }
+    if (!multicastInterface.isNull()) {
+        struct in_addr iface;
+        iface.s_addr = htonl(multicastInterface.toIPv4Address());
+        if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &iface,
+                sizeof(iface)) < 0) {
+            qWarning() << "[WARN ]  Fanout: cannot set multicast interface"
+                       << multicastInterface << ":" << strerror(errno);
+        }
+    }
+    return true;
+}
+
+
+bool
+Fanout::set(const QHostAddress &address, quint16 port, quint32 periodUsec,
+    quint32 mask, const DestinationEncoding &encoding)
+{
+    if (address.protocol() != QAbstractSocket::IPv4Protocol) {
+        return false;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(address.toIPv4Address());
+    const quint32 i = find(addr);
+    if (i == targets.size()) {
+        targets.push_back(Target());
+        targets.back().addr = addr;
+    }
+    Target &target = targets[i];
+    target.periodNs = 1000ull * periodUsec;
+    target.nextNs = 0;
+    mask |= 1u << stateFieldSequence;
+    const bool same = (mask == target.mask &&
+        encoding.keyframeInterval == target.encoding.keyframeInterval &&
+        encoding.fecData == target.encoding.fecData &&
+        encoding.fecParity == target.encoding.fecParity);
+    target.mask = mask;
+    target.encoding = encoding;
+    target.size = stateFieldsSize(mask);
+    target.record.resize(target.size);
+    if (!encoding.keyframeInterval) {
+        target.encoder.reset();
+    } else if (!target.encoder || !same) {
+        target.encoder.reset(new DeltaEncoder(stateFieldChannels(mask),
+            encoding.keyframeInterval));
+        target.packet.resize(target.encoder->maxPacketLen());
+    }
+    if (!encoding.fecParity) {
+        target.fec.reset();
+    } else if (!target.fec || !same) {
+        target.fec.reset(new FecEncoder(encoding.fecData, encoding.fecParity,
+            target.encoder ? target.encoder->maxPacketLen() : target.size));
+        target.fecPacket.resize(target.fec->maxPacketLen());
+        target.parityIovs.resize(encoding.fecParity);
+    }
+
+    // One iovec per run of adjacent fields, then the sequence number.
+    target.iovs.clear();
+    target.offsets.clear();
+    for (quint32 f = 0; f < numStateFields; ++f) {
+        if (f == stateFieldSequence || !(mask & (1u << f))) {
+            continue;
+        }
+        const StateField &field = stateFields[f];
+        if (!target.iovs.empty() &&
+                target.offsets.back() + target.iovs.back().iov_len ==
+                    field.offset) {
+            target.iovs.back().iov_len += field.size;
+        } else {
+            target.iovs.push_back({nullptr, field.size});
+            target.offsets.push_back(field.offset);
+        }
+    }
+    target.iovs.push_back({nullptr, sizeof(target.sequence)});
+    resizeBatch();
+    return true;
+}
+
+
+bool
+Fanout::remove(const QHostAddress &address, quint16 port)
+{
+    if (address.protocol() != QAbstractSocket::IPv4Protocol) {
+        return false;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(address.toIPv4Address());
+    const quint32 i = find(addr);
+    if (i == targets.size()) {
+        return false;
+    }
+    targets.erase(targets.begin() + i);
+    resizeBatch();
+    return true;
+}
+
+
+quint32
+Fanout::send(const TelemetryState &state, quint64 nowNs, quint64 slackNs,
+    quint32 &failed)
+{
+    failed = 0;
+    if (fd < 0) {
+        return 0;
+    }
+
+    // Point the due destinations' iovecs at the state data, or encode
+    // their datagrams.
+    char *base = reinterpret_cast<char *>(
+        const_cast<TelemetryState *>(&state));
+    count = 0;
+    for (quint32 t = 0; t < targets.size(); ++t) {
+        Target &target = targets[t];
+        if (target.periodNs) {
+            if (nowNs + slackNs < target.nextNs) {
+                continue;
+            }
+            // Keep to the period unless this is the first send or a whole
+            // period was missed.
+            const bool restart = !target.nextNs ||
+                (nowNs >= target.nextNs + target.periodNs);
+            target.nextNs = (restart ? nowNs : target.nextNs) +
+                target.periodNs;
+        }
+        if (!target.encoder && !target.fec) {
+            const quint32 runs = target.offsets.size();
+            for (quint32 i = 0; i < runs; ++i) {
+                target.iovs[i].iov_base = base + target.offsets[i];
+            }
+            target.iovs[runs].iov_base = &target.sequence;
+            addMessage(t, target.iovs.data(), target.iovs.size(), false);
+            continue;
+        }
+
+        // The packed record ends with the destination's sequence number.
+        char *record = reinterpret_cast<char *>(target.record.data());
+        packStateFields(state, target.mask, record);
+        memcpy(record + target.size - sizeof(target.sequence),
+            &target.sequence, sizeof(target.sequence));
+        quint8 *payload = target.record.data();
+        size_t len = target.size;
+        if (target.encoder) {
+            len = target.encoder->encode(payload, target.packet.data());
+            payload = target.packet.data();
+        }
+        if (target.fec) {
+            len = target.fec->encode(payload, len, target.fecPacket.data());
+            payload = target.fecPacket.data();
+        }
+        target.packetIov.iov_base = payload;
+        target.packetIov.iov_len = len;
+        addMessage(t, &target.packetIov, 1, false);
+        const quint8 parity = target.fec ? target.fec->parityReady() : 0;
+        for (quint8 j = 0; j < parity; ++j) {
+            target.parityIovs[j].iov_base = const_cast<quint8 *>(
+                target.fec->parity(j));
+            target.parityIovs[j].iov_len = target.fec->parityLen();
+            addMessage(t, &target.parityIovs[j], 1, true);
+        }
+    }
+
+    // A failed datagram ends the batch; skip it and send the rest.
+    quint32 sent = 0;
+    for (quint32 i = 0; i < count; ) {
+        const int ret = sendmmsg(fd, &msgs[i], count - i, 0);
+        const quint32 n = ret > 0 ? ret : 0;
+        for (quint32 j = i; j < i + n; ++j) {
+            Target &target = targets[msgTargets[j]];
+            ++target.stats.datagrams;
+            target.sequence += !msgParity[j];
+        }
+        sent += n;
+        i += n;
+        if (ret <= 0 && i < count) {
+            Target &target = targets[msgTargets[i]];
+            ++target.stats.sendErrors;
+            if (!msgParity[i]) {
+                ++target.sequence;
+                if (target.encoder) {
+                    target.encoder->requestKeyframe();
+                }
+            }
+            ++failed;
+            ++i;
+        }
+    }
+    return sent;
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+quint32
+Fanout::find(const struct sockaddr_in &addr) const
+{
+    quint32 i = 0;
+    while (i < targets.size() &&
+            (targets[i].addr.sin_port != addr.sin_port ||
+             targets[i].addr.sin_addr.s_addr != addr.sin_addr.s_addr)) {
+        ++i;
+    }
+    return i;
+}
+
+
+void
+Fanout::resizeBatch(void)
+{
+    quint32 size = 0;
+    for (const Target &target : targets) {
+        size += 1 + (target.fec ? target.encoding.fecParity : 0);
+    }
+    msgs.resize(size);
+    msgTargets.resize(size);
+    msgParity.resize(size);
+}
+
+
+void
+Fanout::addMessage(quint32 t, struct iovec *iov, size_t iovlen, bool parity)
+{
+    struct msghdr &hdr = msgs[count].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &targets[t].addr;
+    hdr.msg_namelen = sizeof(targets[t].addr);
+    hdr.msg_iov = iov;
+    hdr.msg_iovlen = iovlen;
+    msgTargets[count] = t;
+    msgParity[count++] = parity;
+}
+
+
+};  // namespace dfti
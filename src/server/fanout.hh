@@ -0,0 +1,228 @@
+/*!
+ *  \file fanout.hh
+ *  \brief Batched state data sender for several destinations.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+// 3rd party
+#include <QDebug>
+#include <QHostAddress>
+#include <QtGlobal>
+// dfti
+#include "server/statedata.hh"
+#include "telemetry/deltacodec.hh"
+#include "telemetry/fec.hh"
+
+
+namespace dfti {
+
+
+//! Send statistics of one destination.
+struct DestinationStats
+{
+    //! Datagrams sent.
+    quint64 datagrams{0};
+    //! Datagrams that failed to send.
+    quint64 sendErrors{0};
+};
+
+
+//! How the datagrams of a destination are encoded.
+struct DestinationEncoding
+{
+    //! Datagrams from one delta keyframe to the next, or 0 to send the
+    //! fields as they are.
+    quint32 keyframeInterval{0};
+    //! Datagrams per forward error correction group.
+    quint8 fecData{0};
+    //! Parity packets per group, or 0 for no forward error correction.
+    quint8 fecParity{0};
+};
+
+
+/*! \brief Sends the state data to several destinations at their own rates.
+ *
+ *  Each destination, unicast or multicast, has a send period and a subset
+ *  of the TelemetryState fields, which are sent packed in structure order
+ *  and followed by the destination's own sequence number. Rather than
+ *  packing a copy for each destination, every datagram gathers its fields
+ *  straight from the one TelemetryState with an iovec per contiguous run,
+ *  and all the datagrams due at a send go out in a single sendmmsg() call,
+ *  so the cost of a send grows with the number of syscalls and not the
+ *  destinations. Destinations may be added and removed between sends.
+ *
+ *  Destinations behind a narrowband link can instead be sent the same
+ *  record delta encoded (see DeltaEncoder), which is packed and encoded
+ *  for each of their datagrams. A keyframe follows any datagram that fails
+ *  to send. Destinations behind a lossy link can also have their
+ *  datagrams sent in forward error correction groups (see FecEncoder),
+ *  whose parity packets go out in the same sendmmsg() call as the datagram
+ *  that completes the group.
+ *
+ *  Only IPv4 destinations are supported.
+ */
+class Fanout
+{
+public:
+    //! Constructor.
+    Fanout() = default;
+
+    //! Dtor.
+    ~Fanout();
+
+    //! Open the socket.
+    /*!
+     *  \param ttl Time to live of multicast datagrams.
+     *  \param multicastInterface Interface to send multicast datagrams from,
+     *      or null for the default route.
+     *  \return False if the socket could not be opened.
+     */
+    bool open(quint8 ttl, const QHostAddress &multicastInterface);
+
+    //! Add a destination, or replace the one at the same address and port.
+    /*!
+     *  A replaced destination keeps its sequence number and statistics, and
+     *  its encoders if the fields and encoding are the same, so that
+     *  renewing a subscription does not restart the keyframes or parity
+     *  groups.
+     *
+     *  \param address Address, unicast or multicast.
+     *  \param port Port.
+     *  \param periodUsec Send period in microseconds; 0 sends every time.
+     *  \param mask Fields to send; see stateFieldMask().
+     *  \param encoding Encoding; by default the fields as they are.
+     *  \return False if the address is not IPv4.
+     */
+    bool set(const QHostAddress &address, quint16 port, quint32 periodUsec,
+        quint32 mask,
+        const DestinationEncoding &encoding = DestinationEncoding());
+
+    //! Remove a destination.
+    /*!
+     *  \return False if there is no destination at the address and port.
+     */
+    bool remove(const QHostAddress &address, quint16 port);
+
+    //! Send the state data to every destination that is due.
+    /*!
+     *  A destination is due once its period has passed since its last send,
+     *  less the slack, which lets periodic sends that run a little late or
+     *  early keep to the destination rate.
+     *
+     *  \param state State data.
+     *  \param nowNs Monotonic time, nanoseconds.
+     *  \param slackNs Slack, nanoseconds.
+     *  \param failed Set to the number of datagrams that failed to send.
+     *  \return Number of datagrams sent, parity packets included.
+     */
+    quint32 send(const TelemetryState &state, quint64 nowNs, quint64 slackNs,
+        quint32 &failed);
+
+    //! Return the number of destinations.
+    quint32 size(void) const { return targets.size(); };
+
+    //! Return the record size of a destination, bytes.
+    /*!
+     *  This is the datagram size, or the decoded size for delta encoding.
+     */
+    quint32 packetSize(quint32 i) const { return targets[i].size; };
+
+    //! Return the send statistics of a destination.
+    DestinationStats stats(quint32 i) const { return targets[i].stats; };
+
+private:
+    //! A destination and the runs of fields it is sent.
+    struct Target
+    {
+        //! Socket address.
+        struct sockaddr_in addr;
+        //! Send period, nanoseconds.
+        quint64 periodNs{0};
+        //! Time of the next send, nanoseconds.
+        quint64 nextNs{0};
+        //! Sequence number of the next datagram.
+        quint32 sequence{0};
+        //! Datagram size, bytes.
+        quint32 size{0};
+        //! Gather table, the last entry being the sequence number.
+        std::vector<struct iovec> iovs;
+        //! TelemetryState offset of each run of fields.
+        std::vector<quint32> offsets;
+        //! Fields sent.
+        quint32 mask{0};
+        //! Encoding.
+        DestinationEncoding encoding;
+        //! Delta encoder, or null to send the fields as they are.
+        std::unique_ptr<DeltaEncoder> encoder;
+        //! Forward error correction encoder, or null for none.
+        std::unique_ptr<FecEncoder> fec;
+        //! Packed record and encoded datagrams, for delta encoding and
+        //! forward error correction.
+        std::vector<quint8> record, packet, fecPacket;
+        //! Gather entry of the encoded datagram.
+        struct iovec packetIov;
+        //! Gather entries of the parity packets.
+        std::vector<struct iovec> parityIovs;
+        //! Send statistics.
+        DestinationStats stats;
+    };
+
+    //! Return the index of the destination at an address and port.
+    /*!
+     *  \return Index, or size() if there is none.
+     */
+    quint32 find(const struct sockaddr_in &addr) const;
+
+    //! Size the batch for the most datagrams a send can have.
+    void resizeBatch(void);
+
+    //! Add a datagram to the batch.
+    /*!
+     *  \param t Index of the destination.
+     *  \param iov Gather table.
+     *  \param iovlen Gather table entries.
+     *  \param parity Flag to indicate a parity packet.
+     */
+    void addMessage(quint32 t, struct iovec *iov, size_t iovlen,
+        bool parity);
+
+    //! UDP socket.
+    int fd{-1};
+
+    //! Destinations.
+    std::vector<Target> targets;
+
+    //! Datagrams of a send.
+    std::vector<struct mmsghdr> msgs;
+
+    //! Destination of each datagram of a send.
+    std::vector<quint32> msgTargets;
+
+    //! Flag for each datagram of a send that is a parity packet.
+    std::vector<bool> msgParity;
+
+    //! Datagrams in the batch.
+    quint32 count{0};
+};
+
+
+};  // namespace dfti
@@ -23,12 +23,32 @@ namespace dfti {
 Server::Server(Settings *_settings, QObject* _parent)
 : settings(_settings), QObject(_parent)
 {
-    // Create UDP socket.
-    socket = new QUdpSocket(this);
+    // Open the socket to the destinations.
+    fanout.open(settings->serverMulticastTTL(),
+        settings->serverMulticastInterface());
+    for (const ServerDestination &dest : settings->serverDestinations()) {
+        QStringList unknown;
+        const quint32 mask = stateFieldMask(dest.fields, unknown);
+        if (!unknown.isEmpty()) {
+            qWarning() << "[WARN ]  unknown state data fields" << unknown
+                       << "- ignoring them";
+        }
+        if (!fanout.set(dest.address, dest.port, dest.periodUsec, mask,
+                encoding(dest.delta, dest.fec))) {
+            qWarning() << "[WARN ]  server destination" << dest.address
+                       << "is not IPv4 - ignoring";
+        } else if (settings->debugRC()) {
+            qDebug() << "Server: destination" << dest.address << dest.port
+                     << "format" << stateFieldsFormat(mask)
+                     << (dest.delta ? "delta" : "raw")
+                     << (dest.fec ? "fec" : "");
+        }
+    }
 
-    // Get address and port from settings.
-    address = settings->serverAddress();
-    port = settings->serverPort();
+    mode = settings->serverMode();
+    if (mode == ServerMode::EVENT) {
+        vn200Wakeup = new Wakeup(this);
+    }
 }
 
 
@@ -42,42 +62,102 @@ Server::~Server()
 void
 Server::start(void)
 {
-    writeTimer = new QTimer(this);
-    connect(QTIMERPTR(writeTimer), &QTimer::timeout, this, &Server::writeData);
-    writeTimer->start(settings->sendRateMs());
+    // Created here to live in the server thread.
+    const quint16 subscribePort = settings->serverSubscribePort();
+    if (subscribePort) {
+        subscribeSocket = new QUdpSocket(this);
+        if (subscribeSocket->bind(QHostAddress::AnyIPv4, subscribePort)) {
+            connect(QUDPSOCKETPTR(subscribeSocket), &QUdpSocket::readyRead,
+                this, &Server::readSubscriptions);
+        } else {
+            qWarning() << "[WARN ]  server cannot listen for subscriptions"
+                       << "on port" << subscribePort << ":"
+                       << subscribeSocket->errorString();
+        }
+    }
+
+    if (mode == ServerMode::EVENT) {
+        if (haveVN200 && vn200Wakeup->watch()) {
+            connect(WAKEUPPTR(vn200Wakeup), &Wakeup::woken, this,
+                &Server::vn200Arrived);
+            if (settings->serverCoalesceUsec()) {
+                coalesceScheduler = new Scheduler(this);
+                connect(SCHEDPTR(coalesceScheduler), &Scheduler::tick, this,
+                    &Server::writeData);
+            }
+            return;
+        }
+        qWarning() << "[WARN ]  server event mode needs the VN-200"
+                   << "- sending periodically";
+    }
+    writeScheduler = new Scheduler(this);
+    connect(SCHEDPTR(writeScheduler), &Scheduler::tick, this,
+        &Server::writeData);
+    writeScheduler->start(settings->sendPeriodUsec());
+}
+
+
+void
+Server::enableAutopilot(Autopilot *ap)
+{
+    ap->attachQueue(&apQueue);
 }
 
 
 void
 Server::enableRIO(RIO *rio)
 {
-    connect(rio, &RIO::measurementUpdate, this, &Server::getRIOData);
+    rio->attachQueue(&rioQueue);
 }
 
 
 void
 Server::enableUADC(uADC *adc)
 {
-    connect(adc, &uADC::measurementUpdate, this, &Server::getUADCData);
+    adc->attachQueue(&uadcQueue);
 }
 
 
 void
 Server::enableVN200(VN200 *ins)
 {
-    connect(ins, &VN200::measurementUpdate, this, &Server::getVN200Data);
+    ins->attachQueue(&vn200Queue, vn200Wakeup.data());
+    haveVN200 = true;
 }
 
 // ----------------------------------------------------------------------------
 // Public Slots
 // ----------------------------------------------------------------------------
+void
+Server::getAPData(APData data)
+{
+    const quint16 rcIn[] = {data.rcIn1, data.rcIn2, data.rcIn3, data.rcIn4,
+        data.rcIn5, data.rcIn6, data.rcIn7, data.rcIn8};
+    const quint16 rcOut[] = {data.rcOut1, data.rcOut2, data.rcOut3,
+        data.rcOut4, data.rcOut5, data.rcOut6, data.rcOut7, data.rcOut8};
+    state.rcInTime = data.rcInTime;
+    state.rcOutTime = data.rcOutTime;
+    memcpy(state.rcIn, rcIn, sizeof(rcIn));
+    memcpy(state.rcOut, rcOut, sizeof(rcOut));
+    state.apRxTimeNs = data.rxTimeNs;
+    if (settings->debugSerial()) {
+        qDebug() << "Server::getAPData";
+    }
+}
+
+
 void
 Server::getRIOData(RIOData data)
 {
-    quint8 size = data.values.size();
-    stateData.numRIOValues = size > STATE_DATA_SIZE ? STATE_DATA_SIZE : size;
-    for (quint8 i = 0; i < stateData.numRIOValues; ++i) {
-      stateData.rioValues[i] = data.values[i];
+    quint8 size = data.numValues;
+    state.base.numRIOValues = size > STATE_DATA_SIZE ? STATE_DATA_SIZE : size;
+    for (quint8 i = 0; i < state.base.numRIOValues; ++i) {
+      state.base.rioValues[i] = data.values[i];
+    }
+    state.base.rioRxTimeNs = data.rxTimeNs;
+    state.numAllRIOValues = size > rioMaxValues ? rioMaxValues : size;
+    for (quint8 i = 0; i < state.numAllRIOValues; ++i) {
+        state.allRIOValues[i] = data.values[i];
     }
     if (settings->debugSerial()) {
         qDebug() << "Server::getRIOData";
@@ -88,9 +168,13 @@ Server::getRIOData(RIOData data)
 void
 Server::getUADCData(uADCData data)
 {
-    stateData.iasMps = data.iasMps;
-    stateData.aoaDeg = data.aoaDeg;
-    stateData.aosDeg = data.aosDeg;
+    state.base.iasMps = data.iasMps;
+    state.base.aoaDeg = data.aoaDeg;
+    state.base.aosDeg = data.aosDeg;
+    state.base.adsRxTimeNs = data.rxTimeNs;
+    state.pressurePa[0] = data.ptPa;
+    state.pressurePa[1] = data.psPa;
+    state.pressureAltM = data.altM;
     if (settings->debugSerial()) {
         qDebug() << "Server::getuADCData";
     }
@@ -100,14 +184,19 @@ Server::getUADCData(uADCData data)
 void
 Server::getVN200Data(VN200Data data)
 {
-    stateData.gpsTimeNs = data.gpsTimeNs;
+    state.base.gpsTimeNs = data.gpsTimeNs;
+    for (quint8 i = 0; i < 3; ++i) {
+        state.base.eulerDeg[i] = data.eulerDeg[i];
+        state.base.quaternion[i] = data.quaternion[i];
+        state.base.angularRatesRPS[i] = data.angularRatesRPS[i];
+        state.base.accelMps2[i] = data.accelMps2[i];
+    }
+    state.base.quaternion[3] = data.quaternion[3];
+    state.base.insRxTimeNs = data.rxTimeNs;
     for (quint8 i = 0; i < 3; ++i) {
-        stateData.eulerDeg[i] = data.eulerDeg[i];
-        stateData.quaternion[i] = data.quaternion[i];
-        stateData.angularRatesRPS[i] = data.angularRatesRPS[i];
-        stateData.accelMps2[i] = data.accelMps2[i];
+        state.posDegDegM[i] = data.posDegDegM[i];
+        state.velNedMps[i] = data.velNedMps[i];
     }
-    stateData.quaternion[3] = data.quaternion[3];
     if (settings->debugSerial()) {
         qDebug() << "Server::getVN200Data";
     }
@@ -117,26 +206,291 @@ Server::getVN200Data(VN200Data data)
 void
 Server::writeData(void)
 {
-    // Create packet.
-    // TODO: do this in a safer C++ style.
-    const int len = sizeof(StateData);
-    char data[len];
-    memset(&data, 0, len);
-    memcpy(&data, &stateData, len);
+    // Pick up the latest measurements published since the last send.
+    sendPending = false;
+    const bool newINS = drainQueues();
+
+    // Periodic sends may run a little off their deadlines; allow half a
+    // period so destinations keep to their rates.
+    const quint64 nowNs = getMonotonicNsec();
+    const quint64 slackNs = (mode == ServerMode::PERIODIC) ?
+        500ull * settings->sendPeriodUsec() : 0;
+    quint32 failed = 0;
+    const quint32 sent = fanout.send(state, nowNs, slackNs, failed);
+    if (failed) {
+        m_stats.sendErrors += failed;
+        qDebug() << "Server:writeData: Error writing" << failed
+                 << "datagrams";
+    }
+    m_stats.datagrams += sent;
+    if (sent && newINS) {
+        recordLatency(getMonotonicNsec());
+    }
+    ++m_stats.sends;
+    if (nowNs >= nextExpiryNs) {
+        expireSubscriptions(nowNs);
+        nextExpiryNs = nowNs + nsecPerSec;
+    }
 
-    qint64 bytes = socket->writeDatagram(data, len, address, port);
-    if (bytes < 0) {
-        qDebug() << "Server:writeData: Error writing data:" << socket->error();
+    if (settings->debugSerial() && !(m_stats.sends % 1000)) {
+        qDebug() << "Server: datagrams" << m_stats.datagrams
+                 << "errors" << m_stats.sendErrors
+                 << "coalesced" << m_stats.coalesced
+                 << "mean latency us" << (m_stats.latencySamples ?
+                    1e-3 * m_stats.totalLatencyNs / m_stats.latencySamples :
+                    0.0)
+                 << "max latency us" << 1e-3 * m_stats.maxLatencyNs;
     }
+}
 
-    if (settings->debugSerial()) {
-        qDebug() << "Server:writeData";
+
+void
+Server::vn200Arrived(void)
+{
+    if (!coalesceScheduler) {
+        writeData();
+    } else if (!sendPending) {
+        sendPending = true;
+        coalesceScheduler->startOnce(settings->serverCoalesceUsec());
+    }
+}
+
+void
+Server::readSubscriptions(void)
+{
+    char buf[512];
+    QHostAddress address;
+    quint16 port = 0;
+    while (subscribeSocket->hasPendingDatagrams()) {
+        const qint64 len = subscribeSocket->readDatagram(buf, sizeof(buf),
+            &address, &port);
+        if (len < 0) {
+            continue;
+        }
+        // Requests from outside the allowed subnets get no reply, which
+        // would itself go to a possibly spoofed source.
+        if (!subscriptionAllowed(address)) {
+            if (settings->debugSerial()) {
+                qDebug() << "Server: ignoring subscription request from"
+                         << address << port;
+            }
+            continue;
+        }
+        // QString::SkipEmptyParts is deprecated from Qt 5.14.
+        QStringList words = QString::fromLatin1(buf, len).simplified()
+            .split(' ');
+        words.removeAll(QString());
+        const QByteArray reply = subscribe(words, address, port);
+        subscribeSocket->writeDatagram(reply, address, port);
     }
 }
 
 // ----------------------------------------------------------------------------
 //  Private functions
 // ----------------------------------------------------------------------------
+QByteArray
+Server::subscribe(const QStringList &words, const QHostAddress &address,
+    quint16 port)
+{
+    auto index = [&](void) -> int {
+        for (int i = 0; i < subscriptions.size(); ++i) {
+            if (subscriptions[i].address == address &&
+                    subscriptions[i].port == port) {
+                return i;
+            }
+        }
+        return -1;
+    };
+
+    if (words.size() == 1 && words[0] == "unsubscribe") {
+        const int i = index();
+        if (i >= 0) {
+            fanout.remove(address, port);
+            subscriptions.remove(i);
+        }
+        return "ok";
+    }
+    if (words.size() < 2 || words[0] != "subscribe") {
+        return "error usage: subscribe <rate_hz> [field...] [delta] [fec] | "
+            "unsubscribe";
+    }
+    bool ok = false;
+    const quint32 rateHz = words[1].toUInt(&ok);
+    if (!ok) {
+        return "error bad rate";
+    }
+    // Rates above the server's send rate would be sent at the send rate.
+    const quint32 periodUsec = qMax(1u, settings->sendPeriodUsec());
+    const quint32 maxRateHz = (1000000 + periodUsec / 2) / periodUsec;
+    if (rateHz > maxRateHz) {
+        return "error rate above " + QByteArray::number(maxRateHz);
+    }
+    QStringList fields = words.mid(2);
+    const bool delta = fields.removeAll("delta") > 0;
+    const bool fec = fields.removeAll("fec") > 0;
+    QStringList unknown;
+    const quint32 mask = stateFieldMask(fields, unknown);
+    if (!unknown.isEmpty()) {
+        return "error unknown fields " + unknown.join(' ').toLatin1();
+    }
+    // The fanout knows destinations by address and port only, so a
+    // subscription would replace a configured destination and then remove
+    // it when it lapsed.
+    if (configuredDestination(address, port)) {
+        return "error configured destination";
+    }
+    int i = index();
+    if (i < 0) {
+        if (subscriptions.size() >=
+                static_cast<int>(settings->serverMaxSubscribers())) {
+            return "error too many subscribers";
+        }
+        subscriptions.append(Subscription());
+        i = subscriptions.size() - 1;
+        subscriptions[i].address = address;
+        subscriptions[i].port = port;
+    }
+    const DestinationEncoding enc = encoding(delta, fec);
+    if (!fanout.set(address, port, rateHz ? hzToUsec(rateHz) : 0, mask,
+            enc)) {
+        subscriptions.remove(i);
+        return "error IPv4 only";
+    }
+    subscriptions[i].expiresNs = getMonotonicNsec() +
+        nsecPerSec * settings->serverSubscriptionTimeoutSec();
+    if (settings->debugSerial()) {
+        qDebug() << "Server: subscription from" << address << port
+                 << "at" << rateHz << "Hz, format" << stateFieldsFormat(mask)
+                 << (delta ? "delta" : "raw") << (fec ? "fec" : "");
+    }
+    QByteArray reply = "ok " + QByteArray::number(stateFieldsSize(mask)) +
+        " " + stateFieldsFormat(mask).toLatin1();
+    if (delta) {
+        reply += " delta " + QByteArray::number(enc.keyframeInterval);
+    }
+    if (fec) {
+        reply += " fec " + QByteArray::number(enc.fecData) + " " +
+            QByteArray::number(enc.fecParity);
+    }
+    return reply;
+}
+
+
+bool
+Server::subscriptionAllowed(const QHostAddress &address) const
+{
+    const QVector<QPair<QHostAddress, int>> allow =
+        settings->serverSubscribeAllow();
+    if (allow.isEmpty()) {
+        return true;
+    }
+    for (const auto &subnet : allow) {
+        if (address.isInSubnet(subnet)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool
+Server::configuredDestination(const QHostAddress &address, quint16 port)
+    const
+{
+    for (const ServerDestination &dest : settings->serverDestinations()) {
+        if (dest.port == port &&
+                dest.address.toIPv4Address() == address.toIPv4Address()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+DestinationEncoding
+Server::encoding(bool delta, bool fec) const
+{
+    DestinationEncoding enc;
+    if (delta) {
+        enc.keyframeInterval = settings->serverKeyframeInterval();
+    }
+    if (fec) {
+        enc.fecData = settings->serverFecDataPackets();
+        enc.fecParity = settings->serverFecParityPackets();
+    }
+    return enc;
+}
+
+
+void
+Server::expireSubscriptions(quint64 nowNs)
+{
+    for (int i = subscriptions.size() - 1; i >= 0; --i) {
+        if (nowNs < subscriptions[i].expiresNs) {
+            continue;
+        }
+        if (settings->debugSerial()) {
+            qDebug() << "Server: subscription from" << subscriptions[i].address
+                     << subscriptions[i].port << "expired";
+        }
+        fanout.remove(subscriptions[i].address, subscriptions[i].port);
+        subscriptions.remove(i);
+        ++m_stats.expired;
+    }
+}
+
+
+bool
+Server::drainQueues(void)
+{
+    APData ap;
+    if (apQueue.drain([&ap](const APData &d) { ap = d; })) {
+        getAPData(ap);
+    }
+    RIOData rio;
+    if (rioQueue.drain([&rio](const RIOData &d) { rio = d; })) {
+        getRIOData(rio);
+    }
+    uADCData adc;
+    if (uadcQueue.drain([&adc](const uADCData &d) { adc = d; })) {
+        getUADCData(adc);
+    }
+    VN200Data ins;
+    const quint32 insCount = vn200Queue.drain(
+        [&ins](const VN200Data &d) { ins = d; });
+    if (insCount) {
+        getVN200Data(ins);
+        m_stats.coalesced += insCount - 1;
+    }
+    quint32 total = apQueue.overflows() + rioQueue.overflows() +
+        uadcQueue.overflows() + vn200Queue.overflows();
+    if (total != overflows) {
+        qWarning() << "[WARN ]  server queue overflows: ap"
+                   << apQueue.overflows() << "rio" << rioQueue.overflows()
+                   << "uadc" << uadcQueue.overflows()
+                   << "vn200" << vn200Queue.overflows();
+        overflows = total;
+    }
+    const quint64 missed = writeScheduler ? writeScheduler->stats().missed : 0;
+    if (missed != missedTicks) {
+        qWarning() << "[WARN ]  server missed" << missed - missedTicks
+                   << "send ticks";
+        missedTicks = missed;
+    }
+    return insCount > 0;
+}
+
+
+void
+Server::recordLatency(quint64 sentNs)
+{
+    const quint64 latencyNs = sentNs > state.base.insRxTimeNs ?
+        sentNs - state.base.insRxTimeNs : 0;
+    ++m_stats.latencySamples;
+    m_stats.totalLatencyNs += latencyNs;
+    m_stats.maxLatencyNs = std::max(m_stats.maxLatencyNs, latencyNs);
+    ++m_stats.histogram[jitterBin(latencyNs)];
+}
 
 // ----------------------------------------------------------------------------
 //  Functions
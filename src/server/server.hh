@@ -22,76 +22,49 @@
 #include <QObject>
 #include <QPointer>
 #include <QProcess>
-#include <QTimer>
 #include <QUdpSocket>
+#include <QVector>
 // dfti
 #include "core/consts.hh"
 #include "core/qptrutil.hh"
+#include "autopilot/autopilot.hh"
 #include "rio/rio.hh"
+#include "server/fanout.hh"
+#include "server/statedata.hh"
 #include "settings/settings.hh"
 #include "uadc/uadc.hh"
+#include "util/scheduler.hh"
+#include "util/timeutil.hh"
 #include "util/util.hh"
+#include "util/wakeup.hh"
 #include "vn200/vn200.hh"
 
 
-#define STATE_DATA_SIZE 10
-
-
 namespace dfti {
 
 
-/*! \brief Structure to hold state data published.
- *
- *  For online system identification and similar use cases, we need the vehicle
- *  state data available. This data structure holds a minimum set of state data
- *  as a POD struct with 1 byte structure packing.
- *
- *  State data comes from the INS, ADS, and control effector RIOs. If these
- *  sensors are inactive values of zero are used.
- *
- *  The StateData structure is assumed to use the native byte order.
- *
- *  \note Since DFTI is designed such that the number of RIO values is
- *  variable, the StateData struct assumes that there are at most 10 values and
- *  preallocates a float array accordingly. An unsigned char is then used to
- *  indicate to the user how many of these values are actually used. Further, it
- *  is the user's responsibility to use these values correctly.
- *
- */
-#pragma pack(push, 1)  // change structure packing to 1 byte
-struct StateData
+//! Server send statistics.
+struct ServerStats
 {
-    //! INS GPS timestamp.
-    quint64 gpsTimeNs{0};
-
-    //! INS Euler angles.
-    float eulerDeg[3] = {0};
-
-    //! INS quaternion.
-    float quaternion[4] = {0};
-
-    //! INS angular rates.
-    float angularRatesRPS[3] = {0};
-
-    //! INS accelerations.
-    float accelMps2[3] = {0};
-
-    //! ADS indicated airspeed.
-    float iasMps{0};
-
-    //! ADS angle-of-attack.
-    float aoaDeg{0};
-
-    //! ADS sideslip angle.
-    float aosDeg{0};
-
-    //! Number of RIO values (up to 10).
-    quint8 numRIOValues{0};
-
-    //! RIO values.
-    float rioValues[STATE_DATA_SIZE] = {0};
+    //! Sends, each to every destination that is due.
+    quint64 sends{0};
+    //! Datagrams sent.
+    quint64 datagrams{0};
+    //! Datagrams that failed to send.
+    quint64 sendErrors{0};
+    //! VN-200 measurements superseded before they were sent.
+    quint64 coalesced{0};
+    //! Sends with a new VN-200 measurement, which the latency covers.
+    quint64 latencySamples{0};
+    //! Total VN-200 receive to send latency, nanoseconds.
+    quint64 totalLatencyNs{0};
+    //! Largest VN-200 receive to send latency, nanoseconds.
+    quint64 maxLatencyNs{0};
+    //! VN-200 receive to send latency histogram; see jitterBinUsec.
+    quint64 histogram[numJitterBins] = {0};
+    //! Subscriptions that expired without being renewed.
+    quint64 expired{0};
 };
-#pragma pack(pop)  // reset structure packing
 
 
 /*! \brief UDP server for vehicle state data.
@@ -101,17 +74,69 @@ struct StateData
  *  StateData structure at a user-specified rate. The data is sent to a
  *  user-specified IP address and port; these default to localhost and 2701.
  *
+ *  Alternatively <tt>destinations</tt> lists several destinations, unicast
+ *  or multicast, as
+ *  <tt>address:port[\@rate_hz][/field+field...][~delta][~fec]</tt>. Each
+ *  is sent at its own rate (by default the server rate) and only the listed
+ *  StateData fields or field groups (see stateFieldMask()), packed in
+ *  structure order and always followed by a sequence number of its own. A
+ *  Fanout sends all the datagrams of a send with one syscall. Destinations
+ *  with <tt>~delta</tt>, such as a telemetry radio, are sent the same
+ *  record delta encoded (see DeltaEncoder), with a keyframe every
+ *  <tt>keyframe_interval</tt> datagrams. Those with <tt>~fec</tt>, such as
+ *  a lossy radio bridge, are sent their datagrams in groups of
+ *  <tt>fec_data_packets</tt>, each followed by
+ *  <tt>fec_parity_packets</tt> parity packets (see FecEncoder), so that up
+ *  to that many lost packets per group are recovered on the ground without
+ *  retransmission.
+ *
+ *  With <tt>subscribe_port</tt> set, clients can also subscribe themselves
+ *  by sending a text datagram to that port:
+ *  \code
+ *  subscribe <rate_hz> [field...] [delta] [fec]
+ *  unsubscribe
+ *  \endcode
+ *  The fields are any of the TelemetryState fields and groups (see
+ *  stateFieldMask()), which include the position, velocity, pressures,
+ *  every RIO value and the autopilot RC channels that StateData has no room
+ *  for; a rate of 0 sends with every server send. The reply is either
+ *  <tt>ok \<size\> \<format\></tt>, giving the datagram size and its Python
+ *  struct format, or <tt>error \<reason\></tt>. With <tt>delta</tt> the
+ *  datagrams are delta encoded and the reply ends with
+ *  <tt>delta \<keyframe_interval\></tt>; the size and format are then those
+ *  of the decoded record. With <tt>fec</tt> they are sent in parity groups
+ *  and the reply ends with <tt>fec \<data_packets\> \<parity_packets\></tt>.
+ *  The datagrams are sent to the address and port the subscription came
+ *  from, and stop once the subscription has not been renewed for
+ *  <tt>subscription_timeout_sec</tt>, so clients re-send it periodically.
+ *  Rates above the server's send rate are refused, as are subscriptions
+ *  from the address and port of a configured destination, which the
+ *  subscription would replace. As a spoofed request can point a stream at
+ *  any address, the subscription port should only be reachable from a
+ *  trusted network; <tt>subscribe_allow</tt> lists the subnets requests are
+ *  answered from, as <tt>address[/prefix]</tt>.
+ *
+ *  With <tt>mode = event</tt> a datagram is instead sent as soon as each
+ *  VN-200 measurement arrives, which the VN-200 thread signals through a
+ *  Wakeup, so attitude reaches clients without waiting for the next send
+ *  period. With <tt>coalesce_usec</tt> set, the server waits that long
+ *  after a measurement and sends everything that arrived meanwhile in one
+ *  datagram. The latency from each VN-200 measurement being read to it
+ *  being sent is kept in ServerStats in either mode.
+ *
  *  The native byte order and 1-byte padding is used for the structure; no
  *  conversions are made to network byte order. The easiest way to receive the
  *  data is to bind a socket to the address and port and cast the bytes to the
- *  data structure; in C++ static_cast<StateData> should work.
+ *  data structure; in C++ static_cast<StateData> should work. For a
+ *  destination with a subset of the fields, stateFieldsFormat() gives the
+ *  Python struct format, which is printed with the rc file debug output.
  *
  *  For Python, code similar to the following may be used:
  *  \code{.py}
  *  import socket
  *  import struct
  *
- *  BUF_SIZE = 128  # Make sure this is larger than sizeof(StateData)!
+ *  BUF_SIZE = 256  # Make sure this is larger than sizeof(StateData)!
  *  SOCK_ADDR = "127.0.0.1"
  *  SOCK_PORT = 2701
  *
@@ -119,7 +144,7 @@ struct StateData
  *      sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
  *      sock.bind((SOCK_ADDR, SOCK_PORT))
  *
- *      fmt = '=QffffffffffffffffBffffffffff'
+ *      fmt = '=QffffffffffffffffBffffffffffQQQI'
  *      while True:
  *          data, _ = recvfrom(BUF_SIZE)
  *          unpacked_data = struct.unpack(fmt, data)
@@ -142,6 +167,12 @@ public:
     //! Dtor.
     ~Server();
 
+    //! Enable the autopilot.
+    /*!
+     * \param ap QPointer to Autopilot object.
+     */
+    void enableAutopilot(Autopilot *ap);
+
     //! Enable Micro Air Data Computer Sensor.
     /*!
      * \param adc QPointer to uADC object.
@@ -162,11 +193,21 @@ public:
 
     //! Start server.
     /*!
-     *  Connects QTimers to the writeData slot.
+     *  Connects a Scheduler to the writeData slot at the send rate, or in
+     *  event mode the VN-200 wakeup.
      */
     void start(void);
 
+    //! Return the send statistics.
+    /*!
+     *  \remark Call from the server thread.
+     */
+    ServerStats stats(void) const { return m_stats; };
+
 public slots:
+    //! Slot to receive data from the autopilot.
+    void getAPData(APData data);
+
     //! Slot to receive data from the RIO.
     void getRIOData(RIOData data);
 
@@ -179,24 +220,134 @@ public slots:
     //! Slot to write data.
     void writeData(void);
 
+private slots:
+    //! Send, or schedule a send, for newly arrived VN-200 measurements.
+    void vn200Arrived(void);
+
+    //! Read and answer subscription requests.
+    void readSubscriptions(void);
+
 private:
+    //! A client that subscribed itself.
+    struct Subscription
+    {
+        //! Client address.
+        QHostAddress address;
+        //! Client port.
+        quint16 port{0};
+        //! Monotonic time the subscription expires, nanoseconds.
+        quint64 expiresNs{0};
+    };
+
+    //! Handle a subscription request.
+    /*!
+     *  \param words Words of the request.
+     *  \param address Client address.
+     *  \param port Client port.
+     *  \return Reply.
+     */
+    QByteArray subscribe(const QStringList &words,
+        const QHostAddress &address, quint16 port);
+
+    //! Return a destination encoding from the [server] settings.
+    /*!
+     *  \param delta Flag to delta encode.
+     *  \param fec Flag to add forward error correction.
+     *  \return Encoding.
+     */
+    DestinationEncoding encoding(bool delta, bool fec) const;
+
+    //! Check whether subscriptions are accepted from an address.
+    /*!
+     *  \param address Client address.
+     *  \return True if subscribe_allow is empty or has the address.
+     */
+    bool subscriptionAllowed(const QHostAddress &address) const;
+
+    //! Check whether an address and port is a configured destination.
+    /*!
+     *  \param address Client address.
+     *  \param port Client port.
+     *  \return True if <tt>destinations</tt>, or the server address and
+     *      port, has it.
+     */
+    bool configuredDestination(const QHostAddress &address, quint16 port)
+        const;
+
+    //! Remove the subscriptions that were not renewed in time.
+    /*!
+     *  \param nowNs Monotonic time, nanoseconds.
+     */
+    void expireSubscriptions(quint64 nowNs);
+
+    //! Drain the sensor queues into the state data.
+    /*!
+     *  \return True if a new VN-200 measurement was drained.
+     */
+    bool drainQueues(void);
+
+    //! Record the latency of a datagram carrying a new VN-200 measurement.
+    /*!
+     *  \param sentNs Monotonic time the datagram was sent, nanoseconds.
+     */
+    void recordLatency(quint64 sentNs);
+
     //! Pointer to settings object.
     QPointer<Settings> settings{nullptr};
 
-    //! UDP socket.
-    QPointer<QUdpSocket> socket{nullptr};
+    //! Sender to the destinations.
+    Fanout fanout;
+
+    //! Socket subscription requests arrive on.
+    QPointer<QUdpSocket> subscribeSocket{nullptr};
+
+    //! Current subscriptions.
+    QVector<Subscription> subscriptions;
+
+    //! Monotonic time to next look for expired subscriptions, nanoseconds.
+    quint64 nextExpiryNs{0};
+
+    //! Scheduler for writing.
+    QPointer<Scheduler> writeScheduler{nullptr};
+
+    //! Send mode.
+    ServerMode mode{ServerMode::PERIODIC};
+
+    //! Wakes the server for each VN-200 measurement in event mode.
+    QPointer<Wakeup> vn200Wakeup{nullptr};
+
+    //! Single shot timer for the coalescing window, if one is set.
+    QPointer<Scheduler> coalesceScheduler{nullptr};
+
+    //! Flag to indicate a coalesced send is scheduled.
+    bool sendPending{false};
+
+    //! Flag to indicate the VN-200 is enabled.
+    bool haveVN200{false};
+
+    //! Autopilot measurement queue.
+    Autopilot::Queue apQueue;
+
+    //! RIO measurement queue.
+    RIO::Queue rioQueue;
+
+    //! uADC measurement queue.
+    uADC::Queue uadcQueue;
+
+    //! VN-200 measurement queue.
+    VN200::Queue vn200Queue;
 
-    //! UDP server address, default localhost.
-    QHostAddress address{QHostAddress::LocalHost};
+    //! Total queue overflows at the last report.
+    quint32 overflows{0};
 
-    //! UDP port, default 2701.
-    quint16 port{2701};
+    //! Missed send ticks at the last report.
+    quint64 missedTicks{0};
 
-    //! QTimer for writing.
-    QPointer<QTimer> writeTimer{nullptr};
+    //! Send statistics.
+    ServerStats m_stats;
 
     //! Server state data structure.
-    StateData stateData;
+    TelemetryState state;
 };
 
 
@@ -0,0 +1,254 @@
+/*!
+ *  \file statedata.cc
+ *  \brief Vehicle state data field table implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "statedata.hh"
+
+
+namespace dfti {
+
+
+//! Table entry for a StateData member.
+#define STATE_FIELD(name, member, format, quantum) \
+    {name, offsetof(TelemetryState, base) + offsetof(StateData, member), \
+        sizeof(StateData::member), format, quantum}
+
+//! Table entry for the TelemetryState members from first to last.
+#define TELEMETRY_FIELDS(name, first, last, format, quantum) \
+    {name, offsetof(TelemetryState, first), offsetof(TelemetryState, last) + \
+        sizeof(TelemetryState::last) - offsetof(TelemetryState, first), \
+        format, quantum}
+
+
+// Quanta are about the sensors' resolution: times to the microsecond,
+// positions to the centimetre.
+const StateField stateFields[numStateFields] = {
+    STATE_FIELD("gps_time", gpsTimeNs, "Q", 1000),
+    STATE_FIELD("euler", eulerDeg, "fff", 0.01),
+    STATE_FIELD("quaternion", quaternion, "ffff", 1e-5),
+    STATE_FIELD("rates", angularRatesRPS, "fff", 1e-4),
+    STATE_FIELD("accel", accelMps2, "fff", 1e-3),
+    STATE_FIELD("ias", iasMps, "f", 0.01),
+    STATE_FIELD("aoa", aoaDeg, "f", 0.01),
+    STATE_FIELD("aos", aosDeg, "f", 0.01),
+    // The count and values of the RIO are one field.
+    {"rio_values",
+        offsetof(TelemetryState, base) + offsetof(StateData, numRIOValues),
+        sizeof(StateData::numRIOValues) + sizeof(StateData::rioValues),
+        "Bffffffffff", 1e-4},
+    STATE_FIELD("ins_rx_time", insRxTimeNs, "Q", 1000),
+    STATE_FIELD("ads_rx_time", adsRxTimeNs, "Q", 1000),
+    STATE_FIELD("rio_rx_time", rioRxTimeNs, "Q", 1000),
+    STATE_FIELD("sequence", sequence, "I", 1),
+    TELEMETRY_FIELDS("position", posDegDegM, posDegDegM, "ddd", 1e-7),
+    TELEMETRY_FIELDS("velocity", velNedMps, velNedMps, "fff", 0.01),
+    TELEMETRY_FIELDS("pressure", pressurePa, pressurePa, "II", 1),
+    TELEMETRY_FIELDS("pressure_alt", pressureAltM, pressureAltM, "H", 1),
+    TELEMETRY_FIELDS("rio_all", numAllRIOValues, allRIOValues,
+        "Bffffffffffffffff", 1e-4),
+    TELEMETRY_FIELDS("rc_in", rcInTime, rcIn, "IHHHHHHHH", 1),
+    TELEMETRY_FIELDS("rc_out", rcOutTime, rcOut, "IHHHHHHHH", 1),
+    TELEMETRY_FIELDS("ap_rx_time", apRxTimeNs, apRxTimeNs, "Q", 1000)
+};
+#undef STATE_FIELD
+#undef TELEMETRY_FIELDS
+
+
+//! A group of fields, which can be named in place of its fields.
+struct StateFieldGroup
+{
+    //! Name.
+    const char *name;
+    //! Field names, ending with nullptr.
+    const char *fields[8];
+};
+
+
+//! Groups of fields, by sensor.
+static const StateFieldGroup stateFieldGroups[] = {
+    {"ins", {"gps_time", "euler", "quaternion", "rates", "accel", "position",
+        "velocity", "ins_rx_time"}},
+    {"ads", {"ias", "aoa", "aos", "pressure", "pressure_alt", "ads_rx_time",
+        nullptr}},
+    {"rio", {"rio_all", "rio_rx_time", nullptr}},
+    {"ap", {"rc_in", "rc_out", "ap_rx_time", nullptr}}
+};
+
+
+//! Return the index of a field in the state field table.
+/*!
+ *  \param name Field name.
+ *  \return Index, or numStateFields if there is no such field.
+ */
+static quint32
+stateFieldIndex(const QString &name)
+{
+    quint32 i = 0;
+    while (i < numStateFields && name != stateFields[i].name) {
+        ++i;
+    }
+    return i;
+}
+
+//! Return the size of a delta codec channel type, bytes.
+static inline quint32
+channelSize(ChannelType type)
+{
+    switch (type) {
+        case ChannelType::U8:
+            return 1;
+        case ChannelType::U16:
+            return 2;
+        case ChannelType::U32:
+        case ChannelType::F32:
+            return 4;
+        default:
+            return 8;
+    }
+}
+
+
+//! Return the field packed i-th: the table order, but the sequence last.
+static inline quint32
+stateFieldOrder(quint32 i)
+{
+    if (i < stateFieldSequence) {
+        return i;
+    }
+    return (i == numStateFields - 1) ? stateFieldSequence : i + 1;
+}
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+quint32
+stateFieldMask(const QStringList &names, QStringList &unknown)
+{
+    unknown.clear();
+    if (names.isEmpty()) {
+        return allStateFields;
+    }
+    quint32 mask = 1u << stateFieldSequence;
+    for (const QString &name : names) {
+        if (name == "all") {
+            mask |= allStateFields;
+            continue;
+        }
+        const quint32 i = stateFieldIndex(name);
+        if (i < numStateFields) {
+            mask |= 1u << i;
+            continue;
+        }
+        bool found = false;
+        for (const StateFieldGroup &group : stateFieldGroups) {
+            if (name != group.name) {
+                continue;
+            }
+            for (quint32 j = 0; j < 8 && group.fields[j]; ++j) {
+                mask |= 1u << stateFieldIndex(group.fields[j]);
+            }
+            found = true;
+        }
+        if (!found) {
+            unknown.append(name);
+        }
+    }
+    return mask;
+}
+
+
+quint32
+stateFieldsSize(quint32 mask)
+{
+    quint32 size = 0;
+    for (quint32 i = 0; i < numStateFields; ++i) {
+        if (mask & (1u << i)) {
+            size += stateFields[i].size;
+        }
+    }
+    return size;
+}
+
+
+QString
+stateFieldsFormat(quint32 mask)
+{
+    QString format("=");
+    for (quint32 i = 0; i < numStateFields; ++i) {
+        const quint32 field = stateFieldOrder(i);
+        if (mask & (1u << field)) {
+            format += stateFields[field].format;
+        }
+    }
+    return format;
+}
+
+
+std::vector<DeltaChannel>
+stateFieldChannels(quint32 mask)
+{
+    std::vector<DeltaChannel> channels;
+    quint32 offset = 0;
+    for (quint32 i = 0; i < numStateFields; ++i) {
+        const StateField &field = stateFields[stateFieldOrder(i)];
+        if (!(mask & (1u << stateFieldOrder(i)))) {
+            continue;
+        }
+        for (const char *c = field.format; *c; ++c) {
+            DeltaChannel channel;
+            channel.offset = offset;
+            channel.quantum = field.quantum;
+            switch (*c) {
+                case 'B':
+                    channel.type = ChannelType::U8;
+                    break;
+                case 'H':
+                    channel.type = ChannelType::U16;
+                    break;
+                case 'I':
+                    channel.type = ChannelType::U32;
+                    break;
+                case 'Q':
+                    channel.type = ChannelType::U64;
+                    break;
+                case 'f':
+                    channel.type = ChannelType::F32;
+                    break;
+                default:
+                    channel.type = ChannelType::F64;
+                    break;
+            }
+            offset += channelSize(channel.type);
+            channels.push_back(channel);
+        }
+    }
+    return channels;
+}
+
+
+quint32
+packStateFields(const TelemetryState &state, quint32 mask, char *out)
+{
+    const char *base = reinterpret_cast<const char *>(&state);
+    quint32 len = 0;
+    for (quint32 i = 0; i < numStateFields; ++i) {
+        const StateField &field = stateFields[stateFieldOrder(i)];
+        if (mask & (1u << stateFieldOrder(i))) {
+            memcpy(out + len, base + field.offset, field.size);
+            len += field.size;
+        }
+    }
+    return len;
+}
+
+
+};  // namespace dfti
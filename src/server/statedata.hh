@@ -0,0 +1,231 @@
+/*!
+ *  \file statedata.hh
+ *  \brief Vehicle state data sent by the server.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cstddef>
+#include <cstring>
+// 3rd party
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+// dfti
+#include "rio/rio.hh"
+#include "telemetry/deltacodec.hh"
+
+
+//! Number of RIO values in the state data.
+#define STATE_DATA_SIZE 10
+
+
+namespace dfti {
+
+
+/*! \brief Structure to hold state data published.
+ *
+ *  For online system identification and similar use cases, we need the vehicle
+ *  state data available. This data structure holds a minimum set of state data
+ *  as a POD struct with 1 byte structure packing.
+ *
+ *  State data comes from the INS, ADS, and control effector RIOs. If these
+ *  sensors are inactive values of zero are used. Each sensor's data is
+ *  followed at the end of the structure by the host monotonic time it was
+ *  received (CLOCK_MONOTONIC, nanoseconds), which a client on the same
+ *  computer can compare against its own clock_gettime(CLOCK_MONOTONIC).
+ *  Last is a sequence number, incremented for every datagram, so clients
+ *  can count lost datagrams.
+ *
+ *  The StateData structure is assumed to use the native byte order.
+ *
+ *  \note Since DFTI is designed such that the number of RIO values is
+ *  variable, the StateData struct assumes that there are at most 10 values and
+ *  preallocates a float array accordingly. An unsigned char is then used to
+ *  indicate to the user how many of these values are actually used. Further, it
+ *  is the user's responsibility to use these values correctly.
+ *
+ */
+#pragma pack(push, 1)  // change structure packing to 1 byte
+struct StateData
+{
+    //! INS GPS timestamp.
+    quint64 gpsTimeNs{0};
+
+    //! INS Euler angles.
+    float eulerDeg[3] = {0};
+
+    //! INS quaternion.
+    float quaternion[4] = {0};
+
+    //! INS angular rates.
+    float angularRatesRPS[3] = {0};
+
+    //! INS accelerations.
+    float accelMps2[3] = {0};
+
+    //! ADS indicated airspeed.
+    float iasMps{0};
+
+    //! ADS angle-of-attack.
+    float aoaDeg{0};
+
+    //! ADS sideslip angle.
+    float aosDeg{0};
+
+    //! Number of RIO values (up to 10).
+    quint8 numRIOValues{0};
+
+    //! RIO values.
+    float rioValues[STATE_DATA_SIZE] = {0};
+
+    //! INS monotonic receive time, nanoseconds.
+    quint64 insRxTimeNs{0};
+
+    //! ADS monotonic receive time, nanoseconds.
+    quint64 adsRxTimeNs{0};
+
+    //! RIO monotonic receive time, nanoseconds.
+    quint64 rioRxTimeNs{0};
+
+    //! Datagram sequence number.
+    quint32 sequence{0};
+};
+
+
+/*! \brief Everything the server can send.
+ *
+ *  The StateData sent by default, followed by the measurements it has no
+ *  room for, so that clients can pick them from the state field table.
+ */
+struct TelemetryState
+{
+    //! State data.
+    StateData base;
+
+    //! INS latitude, longitude (degrees) and altitude (m).
+    double posDegDegM[3] = {0};
+
+    //! INS NED velocity, m/s.
+    float velNedMps[3] = {0};
+
+    //! ADS total and static pressure, Pa.
+    quint32 pressurePa[2] = {0};
+
+    //! ADS pressure altitude, m.
+    quint16 pressureAltM{0};
+
+    //! Number of RIO values (up to rioMaxValues).
+    quint8 numAllRIOValues{0};
+
+    //! RIO values, without the StateData limit.
+    float allRIOValues[rioMaxValues] = {0};
+
+    //! Autopilot RC input timestamp.
+    quint32 rcInTime{0};
+
+    //! Autopilot RC input channels 1 to 8, PPM.
+    quint16 rcIn[8] = {0};
+
+    //! Autopilot RC output timestamp.
+    quint32 rcOutTime{0};
+
+    //! Autopilot RC output channels 1 to 8, PPM.
+    quint16 rcOut[8] = {0};
+
+    //! Autopilot monotonic receive time, nanoseconds.
+    quint64 apRxTimeNs{0};
+};
+#pragma pack(pop)  // reset structure packing
+
+
+//! A field of TelemetryState that can be sent without the others.
+struct StateField
+{
+    //! Name used in the rc file and subscriptions.
+    const char *name;
+    //! Byte offset in TelemetryState.
+    quint32 offset;
+    //! Size in bytes.
+    quint32 size;
+    //! Python struct format of the field.
+    const char *format;
+    //! Delta encoding quantization step, in the field's units.
+    double quantum;
+};
+
+
+//! Number of fields in the state field table.
+const quint32 numStateFields = 21;
+
+//! Index of the sequence number, which every packet ends with.
+const quint32 stateFieldSequence = 12;
+
+//! Field mask of StateData, the first fields of the table.
+const quint32 allStateFields = (1u << (stateFieldSequence + 1)) - 1;
+
+//! Table of the TelemetryState fields, in structure order.
+extern const StateField stateFields[numStateFields];
+
+
+//! Convert a list of field and group names to a field mask.
+/*!
+ *  Names are those of the state field table, or one of the groups
+ *  <tt>ins</tt>, <tt>ads</tt>, <tt>rio</tt> and <tt>ap</tt> (each sensor's
+ *  fields and receive time) or <tt>all</tt> (the StateData fields). The
+ *  sequence number is always included, and an empty list selects StateData.
+ *
+ *  \param names Field and group names.
+ *  \param unknown Set to the names that were not recognized.
+ *  \return Field mask, bit i set for stateFields[i].
+ */
+quint32 stateFieldMask(const QStringList &names, QStringList &unknown);
+
+
+//! Return the packed size of the fields in a mask, bytes.
+quint32 stateFieldsSize(quint32 mask);
+
+
+//! Return the Python struct format of the fields in a mask.
+/*!
+ *  \param mask Field mask.
+ *  \return Format, starting with '=' for native byte order and no padding.
+ */
+QString stateFieldsFormat(quint32 mask);
+
+
+//! Return the delta codec channels of the fields in a mask.
+/*!
+ *  The channels are those of the record packStateFields() writes, one per
+ *  number of the fields' formats.
+ *
+ *  \param mask Field mask.
+ *  \return Channels.
+ */
+std::vector<DeltaChannel> stateFieldChannels(quint32 mask);
+
+
+//! Pack the fields in a mask in structure order.
+/*!
+ *  The sequence number is packed last.
+ *
+ *  \param state State data.
+ *  \param mask Field mask.
+ *  \param out Buffer of at least stateFieldsSize(mask) bytes.
+ *  \return Bytes written.
+ */
+quint32 packStateFields(const TelemetryState &state, quint32 mask,
+    char *out);
+
+
+};  // namespace dfti
@@ -87,17 +87,73 @@ Settings::loadRCFile(QString _fn)
     m_useRIO = m_settings->value("use_rio", false).toBool();
     m_useUADC = m_settings->value("use_uadc", false).toBool();
     m_useVN200 = m_settings->value("use_vn200", false).toBool();
-    quint16 logRateHz = m_settings->value("log_rate_hz", 100).toInt();
-    m_logRateMs = hzToMsec(logRateHz);
-    quint16 flushTimeSec = m_settings->value("flush_time_sec", 10).toInt();
+    // The scheduler keeps microsecond periods, but past a few kHz the log
+    // thread cannot keep up.
+    const quint32 maxLogRateHz = 10000;
+    quint32 logRateHz = m_settings->value("log_rate_hz", 100).toUInt();
+    if (logRateHz < 1 || logRateHz > maxLogRateHz) {
+        qWarning() << "[WARN ]  log_rate_hz must be between 1 and"
+                   << maxLogRateHz << "- using 100";
+        logRateHz = 100;
+    }
+    m_logPeriodUsec = hzToUsec(logRateHz);
+    quint32 flushTimeSec = m_settings->value("flush_time_sec", 10).toUInt();
     m_flushRateMs = secToMsec(flushTimeSec);
     m_waitForAllSensors = m_settings->value("wait_for_all_sensors",
         false).toBool();
     m_waitForUpdate = m_settings->value("wait_for_update", true).toBool();
+    m_captureRaw = m_settings->value("capture_raw", false).toBool();
+    QString logFormat = m_settings->value("log_format", "csv").toString();
+    if (logFormat == "binary") {
+        m_logFormat = LogFormat::BINARY;
+    } else {
+        if (logFormat != "csv") {
+            qWarning() << "[WARN ]  unknown log_format" << logFormat
+                       << "- using csv";
+        }
+        m_logFormat = LogFormat::CSV;
+    }
+    QString logMode = m_settings->value("log_mode",
+        "sample_hold").toString();
+    if (logMode == "every_sample") {
+        m_logMode = LogMode::EVERY_SAMPLE;
+    } else {
+        if (logMode != "sample_hold") {
+            qWarning() << "[WARN ]  unknown log_mode" << logMode
+                       << "- using sample_hold";
+        }
+        m_logMode = LogMode::SAMPLE_HOLD;
+    }
+    QString threading = m_settings->value("threading",
+        "sensor_threads").toString();
+    if (threading == "reactor") {
+        m_threadMode = ThreadMode::REACTOR;
+    } else {
+        if (threading != "sensor_threads") {
+            qWarning() << "[WARN ]  unknown threading" << threading
+                       << "- using sensor_threads";
+        }
+        m_threadMode = ThreadMode::SENSOR_THREADS;
+    }
+    QString serialBackend = m_settings->value("serial_backend",
+        "qt").toString();
+    if (serialBackend == "termios") {
+        m_serialBackend = SerialBackend::TERMIOS;
+    } else {
+        if (serialBackend != "qt") {
+            qWarning() << "[WARN ]  unknown serial_backend" << serialBackend
+                       << "- using qt";
+        }
+        m_serialBackend = SerialBackend::QT;
+    }
     m_settings->endGroup();
     if (debugRC()) {
         qDebug() << "Loaded [dfti] settings group:";
         qDebug() << "\tlog_rate_hz:           " << logRateHz;
+        qDebug() << "\tlog_format:            " << logFormat;
+        qDebug() << "\tlog_mode:              " << logMode;
+        qDebug() << "\tthreading:             " << threading;
+        qDebug() << "\tserial_backend:        " << serialBackend;
         qDebug() << "\tflush_time_sec:        " << flushTimeSec;
         qDebug() << "\tset_system_time:       " << m_setSystemTime;
         qDebug() << "\tuse_mavlink:           " << m_useMavlink;
@@ -106,6 +162,7 @@ Settings::loadRCFile(QString _fn)
         qDebug() << "\tuse_vn200:             " << m_useVN200;
         qDebug() << "\twait_for_all_sensors:  " << m_waitForAllSensors;
         qDebug() << "\twait_for_update:       " << m_waitForUpdate;
+        qDebug() << "\tcapture_raw:           " << m_captureRaw;
     }
 
     // Server parameters.
@@ -116,11 +173,140 @@ Settings::loadRCFile(QString _fn)
     m_serverPort = static_cast<quint16>(m_settings->value("port",
         2701).toInt());
     // Get the server rate and make it at most 1/2 of the log rate.
-    quint8 serverRateHz = m_settings->value("rate_hz", 50).toInt();
+    quint32 serverRateHz = m_settings->value("rate_hz", 50).toUInt();
     if (2 * serverRateHz > logRateHz) {
-        serverRateHz = static_cast<quint8>(0.5 * logRateHz);
+        serverRateHz = logRateHz / 2;
+    }
+    if (serverRateHz < 1) {
+        serverRateHz = 1;
     }
-    m_sendRateMs = hzToMsec(serverRateHz);
+    QString serverMode = m_settings->value("mode", "periodic").toString();
+    if (serverMode == "event") {
+        m_serverMode = ServerMode::EVENT;
+    } else {
+        if (serverMode != "periodic") {
+            qWarning() << "[WARN ]  unknown server mode" << serverMode
+                       << "- using periodic";
+        }
+        m_serverMode = ServerMode::PERIODIC;
+    }
+    // Destinations are
+    // "address:port[@rate_hz][/field+field...][~delta][~fec]". Those
+    // without a rate are sent at the server rate, or in event mode with
+    // every VN-200 measurement, and the server runs at the fastest rate.
+    quint32 fastestHz = serverRateHz;
+    m_serverDestinations.clear();
+    QStringList destinations = m_settings->value("destinations",
+        QStringList()).toStringList();
+    for (const QString &entry : destinations) {
+        ServerDestination dest;
+        QString spec = entry.trimmed();
+        bool encodingOk = true;
+        const int tilde = spec.indexOf('~');
+        if (tilde >= 0) {
+            for (const QString &option : spec.mid(tilde + 1).split('~')) {
+                if (option == "delta") {
+                    dest.delta = true;
+                } else if (option == "fec") {
+                    dest.fec = true;
+                } else {
+                    encodingOk = false;
+                }
+            }
+            spec.truncate(tilde);
+        }
+        const int slash = spec.indexOf('/');
+        if (slash >= 0) {
+            // QString::SkipEmptyParts is deprecated from Qt 5.14.
+            dest.fields = spec.mid(slash + 1).split('+');
+            dest.fields.removeAll(QString());
+            spec.truncate(slash);
+        }
+        bool rateOk = true;
+        quint32 rateHz = 0;
+        const int at = spec.indexOf('@');
+        if (at >= 0) {
+            rateHz = spec.mid(at + 1).toUInt(&rateOk);
+            spec.truncate(at);
+        }
+        bool portOk = false;
+        const int colon = spec.lastIndexOf(':');
+        if (colon > 0) {
+            dest.port = spec.mid(colon + 1).toUShort(&portOk);
+            dest.address = QHostAddress(spec.left(colon));
+        }
+        if (!encodingOk || !rateOk || !portOk || !dest.port ||
+            dest.address.isNull()) {
+            qWarning() << "[WARN ]  invalid server destination" << entry
+                       << "- ignoring";
+            continue;
+        }
+        if (at >= 0) {
+            rateHz = qBound(1u, rateHz, logRateHz / 2);
+            fastestHz = qMax(fastestHz, rateHz);
+            dest.periodUsec = hzToUsec(rateHz);
+        } else if (m_serverMode == ServerMode::PERIODIC) {
+            dest.periodUsec = hzToUsec(serverRateHz);
+        }
+        m_serverDestinations.append(dest);
+    }
+    if (m_serverDestinations.isEmpty()) {
+        ServerDestination dest;
+        dest.address = m_serverAddress;
+        dest.port = m_serverPort;
+        m_serverDestinations.append(dest);
+    }
+    m_sendPeriodUsec = hzToUsec(fastestHz);
+    m_serverMulticastTTL = static_cast<quint8>(qMin(m_settings->value(
+        "multicast_ttl", 1).toUInt(), 255u));
+    m_serverMulticastInterface = QHostAddress(m_settings->value(
+        "multicast_interface", "").toString());
+    m_serverKeyframeInterval = qMax(1u, m_settings->value(
+        "keyframe_interval", 50).toUInt());
+    // Groups are at most 256 packets; recovery costs grow with the parity.
+    m_serverFecDataPackets = static_cast<quint8>(qBound(1u,
+        m_settings->value("fec_data_packets", 8).toUInt(), 128u));
+    m_serverFecParityPackets = static_cast<quint8>(qBound(1u,
+        m_settings->value("fec_parity_packets", 1).toUInt(), 32u));
+    m_serverSubscribePort = static_cast<quint16>(m_settings->value(
+        "subscribe_port", 0).toUInt());
+    // Subscriptions point a stream at their source, so they can be limited
+    // to trusted subnets, "address[/prefix]". If none of those listed is
+    // valid, subscriptions are turned off rather than accepted from anywhere.
+    m_serverSubscribeAllow.clear();
+    const QStringList allow = m_settings->value("subscribe_allow",
+        QStringList()).toStringList();
+    for (const QString &entry : allow) {
+        QString subnet = entry.trimmed();
+        if (subnet.isEmpty()) {
+            continue;
+        }
+        if (!subnet.contains('/')) {
+            subnet += "/32";
+        }
+        const QPair<QHostAddress, int> parsed =
+            QHostAddress::parseSubnet(subnet);
+        if (parsed.first.protocol() != QAbstractSocket::IPv4Protocol) {
+            qWarning() << "[WARN ]  invalid subscription subnet" << entry
+                       << "- ignoring";
+            continue;
+        }
+        m_serverSubscribeAllow.append(parsed);
+    }
+    if (m_serverSubscribeAllow.isEmpty() && !allow.join("").trimmed()
+            .isEmpty()) {
+        qWarning() << "[WARN ]  no valid subscribe_allow subnets"
+                   << "- subscriptions off";
+        m_serverSubscribePort = 0;
+    }
+    m_serverMaxSubscribers = m_settings->value("max_subscribers",
+        8).toUInt();
+    m_serverSubscriptionTimeoutSec = qMax(1u, m_settings->value(
+        "subscription_timeout_sec", 10).toUInt());
+    // Coalescing for longer than a send period would be slower than the
+    // periodic mode.
+    m_serverCoalesceUsec = qMin(m_settings->value("coalesce_usec",
+        0).toUInt(), m_sendPeriodUsec);
     m_settings->endGroup();
     if (debugRC()) {
         qDebug() << "Loaded [server] settings group:";
@@ -128,6 +314,27 @@ Settings::loadRCFile(QString _fn)
         qDebug() << "\taddress:              " << m_serverAddress;
         qDebug() << "\tport:                 " << m_serverPort;
         qDebug() << "\trate_hz:              " << serverRateHz;
+        for (const ServerDestination &dest : m_serverDestinations) {
+            qDebug() << "\tdestination:          " << dest.address
+                     << dest.port << dest.periodUsec << "us" << dest.fields
+                     << (dest.delta ? "delta" : "raw")
+                     << (dest.fec ? "fec" : "");
+        }
+        qDebug() << "\tmulticast_ttl:        " << m_serverMulticastTTL;
+        qDebug() << "\tmulticast_interface:  " << m_serverMulticastInterface;
+        qDebug() << "\tkeyframe_interval:    " << m_serverKeyframeInterval;
+        qDebug() << "\tfec_data_packets:     " << m_serverFecDataPackets;
+        qDebug() << "\tfec_parity_packets:   " << m_serverFecParityPackets;
+        qDebug() << "\tsubscribe_port:       " << m_serverSubscribePort;
+        for (const auto &subnet : m_serverSubscribeAllow) {
+            qDebug() << "\tsubscribe_allow:      " << subnet.first
+                     << subnet.second;
+        }
+        qDebug() << "\tmax_subscribers:      " << m_serverMaxSubscribers;
+        qDebug() << "\tsubscription_timeout_sec:"
+                 << m_serverSubscriptionTimeoutSec;
+        qDebug() << "\tmode:                 " << serverMode;
+        qDebug() << "\tcoalesce_usec:        " << m_serverCoalesceUsec;
     }
 
     // MAVLink parameters.
@@ -152,11 +359,22 @@ Settings::loadRCFile(QString _fn)
     m_settings->beginGroup("rio");
     m_rioBaudRate = m_settings->value("baud_rate", 0).toInt();
     m_rioSerialPort = m_settings->value("serial_port", "").toString();
+    QString rioProtocol = m_settings->value("protocol", "ascii").toString();
+    if (rioProtocol == "binary") {
+        m_rioProtocol = RIOProtocol::BINARY;
+    } else {
+        if (rioProtocol != "ascii") {
+            qWarning() << "[WARN ]  unknown rio protocol" << rioProtocol
+                       << "- using ascii";
+        }
+        m_rioProtocol = RIOProtocol::ASCII;
+    }
     m_settings->endGroup();
     if (debugRC()) {
         qDebug() << "Loaded [rio] settings group:";
         qDebug() << "\tbaud_rate:             " << m_rioBaudRate;
         qDebug() << "\tserial_port:           " << m_rioSerialPort;
+        qDebug() << "\tprotocol:              " << rioProtocol;
     }
 
     // uADC parameters.
@@ -20,8 +20,10 @@
 #include <QFile>
 #include <QHostAddress>
 #include <QObject>
+#include <QPair>
 #include <QSettings>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 // project
 #include "core/consts.hh"
@@ -31,6 +33,24 @@
 namespace dfti {
 
 
+//! A destination the server sends state data to.
+struct ServerDestination
+{
+    //! Address, unicast or multicast.
+    QHostAddress address;
+    //! Port.
+    quint16 port{0};
+    //! Send period in microseconds; 0 sends with every server send.
+    quint32 periodUsec{0};
+    //! Names of the StateData fields to send; empty for all of them.
+    QStringList fields;
+    //! Flag to send the fields delta encoded.
+    bool delta{false};
+    //! Flag to send the datagrams with forward error correction.
+    bool fec{false};
+};
+
+
 //! Settings manager.
 class Settings : public QObject
 {
@@ -61,14 +81,26 @@ public:
      */
     void loadRCFile(QString _fn);
 
-    //! Return the log sampling time in ms.
-    float logRateMs(void) const { return m_logRateMs; };
+    //! Return the log sampling time in microseconds.
+    quint32 logPeriodUsec(void) const { return m_logPeriodUsec; };
+
+    //! Return the log file format.
+    LogFormat logFormat(void) const { return m_logFormat; };
+
+    //! Return the log scheduling mode.
+    LogMode logMode(void) const { return m_logMode; };
+
+    //! Return the sensor threading layout.
+    ThreadMode threadMode(void) const { return m_threadMode; };
+
+    //! Return the serial port backend.
+    SerialBackend serialBackend(void) const { return m_serialBackend; };
 
     //! Return the log flush timer period in ms.
-    float flushRateMs(void) const { return m_flushRateMs; };
+    quint32 flushRateMs(void) const { return m_flushRateMs; };
 
-    //! Return the server sampling time in ms.
-    float sendRateMs(void) const { return m_sendRateMs; };
+    //! Return the server sampling time in microseconds.
+    quint32 sendPeriodUsec(void) const { return m_sendPeriodUsec; };
 
     //! Return the server status.
     bool serverEnabled(void) const { return m_serverEnabled; };
@@ -79,6 +111,72 @@ public:
     //! Return the server port.
     quint16 serverPort(void) const { return m_serverPort; };
 
+    //! Return the server destinations.
+    /*!
+     *  Either those listed in <tt>destinations</tt>, or the server address
+     *  and port at the server rate.
+     */
+    QVector<ServerDestination> serverDestinations(void) const {
+        return m_serverDestinations;
+    };
+
+    //! Return the time to live of multicast datagrams.
+    quint8 serverMulticastTTL(void) const { return m_serverMulticastTTL; };
+
+    //! Return the interface multicast datagrams are sent from.
+    /*!
+     *  
+eturn Address of the interface, or null for the default route.
+     */
+    QHostAddress serverMulticastInterface(void) const {
+        return m_serverMulticastInterface;
+    };
+
+    //! Return the port clients subscribe on, or 0 if subscriptions are off.
+    quint16 serverSubscribePort(void) const { return m_serverSubscribePort; };
+
+    //! Return the subnets subscriptions are accepted from.
+    /*!
+     *  \return Address and prefix length of each subnet; empty to accept
+     *      subscriptions from anywhere.
+     */
+    QVector<QPair<QHostAddress, int>> serverSubscribeAllow(void) const {
+        return m_serverSubscribeAllow;
+    };
+
+    //! Return the maximum number of subscribed clients.
+    quint32 serverMaxSubscribers(void) const {
+        return m_serverMaxSubscribers;
+    };
+
+    //! Return the time a subscription lasts unless renewed, seconds.
+    quint32 serverSubscriptionTimeoutSec(void) const {
+        return m_serverSubscriptionTimeoutSec;
+    };
+
+    //! Return the datagrams from one delta keyframe to the next.
+    quint32 serverKeyframeInterval(void) const {
+        return m_serverKeyframeInterval;
+    };
+
+    //! Return the datagrams per forward error correction group.
+    quint8 serverFecDataPackets(void) const { return m_serverFecDataPackets; };
+
+    //! Return the parity packets per forward error correction group.
+    quint8 serverFecParityPackets(void) const {
+        return m_serverFecParityPackets;
+    };
+
+    //! Return the server send mode.
+    ServerMode serverMode(void) const { return m_serverMode; };
+
+    //! Return the window VN-200 measurements are coalesced in, microseconds.
+    /*!
+     *  In event mode the server waits this long after a measurement before
+     *  sending, so a burst is sent as one datagram; 0 sends at once.
+     */
+    quint32 serverCoalesceUsec(void) const { return m_serverCoalesceUsec; };
+
     //! Should we prefer the MESSAGE_INTERVAL interface?
     /*!
      *  \remark MAVLink has deprecated the REQUEST_DATA_STREAM interface in
@@ -120,6 +218,9 @@ public:
     //! Should we wait for a data update to write to the log?
     bool waitForUpdate(void) const { return m_waitForUpdate; };
 
+    //! Should raw serial bytes be captured to file?
+    bool captureRaw(void) const { return m_captureRaw; };
+
     //! Overridden Autopilot serial port.
     QString autopilotSerialPort(void) const { return m_autopilotSerialPort; };
 
@@ -141,6 +242,9 @@ public:
     //! Overridden uADC baud rate.
     quint32 uADCBaudRate(void) const { return m_uADCBaudRate; };
 
+    //! RIO serial protocol.
+    RIOProtocol rioProtocol(void) const { return m_rioProtocol; };
+
     //! Overridden VN-200 baud rate.
     quint32 vn200BaudRate(void) const { return m_vn200BaudRate; };
 
@@ -160,17 +264,29 @@ private:
     //! Debug settings.
     DebugMode m_debug{DebugMode::DEBUG_NONE};
 
-    //! Log sample time in ms.
-    float m_logRateMs{10};
+    //! Log sample time in microseconds.
+    quint32 m_logPeriodUsec{10000};
+
+    //! Log file format.
+    LogFormat m_logFormat{LogFormat::CSV};
+
+    //! Log scheduling mode.
+    LogMode m_logMode{LogMode::SAMPLE_HOLD};
+
+    //! Sensor threading layout.
+    ThreadMode m_threadMode{ThreadMode::SENSOR_THREADS};
+
+    //! Serial port backend.
+    SerialBackend m_serialBackend{SerialBackend::QT};
 
     //! Flush timer in ms.
-    float m_flushRateMs{1e4};
+    quint32 m_flushRateMs{10000};
 
     //! Server status.
     bool m_serverEnabled{false};
 
-    //! Server sample time in ms.
-    float m_sendRateMs{20};
+    //! Server sample time in microseconds.
+    quint32 m_sendPeriodUsec{20000};
 
     //! Server address.
     QHostAddress m_serverAddress{QHostAddress::LocalHost};
@@ -178,6 +294,42 @@ private:
     //! Server port.
     quint16 m_serverPort{2701};
 
+    //! Server destinations.
+    QVector<ServerDestination> m_serverDestinations;
+
+    //! Multicast time to live.
+    quint8 m_serverMulticastTTL{1};
+
+    //! Datagrams from one delta keyframe to the next.
+    quint32 m_serverKeyframeInterval{50};
+
+    //! Datagrams per forward error correction group.
+    quint8 m_serverFecDataPackets{8};
+
+    //! Parity packets per forward error correction group.
+    quint8 m_serverFecParityPackets{1};
+
+    //! Multicast interface address.
+    QHostAddress m_serverMulticastInterface;
+
+    //! Subscription port, 0 for none.
+    quint16 m_serverSubscribePort{0};
+
+    //! Subnets subscriptions are accepted from, empty for any.
+    QVector<QPair<QHostAddress, int>> m_serverSubscribeAllow;
+
+    //! Maximum number of subscribed clients.
+    quint32 m_serverMaxSubscribers{8};
+
+    //! Subscription lifetime in seconds.
+    quint32 m_serverSubscriptionTimeoutSec{10};
+
+    //! Server send mode.
+    ServerMode m_serverMode{ServerMode::PERIODIC};
+
+    //! Server event coalescing window in microseconds.
+    quint32 m_serverCoalesceUsec{0};
+
     //! Prefer MESSAGE_INTERVAL to REQUEST_DATA_STREAM?
     bool m_useMessageInterval{false};
 
@@ -214,6 +366,9 @@ private:
     //! Should we wait for a data update to write to the log?
     bool m_waitForUpdate{true};
 
+    //! Capture raw serial bytes to file.
+    bool m_captureRaw{false};
+
     //! Overridden Autopilot serial port.
     QString m_autopilotSerialPort{""};
 
@@ -235,6 +390,9 @@ private:
     //! Overridden uADC baud rate.
     quint32 m_uADCBaudRate{0};
 
+    //! RIO serial protocol.
+    RIOProtocol m_rioProtocol{RIOProtocol::ASCII};
+
     //! Overridden VN-200 baud rate.
     quint32 m_vn200BaudRate{0};
 };
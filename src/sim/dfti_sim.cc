@@ -0,0 +1,207 @@
+/*!
+ *  \file dfti_sim.cc
+ *  \brief DFTI pseudo-terminal sensor simulator program.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+
+
+// stdlib
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <vector>
+// 3rd party
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+// project
+#include "core/consts.hh"
+#include "sim/simulator.hh"
+
+
+//! App info.
+const QString app_name{"dftisim"};
+
+
+//! Set by SIGINT/SIGTERM to stop the simulators.
+static std::atomic<bool> interrupted{false};
+
+
+//! Signal handler for SIGINT and SIGTERM.
+static void
+handleSignal(int)
+{
+    interrupted = true;
+}
+
+
+//! Print the counters of every simulator.
+/*!
+ *  \param sims Simulators.
+ *  \param seconds Seconds since the simulators were started.
+ */
+static void
+printStats(const std::vector<std::unique_ptr<dfti::PtySimulator>> &sims,
+    double seconds)
+{
+    const char *names[] = {"ap", "rio", "uadc", "vn200"};
+    printf("%6s %14s %10s %10s %10s %10s %8s %12s\n", "sensor", "port",
+        "packets", "rate_hz", "kB/s", "corrupted", "late", "dropped_B");
+    for (auto &sim : sims) {
+        const dfti::SimStats &stats = sim->stats();
+        printf("%6s %14s %10llu %10.1f %10.2f %10llu %8llu %12llu\n",
+            names[static_cast<int>(sim->sensor())],
+            sim->portName().toLocal8Bit().constData(),
+            static_cast<unsigned long long>(stats.packets),
+            stats.packets / seconds, 1e-3 * stats.bytes / seconds,
+            static_cast<unsigned long long>(stats.corrupted),
+            static_cast<unsigned long long>(stats.late),
+            static_cast<unsigned long long>(stats.bytesDropped));
+    }
+    fflush(stdout);
+}
+
+
+//! Main simulator application function.
+/*!
+ *  Opens one pseudo-terminal per enabled sensor, prints the device names to
+ *  put in the rc file, and emits packets until the run time is up or the
+ *  program is interrupted. Dropped bytes mean the reader (usually dfti) did
+ *  not keep up with the selected rates.
+ *  \param argc Number of command line arguments.
+ *  \param argv Array of command line arguments.
+ */
+int
+main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(app_name);
+    QCoreApplication::setApplicationVersion(dfti::app_version);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "dftisim -- simulate DFTI sensors on pseudo-terminals");
+    // Options
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption(QCommandLineOption("ap",
+        "Emit MAVLink RC_CHANNELS_RAW/SERVO_OUTPUT_RAW at this rate.", "hz"));
+    parser.addOption(QCommandLineOption("rio",
+        "Emit RIO frames at this rate.", "hz"));
+    parser.addOption(QCommandLineOption("uadc",
+        "Emit uADC lines at this rate.", "hz"));
+    parser.addOption(QCommandLineOption("vn200",
+        "Emit VN-200 binary packets at this rate.", "hz"));
+    parser.addOption(QCommandLineOption({"b", "baud"},
+        "Modelled link speed (default 115200).", "baud", "115200"));
+    parser.addOption(QCommandLineOption({"e", "corrupt"},
+        "Fraction of packets with a flipped bit (default 0).", "ratio",
+        "0"));
+    parser.addOption(QCommandLineOption("rio-channels",
+        "Number of RIO values per frame, 1 to 16 (default 4).", "n", "4"));
+    parser.addOption(QCommandLineOption("rio-binary",
+        "Emit RIO binary (v2) frames instead of ASCII ones."));
+    parser.addOption(QCommandLineOption({"l", "link-dir"},
+        "Create <dir>/<sensor> symlinks to the pseudo-terminals.", "dir"));
+    parser.addOption(QCommandLineOption({"t", "seconds"},
+        "Run time in seconds, 0 to run until interrupted (default 0).",
+        "seconds", "0"));
+    parser.addOption(QCommandLineOption({"i", "interval"},
+        "Seconds between reports, 0 for only a final one (default 10).",
+        "seconds", "10"));
+    parser.process(app);
+
+    const quint32 baud = parser.value("baud").toUInt();
+    const double corrupt = parser.value("corrupt").toDouble();
+    const quint32 channels = parser.value("rio-channels").toUInt();
+    if (!baud || corrupt < 0 || corrupt > 1 || !channels ||
+        channels > dfti::rioMaxValues) {
+        qWarning() << "[WARN ]  invalid baud, corrupt or rio-channels value";
+        return -1;
+    }
+
+    // Create the simulators in the order of the SimSensor enum.
+    const QString names[] = {"ap", "rio", "uadc", "vn200"};
+    const dfti::SimSensor sensors[] = {dfti::SimSensor::AUTOPILOT,
+        dfti::SimSensor::RIO, dfti::SimSensor::UADC, dfti::SimSensor::VN200};
+    std::vector<std::unique_ptr<dfti::PtySimulator>> sims;
+    for (int i = 0; i < 4; ++i) {
+        if (!parser.isSet(names[i])) {
+            continue;
+        }
+        const double rate = parser.value(names[i]).toDouble();
+        if (rate <= 0) {
+            qWarning() << "[WARN ]  invalid rate for" << names[i];
+            return -1;
+        }
+        sims.emplace_back(new dfti::PtySimulator(sensors[i], rate, baud,
+            corrupt, channels));
+        if (parser.isSet("rio-binary")) {
+            sims.back()->setRIOProtocol(dfti::RIOProtocol::BINARY);
+        }
+        QString link;
+        if (parser.isSet("link-dir")) {
+            link = QDir(parser.value("link-dir")).filePath(names[i]);
+        }
+        if (!sims.back()->open(link)) {
+            return -1;
+        }
+        printf("%s: %s%s\n", names[i].toLatin1().constData(),
+            sims.back()->portName().toLocal8Bit().constData(),
+            link.isEmpty() ? "" : qPrintable(" -> " + link));
+    }
+    if (sims.empty()) {
+        qWarning() << "[WARN ]  enable at least one of --ap, --rio, --uadc,"
+                   << "--vn200";
+        return -1;
+    }
+    fflush(stdout);
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    for (auto &sim : sims) {
+        sim->start();
+    }
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // Poll for the end of the run and print periodic reports.
+    const qint64 runMs = 1000 * parser.value("seconds").toLongLong();
+    const qint64 intervalMs = 1000 * parser.value("interval").toLongLong();
+    qint64 nextReportMs = intervalMs;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, [&]() {
+        const qint64 ms = elapsed.elapsed();
+        if (interrupted || (runMs && ms >= runMs)) {
+            app.quit();
+            return;
+        }
+        if (intervalMs && ms >= nextReportMs) {
+            printStats(sims, 1e-3 * ms);
+            nextReportMs += intervalMs;
+        }
+    });
+    poll.start(100);
+    app.exec();
+
+    for (auto &sim : sims) {
+        sim->stop();
+    }
+    printStats(sims, 1e-3 * elapsed.elapsed());
+    return 0;
+}
@@ -0,0 +1,362 @@
+/*!
+ *  \file simulator.cc
+ *  \brief Pseudo-terminal sensor simulator implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "simulator.hh"
+
+// stdlib
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+// 3rd party
+#include <mavlink/v1/common/mavlink.h>
+#include <QDebug>
+#include <QFile>
+// dfti
+#include "util/crc.hh"
+#include "util/util.hh"
+
+
+namespace dfti {
+
+
+//! Seconds from the Unix epoch to the GPS epoch, plus the leap seconds since.
+static const quint64 gpsOffsetSec = 315964800 - 18;
+
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+PtySimulator::PtySimulator(SimSensor _sensor, double _rateHz, quint32 _baud,
+    double _corruptRatio, quint8 _rioChannels)
+: simSensor(_sensor), rateHz(_rateHz), baud(_baud),
+  corruptRatio(_corruptRatio), rioChannels(_rioChannels),
+  rng(static_cast<quint32>(_sensor) + 1)
+{
+}
+
+
+PtySimulator::~PtySimulator()
+{
+    stop();
+    if (!linkName.isEmpty()) {
+        QFile::remove(linkName);
+    }
+    if (slave >= 0) {
+        ::close(slave);
+    }
+    if (master >= 0) {
+        ::close(master);
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+bool
+PtySimulator::open(const QString &link)
+{
+    master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (master < 0 || grantpt(master) || unlockpt(master)) {
+        qWarning() << "[ERROR]  failed to create pty:" << strerror(errno);
+        return false;
+    }
+    slaveName = QString::fromLocal8Bit(ptsname(master));
+    slave = ::open(ptsname(master), O_RDWR | O_NOCTTY);
+    if (slave < 0) {
+        qWarning() << "[ERROR]  failed to open" << slaveName;
+        return false;
+    }
+
+    // Raw mode, so that no byte of the binary protocols is translated (and
+    // "\r" stays "\r") for readers that don't set the mode themselves.
+    struct termios tio;
+    if (tcgetattr(slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+
+    if (!link.isEmpty()) {
+        QFile::remove(link);
+        if (!QFile::link(slaveName, link)) {
+            qWarning() << "[ERROR]  failed to link" << link << "to"
+                       << slaveName;
+            return false;
+        }
+        linkName = link;
+    }
+    return true;
+}
+
+
+void
+PtySimulator::start(void)
+{
+    running = true;
+    thread = std::thread(&PtySimulator::run, this);
+}
+
+
+void
+PtySimulator::stop(void)
+{
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+void
+PtySimulator::run(void)
+{
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(1.0 / rateHz));
+    // 8N1 puts 10 bits on the wire per byte.
+    const double byteSec = 10.0 / baud;
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    const auto start = clock::now();
+    auto tick = start;
+    auto linkFree = start;
+    for (quint64 n = 0; running; ++n) {
+        auto sendAt = tick;
+        if (linkFree > tick) {
+            sendAt = linkFree;
+            ++simStats.late;
+        }
+        std::this_thread::sleep_until(sendAt);
+
+        QByteArray pkt = nextPacket(n,
+            std::chrono::duration<double>(tick - start).count());
+        if (corruptRatio > 0 && uniform(rng) < corruptRatio) {
+            std::uniform_int_distribution<int> pos(0, pkt.size() - 1);
+            std::uniform_int_distribution<int> bit(0, 7);
+            const int i = pos(rng);
+            pkt[i] = pkt.at(i) ^ (1 << bit(rng));
+            ++simStats.corrupted;
+        }
+        writePacket(pkt);
+
+        linkFree = sendAt + std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(byteSec * pkt.size()));
+        tick += period;
+    }
+}
+
+
+QByteArray
+PtySimulator::nextPacket(quint64 n, double t)
+{
+    const float s = std::sin(t);
+    const float c = std::cos(t);
+    switch (simSensor) {
+        case SimSensor::AUTOPILOT:
+            return nextMAVLink(n, t);
+        case SimSensor::RIO: {
+            if (rioProtocol == RIOProtocol::BINARY) {
+                quint16 counts[rioBinMaxChannels];
+                for (quint8 i = 0; i + 1 < rioChannels; ++i) {
+                    counts[i] = static_cast<quint16>(
+                        std::lround(512 + 400 * std::sin(t + i)));
+                }
+                return encodeRIOBinaryPacket(static_cast<quint16>(n),
+                    static_cast<quint32>(1e6 * t), counts, rioChannels - 1,
+                    static_cast<quint16>(2400 + 100 * s));
+            }
+            float values[rioMaxValues];
+            for (quint8 i = 0; i < rioChannels; ++i) {
+                values[i] = std::round(180 + 90 * std::sin(t + i));
+            }
+            return encodeRIOPacket(values, rioChannels);
+        }
+        case SimSensor::UADC: {
+            uADCData data;
+            data.id = n % 100000;
+            data.iasMps = 25 + 5 * s;
+            data.aoaDeg = 4 + 2 * c;
+            data.aosDeg = s;
+            data.altM = 120;
+            data.ptPa = 101700 + static_cast<qint32>(300 * s);
+            data.psPa = 100000;
+            return encodeUADCPacket(data);
+        }
+        case SimSensor::VN200:  // fallthrough
+        default: {
+            VN200Data data;
+            data.gpsTimeNs = 1000 * (getTimeUsec() - 1000000 * gpsOffsetSec);
+            data.eulerDeg[0] = 90 + 10 * s;
+            data.eulerDeg[1] = 5 * c;
+            data.eulerDeg[2] = 20 * s;
+            data.quaternion[0] = 1;
+            data.angularRatesRPS[0] = 0.1f * c;
+            data.angularRatesRPS[1] = 0.05f * s;
+            data.angularRatesRPS[2] = 0.01f;
+            data.posDegDegM[0] = 30.6 + 1e-5 * t;
+            data.posDegDegM[1] = -96.3;
+            data.posDegDegM[2] = 120;
+            data.velNedMps[0] = 25;
+            data.accelMps2[0] = s;
+            data.accelMps2[2] = -9.81f;
+            return encodeVN200Packet(data);
+        }
+    }
+}
+
+
+QByteArray
+PtySimulator::nextMAVLink(quint64 n, double t)
+{
+    QByteArray pkt;
+    quint8 buf[MAVLINK_MAX_PACKET_LEN];
+    mavlink_message_t msg;
+    auto append = [&]() {
+        const quint16 len = mavlink_msg_to_send_buffer(buf, &msg);
+        pkt.append(reinterpret_cast<const char *>(buf), len);
+    };
+    const quint8 sys = 1;
+    const quint8 comp = 1;
+    const quint32 ms = static_cast<quint32>(1e3 * t);
+    const quint16 pwm = 1500 + static_cast<qint16>(400 * std::sin(t));
+    // A heartbeat about once a second, as an autopilot sends.
+    if (!(n % qMax<quint64>(1, std::lround(rateHz)))) {
+        mavlink_msg_heartbeat_pack(sys, comp, &msg, MAV_TYPE_FIXED_WING,
+            MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+        append();
+    }
+    mavlink_msg_rc_channels_raw_pack(sys, comp, &msg, ms, 0, pwm, pwm, 1500,
+        1100, 1500, 1500, 1500, 1500, 255);
+    append();
+    mavlink_msg_servo_output_raw_pack(sys, comp, &msg, 1000 * ms, 0, pwm, pwm,
+        1500, 1100, 1500, 1500, 1500, 1500);
+    append();
+    return pkt;
+}
+
+
+void
+PtySimulator::writePacket(const QByteArray &pkt)
+{
+    ssize_t len = ::write(master, pkt.constData(), pkt.size());
+    if (len < 0) {
+        // EAGAIN: the pty is full because nobody is reading it.
+        len = 0;
+    }
+    simStats.bytes += len;
+    simStats.bytesDropped += pkt.size() - len;
+    ++simStats.packets;
+}
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+QByteArray
+encodeVN200Packet(const VN200Data &data)
+{
+    QByteArray pkt("\xfa\x01\xfa\x01", 4);
+    auto append = [&pkt](const void *value, size_t size) {
+        pkt.append(reinterpret_cast<const char *>(value), size);
+    };
+    // The VN-200 sends the quaternion scalar last.
+    const float quaternion[4] = {data.quaternion[1], data.quaternion[2],
+        data.quaternion[3], data.quaternion[0]};
+    append(&data.gpsTimeNs, sizeof(data.gpsTimeNs));
+    append(data.eulerDeg, sizeof(data.eulerDeg));
+    append(quaternion, sizeof(quaternion));
+    append(data.angularRatesRPS, sizeof(data.angularRatesRPS));
+    append(data.posDegDegM, sizeof(data.posDegDegM));
+    append(data.velNedMps, sizeof(data.velNedMps));
+    append(data.accelMps2, sizeof(data.accelMps2));
+    // The CRC covers everything after the sync byte and is sent big-endian,
+    // so that the CRC of the whole packet is zero.
+    const quint16 crc = crc16CCITT(pkt.constData() + 1, pkt.size() - 1);
+    pkt.append(static_cast<char>(crc >> 8));
+    pkt.append(static_cast<char>(crc & 0xff));
+    return pkt;
+}
+
+
+QByteArray
+encodeUADCPacket(const uADCData &data)
+{
+    // The line is the packet plus "\r\n", the "\r" being part of the
+    // packet length.
+    char line[uadcPktLen + 2];
+    snprintf(line, sizeof(line),
+        "%05u, %05.2f, %+06.2f, %+06.2f, %+05d, %06u, %06u, ",
+        data.id % 100000, qBound(0.0f, data.iasMps, 99.99f),
+        qBound(-99.99f, data.aoaDeg, 99.99f),
+        qBound(-99.99f, data.aosDeg, 99.99f),
+        static_cast<int>(qMin<unsigned>(data.altM, 9999)),
+        qMin<unsigned>(data.ptPa, 999999), qMin<unsigned>(data.psPa, 999999));
+    quint8 cksum = 0;
+    for (quint8 i = 0; i < uadcPktCksumPos; ++i) {
+        cksum ^= static_cast<quint8>(line[i]);
+    }
+    snprintf(line + uadcPktCksumPos, sizeof(line) - uadcPktCksumPos,
+        "%02X\r%c", cksum, uadcTerm);
+    return QByteArray(line, uadcPktLen + 1);
+}
+
+
+QByteArray
+encodeRIOPacket(const float *values, quint8 count)
+{
+    QByteArray pkt("$$$");
+    for (quint8 i = 0; i < count; ++i) {
+        pkt.append(QByteArray::number(values[i], 'f', 2));
+        pkt.append(rioSep);
+    }
+    quint8 cksum = 0;
+    for (auto byte : pkt) {
+        cksum ^= static_cast<quint8>(byte);
+    }
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02x", cksum);
+    pkt.append(hex);
+    pkt.append("\r\n");
+    return pkt;
+}
+
+
+QByteArray
+encodeRIOBinaryPacket(quint16 sequence, quint32 timeUsec,
+    const quint16 *counts, quint8 channels, quint16 rpm)
+{
+    QByteArray pkt(rioSync, 2);
+    pkt.resize(rioBinFrameLen(channels));
+    uchar *p = reinterpret_cast<uchar *>(pkt.data());
+    p[2] = channels;
+    qToLittleEndian<quint16>(sequence, p + 3);
+    qToLittleEndian<quint32>(timeUsec, p + 5);
+    for (quint8 i = 0; i < channels; ++i) {
+        qToLittleEndian<quint16>(counts[i], p + rioBinHeaderLen + 2 * i);
+    }
+    qToLittleEndian<quint16>(rpm, p + rioBinHeaderLen + 2 * channels);
+    // Big-endian CRC over everything after the sync bytes, as the VN-200.
+    const quint16 crc = crc16CCITT(pkt.constData() + 2, pkt.size() - 4);
+    p[pkt.size() - 2] = static_cast<uchar>(crc >> 8);
+    p[pkt.size() - 1] = static_cast<uchar>(crc & 0xff);
+    return pkt;
+}
+
+
+};  // namespace dfti
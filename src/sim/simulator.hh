@@ -0,0 +1,234 @@
+/*!
+ *  \file simulator.hh
+ *  \brief Pseudo-terminal sensor simulator interface.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <atomic>
+#include <random>
+#include <thread>
+// 3rd party
+#include <QByteArray>
+#include <QString>
+// dfti
+#include "rio/rio.hh"
+#include "uadc/uadc.hh"
+#include "vn200/vn200.hh"
+
+
+namespace dfti {
+
+
+//! Sensors the simulator can stand in for.
+enum class SimSensor : quint8 {
+    AUTOPILOT,  /// MAVLink-based autopilot
+    RIO,        /// Remote I/O unit
+    UADC,       /// Micro Air Data Computer
+    VN200       /// VN-200 INS
+};
+
+
+//! Encode a VN-200 binary output packet.
+/*!
+ *  Uses the output group 1 layout the VN200 driver expects, including the
+ *  sync byte and the big-endian CRC.
+ *
+ *  \param data Measurement to encode; the receive time is ignored.
+ *  \return Packet bytes.
+ */
+QByteArray encodeVN200Packet(const VN200Data &data);
+
+
+//! Encode a uADC fixed-width ASCII line.
+/*!
+ *  \param data Measurement to encode; the receive time is ignored.
+ *  \return Line bytes, including the XOR checksum and the terminator.
+ */
+QByteArray encodeUADCPacket(const uADCData &data);
+
+
+//! Encode a RIO "$$$" frame as the RIO sketch prints it.
+/*!
+ *  \param values RIO values.
+ *  \param count Number of values.
+ *  \return Frame bytes, including the XOR checksum and "\r\n".
+ */
+QByteArray encodeRIOPacket(const float *values, quint8 count);
+
+
+//! Encode a RIO binary (v2) frame.
+/*!
+ *  \param sequence Frame sequence counter.
+ *  \param timeUsec RIO clock at the start of the scan, microseconds.
+ *  \param counts Raw ADC counts.
+ *  \param channels Number of ADC channels, at most rioBinMaxChannels.
+ *  \param rpm Engine RPM.
+ *  \return Frame bytes, including the CRC.
+ */
+QByteArray encodeRIOBinaryPacket(quint16 sequence, quint32 timeUsec,
+    const quint16 *counts, quint8 channels, quint16 rpm);
+
+
+//! Counters kept by a running simulator.
+struct SimStats
+{
+    //! Packets written.
+    std::atomic<quint64> packets{0};
+    //! Packets written with a corrupted byte.
+    std::atomic<quint64> corrupted{0};
+    //! Bytes written.
+    std::atomic<quint64> bytes{0};
+    //! Bytes lost because nobody drained the pseudo-terminal.
+    std::atomic<quint64> bytesDropped{0};
+    //! Packets sent late because the link was still busy.
+    std::atomic<quint64> late{0};
+};
+
+
+//! Emits one sensor's data stream on a pseudo-terminal.
+/*!
+ *  Opens a pty pair in raw mode and writes valid packets for one sensor to
+ *  the master side from its own thread at a fixed rate, so that dfti can
+ *  open the slave side as if it were the sensor's serial port.
+ *
+ *  A pty has no baud rate, so the link speed is modelled: a packet is never
+ *  sent before the previous one would have finished on a real 8N1 link,
+ *  and packets that can't keep their slot are counted as late. Like a real
+ *  sensor the simulator never waits for the reader; bytes the pty can't
+ *  take are dropped and counted.
+ *
+ *  RIO frames carry rioChannels values either way; in binary frames the
+ *  last one is the RPM.
+ *
+ *  A fraction of the packets can have one bit flipped to exercise the
+ *  checksum and resync paths of the parsers.
+ */
+class PtySimulator
+{
+public:
+    //! Constructor
+    /*!
+     *  \param _sensor Sensor to simulate.
+     *  \param _rateHz Packet rate in Hz.
+     *  \param _baud Modelled link speed in baud.
+     *  \param _corruptRatio Fraction of packets to corrupt, 0 to 1.
+     *  \param _rioChannels Number of RIO values per frame.
+     */
+    PtySimulator(SimSensor _sensor, double _rateHz, quint32 _baud,
+        double _corruptRatio, quint8 _rioChannels = 4);
+
+    //! Dtor.
+    ~PtySimulator();
+
+    //! Open the pseudo-terminal.
+    /*!
+     *  \param link If not empty, a symlink to create to the slave device so
+     *      rc files can use a fixed port name.
+     *  \return True on success.
+     */
+    bool open(const QString &link = QString());
+
+    //! Start emitting packets.
+    void start(void);
+
+    //! Stop emitting packets and wait for the thread to finish.
+    void stop(void);
+
+    //! Select the RIO protocol to emit; ASCII unless set.
+    /*!
+     *  \param _protocol RIO protocol.
+     */
+    void setRIOProtocol(RIOProtocol _protocol) { rioProtocol = _protocol; }
+
+    //! Name of the slave device, e.g. /dev/pts/3.
+    QString portName(void) const { return slaveName; }
+
+    //! Sensor being simulated.
+    SimSensor sensor(void) const { return simSensor; }
+
+    //! Packet rate in Hz.
+    double rate(void) const { return rateHz; }
+
+    //! Counters.
+    const SimStats &stats(void) const { return simStats; }
+
+private:
+    //! Thread function: pace and write packets until stopped.
+    void run(void);
+
+    //! Build the next packet.
+    /*!
+     *  \param n Packet number.
+     *  \param t Simulated time in seconds.
+     *  \return Packet bytes.
+     */
+    QByteArray nextPacket(quint64 n, double t);
+
+    //! Build the next autopilot MAVLink messages.
+    /*!
+     *  \copydetails nextPacket
+     */
+    QByteArray nextMAVLink(quint64 n, double t);
+
+    //! Write a packet to the pty without blocking.
+    /*!
+     *  \param pkt Packet bytes.
+     */
+    void writePacket(const QByteArray &pkt);
+
+    //! Sensor to simulate.
+    SimSensor simSensor;
+
+    //! Packet rate in Hz.
+    double rateHz;
+
+    //! Modelled link speed in baud.
+    quint32 baud;
+
+    //! Fraction of packets to corrupt.
+    double corruptRatio;
+
+    //! Number of RIO values per frame.
+    quint8 rioChannels;
+
+    //! RIO protocol to emit.
+    RIOProtocol rioProtocol{RIOProtocol::ASCII};
+
+    //! Master side file descriptor.
+    int master{-1};
+
+    //! Slave side file descriptor, held open so the pty never hangs up.
+    int slave{-1};
+
+    //! Slave device name.
+    QString slaveName;
+
+    //! Symlink to the slave device, removed on destruction.
+    QString linkName;
+
+    //! Random source for corruption.
+    std::mt19937 rng;
+
+    //! Emitter thread.
+    std::thread thread;
+
+    //! Flag to keep the emitter thread running.
+    std::atomic<bool> running{false};
+
+    //! Counters.
+    SimStats simStats;
+};
+
+
+};  // namespace dfti
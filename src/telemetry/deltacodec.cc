@@ -0,0 +1,303 @@
+/*!
+ *  \file deltacodec.cc
+ *  \brief Delta telemetry encoder and decoder implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "deltacodec.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+//! Append an unsigned LEB128 varint.
+static inline uint8_t *
+putVarint(uint8_t *out, uint64_t v)
+{
+    while (v >= 0x80) {
+        *out++ = static_cast<uint8_t>(v) | 0x80;
+        v >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(v);
+    return out;
+}
+
+
+//! Read an unsigned LEB128 varint.
+/*!
+ *  \return Position after the varint, or nullptr if it is truncated or
+ *      longer than 64 bits.
+ */
+static inline const uint8_t *
+getVarint(const uint8_t *in, const uint8_t *end, uint64_t &v)
+{
+    v = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+        if (in == end) {
+            return nullptr;
+        }
+        const uint8_t b = *in++;
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+
+//! Map a signed value to an unsigned one with small magnitudes small.
+static inline uint64_t
+zigzag(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+
+//! Invert zigzag().
+static inline int64_t
+unzigzag(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+
+//! Return the step of an integer channel.
+static inline uint64_t
+integerQuantum(const DeltaChannel &channel)
+{
+    return channel.quantum < 1 ? 1 : static_cast<uint64_t>(
+        std::llround(channel.quantum));
+}
+
+
+size_t
+deltaMaxPacketLen(size_t channels)
+{
+    // Kind, keyframe number, bitmap, and ten bytes per 64 bit varint.
+    return 1 + 5 + (channels + 7) / 8 + 10 * channels;
+}
+
+
+int64_t
+deltaQuantize(const DeltaChannel &channel, const uint8_t *record)
+{
+    const uint8_t *p = record + channel.offset;
+    switch (channel.type) {
+        case ChannelType::U8:
+            return *p / integerQuantum(channel);
+        case ChannelType::U16: {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            return v / integerQuantum(channel);
+        }
+        case ChannelType::U32: {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v / integerQuantum(channel);
+        }
+        case ChannelType::U64: {
+            uint64_t v;
+            memcpy(&v, p, sizeof(v));
+            return static_cast<int64_t>(v / integerQuantum(channel));
+        }
+        case ChannelType::F32:
+        case ChannelType::F64: {
+            double v;
+            if (channel.type == ChannelType::F32) {
+                float f;
+                memcpy(&f, p, sizeof(f));
+                v = f;
+            } else {
+                memcpy(&v, p, sizeof(v));
+            }
+            if (std::isnan(v)) {
+                return deltaNaN;
+            }
+            // Out of range values saturate, leaving INT64_MIN free for NaN.
+            v = std::round(v / channel.quantum);
+            if (std::fabs(v) >= 9.2e18) {
+                return v > 0 ? INT64_MAX : -INT64_MAX;
+            }
+            return static_cast<int64_t>(v);
+        }
+    }
+    return 0;
+}
+
+
+void
+deltaDequantize(const DeltaChannel &channel, int64_t q, uint8_t *record)
+{
+    uint8_t *p = record + channel.offset;
+    const uint64_t v = static_cast<uint64_t>(q) * integerQuantum(channel);
+    switch (channel.type) {
+        case ChannelType::U8:
+            *p = static_cast<uint8_t>(v);
+            break;
+        case ChannelType::U16: {
+            const uint16_t u = static_cast<uint16_t>(v);
+            memcpy(p, &u, sizeof(u));
+            break;
+        }
+        case ChannelType::U32: {
+            const uint32_t u = static_cast<uint32_t>(v);
+            memcpy(p, &u, sizeof(u));
+            break;
+        }
+        case ChannelType::U64:
+            memcpy(p, &v, sizeof(v));
+            break;
+        case ChannelType::F32: {
+            const float f = (q == deltaNaN) ?
+                std::numeric_limits<float>::quiet_NaN() :
+                static_cast<float>(q * channel.quantum);
+            memcpy(p, &f, sizeof(f));
+            break;
+        }
+        case ChannelType::F64: {
+            const double d = (q == deltaNaN) ?
+                std::numeric_limits<double>::quiet_NaN() : q * channel.quantum;
+            memcpy(p, &d, sizeof(d));
+            break;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+DeltaEncoder::DeltaEncoder(const std::vector<DeltaChannel> &_channels,
+    uint32_t _keyframeInterval)
+: channels(_channels),
+  keyframeInterval(_keyframeInterval ? _keyframeInterval : 1),
+  sinceKeyframe(keyframeInterval), key(_channels.size(), 0)
+{
+}
+
+
+DeltaDecoder::DeltaDecoder(const std::vector<DeltaChannel> &_channels)
+: channels(_channels), key(_channels.size(), 0),
+  pending(_channels.size(), 0), values(_channels.size(), 0)
+{
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+size_t
+DeltaEncoder::encode(const uint8_t *record, uint8_t *packet)
+{
+    uint8_t *out = packet;
+    const size_t n = channels.size();
+    if (sinceKeyframe >= keyframeInterval) {
+        sinceKeyframe = 0;
+        ++keyframe;
+        *out++ = deltaKeyframe;
+        out = putVarint(out, keyframe);
+        for (size_t i = 0; i < n; ++i) {
+            key[i] = deltaQuantize(channels[i], record);
+            out = putVarint(out, zigzag(key[i]));
+        }
+    } else {
+        *out++ = deltaPacket;
+        out = putVarint(out, keyframe);
+        uint8_t *bitmap = out;
+        memset(bitmap, 0, (n + 7) / 8);
+        out += (n + 7) / 8;
+        for (size_t i = 0; i < n; ++i) {
+            const int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(
+                deltaQuantize(channels[i], record)) -
+                static_cast<uint64_t>(key[i]));
+            if (delta) {
+                bitmap[i / 8] |= 1 << (i % 8);
+                out = putVarint(out, zigzag(delta));
+            }
+        }
+    }
+    ++sinceKeyframe;
+    return out - packet;
+}
+
+
+DeltaDecoder::Status
+DeltaDecoder::decode(const uint8_t *packet, size_t len, uint8_t *record)
+{
+    const uint8_t *in = packet;
+    const uint8_t *end = packet + len;
+    const size_t n = channels.size();
+    uint64_t number = 0;
+    if (!len || (*packet != deltaKeyframe && *packet != deltaPacket) ||
+            !(in = getVarint(in + 1, end, number))) {
+        return Status::MALFORMED;
+    }
+
+    if (*packet == deltaKeyframe) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t v;
+            if (!(in = getVarint(in, end, v))) {
+                return Status::MALFORMED;
+            }
+            values[i] = unzigzag(v);
+        }
+        if (in != end) {
+            return Status::MALFORMED;
+        }
+        // The first keyframe is used at once; later ones wait for a delta,
+        // and of two waiting the later numbered is kept.
+        const uint32_t id = static_cast<uint32_t>(number);
+        if (!haveKey) {
+            key = values;
+            keyframe = id;
+            haveKey = true;
+        } else if (id != keyframe && (!havePending ||
+                static_cast<int32_t>(id - pendingKeyframe) > 0)) {
+            pending = values;
+            pendingKeyframe = id;
+            havePending = true;
+        }
+    } else {
+        const uint8_t *bitmap = in;
+        if (static_cast<size_t>(end - in) < (n + 7) / 8) {
+            return Status::MALFORMED;
+        }
+        if (havePending && number == pendingKeyframe) {
+            key.swap(pending);
+            keyframe = pendingKeyframe;
+            havePending = false;
+        }
+        in += (n + 7) / 8;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t v = 0;
+            if ((bitmap[i / 8] & (1 << (i % 8))) &&
+                    !(in = getVarint(in, end, v))) {
+                return Status::MALFORMED;
+            }
+            values[i] = static_cast<int64_t>(static_cast<uint64_t>(key[i]) +
+                static_cast<uint64_t>(unzigzag(v)));
+        }
+        if (in != end) {
+            return Status::MALFORMED;
+        }
+        if (!haveKey || number != keyframe) {
+            return Status::NO_KEYFRAME;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        deltaDequantize(channels[i], values[i], record);
+    }
+    return Status::DECODED;
+}
+
+
+};  // namespace dfti
@@ -0,0 +1,216 @@
+/*!
+ *  \file deltacodec.hh
+ *  \brief Delta telemetry encoder and decoder.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+
+namespace dfti {
+
+
+/*! \brief Delta telemetry encoding.
+ *
+ *  For narrowband links (e.g. a 57600 baud radio) the telemetry records are
+ *  sent as deltas from the last keyframe instead of as they are. A record
+ *  is a packed structure described by a table of channels, each a number of
+ *  some type at some offset. Every channel is quantized to a step of its
+ *  own, so small changes vanish and the rest become small integers, which
+ *  are packed as zigzag LEB128 varints. The packets are
+ *
+ *  - keyframe: 'K', varint keyframe number, then every channel's quantized
+ *    value
+ *  - delta: 'D', varint keyframe number, a bitmap of the channels that
+ *    differ from the keyframe (bit i of byte i / 8 for channel i), then
+ *    those channels' differences from the keyframe
+ *
+ *  Deltas are from the keyframe and not the previous packet, so a lost
+ *  delta costs only itself, and a lost keyframe the deltas up to the next
+ *  one. The decoder gives back the record with every channel at its
+ *  quantized value.
+ *
+ *  Packets may arrive late, such as those FecDecoder recovers. So that a
+ *  late keyframe does not replace a newer one, a keyframe is only decoded
+ *  deltas from once a delta refers to it; until then deltas are decoded
+ *  from the previous one.
+ *
+ *  This is plain C++ with no Qt, so ground software can build it on its
+ *  own.
+ */
+
+
+//! Type of a delta codec channel.
+enum class ChannelType : uint8_t {
+    U8  = 0,  /// uint8_t
+    U16 = 1,  /// uint16_t
+    U32 = 2,  /// uint32_t
+    U64 = 3,  /// uint64_t
+    F32 = 4,  /// float
+    F64 = 5   /// double
+};
+
+
+//! A number in a record the delta codec carries.
+struct DeltaChannel
+{
+    //! Type.
+    ChannelType type;
+    //! Byte offset in the record.
+    uint32_t offset;
+    //! Quantization step; integer channels use it rounded, and at least 1.
+    double quantum;
+};
+
+
+//! Leading byte of a keyframe.
+const uint8_t deltaKeyframe = 'K';
+
+//! Leading byte of a delta packet.
+const uint8_t deltaPacket = 'D';
+
+
+//! Quantized value of a NaN float; saturation leaves it unused otherwise.
+const int64_t deltaNaN = INT64_MIN;
+
+
+//! Return the longest packet for a number of channels, bytes.
+size_t deltaMaxPacketLen(size_t channels);
+
+
+//! Quantize a channel of a record.
+/*!
+ *  \param channel Channel.
+ *  \param record Record.
+ *  \return Quantized value. NaN gives deltaNaN, and floats beyond the range
+ *      of int64_t, infinities included, saturate to +/-INT64_MAX.
+ */
+int64_t deltaQuantize(const DeltaChannel &channel, const uint8_t *record);
+
+
+//! Write a quantized value to a channel of a record.
+/*!
+ *  \param channel Channel.
+ *  \param q Quantized value; deltaNaN writes NaN to a float channel.
+ *  \param record Record.
+ */
+void deltaDequantize(const DeltaChannel &channel, int64_t q,
+    uint8_t *record);
+
+
+//! Delta telemetry encoder.
+class DeltaEncoder
+{
+public:
+    //! Constructor.
+    /*!
+     *  \param _channels Channels of the records.
+     *  \param _keyframeInterval Packets from one keyframe to the next.
+     */
+    DeltaEncoder(const std::vector<DeltaChannel> &_channels,
+        uint32_t _keyframeInterval);
+
+    //! Encode a record.
+    /*!
+     *  \param record Record.
+     *  \param packet Buffer of at least maxPacketLen() bytes.
+     *  \return Packet length.
+     */
+    size_t encode(const uint8_t *record, uint8_t *packet);
+
+    //! Make the next packet a keyframe.
+    void requestKeyframe(void) { sinceKeyframe = keyframeInterval; };
+
+    //! Return the longest packet, bytes.
+    size_t maxPacketLen(void) const {
+        return deltaMaxPacketLen(channels.size());
+    };
+
+private:
+    //! Channels.
+    std::vector<DeltaChannel> channels;
+
+    //! Packets from one keyframe to the next.
+    uint32_t keyframeInterval;
+
+    //! Packets since the last keyframe.
+    uint32_t sinceKeyframe;
+
+    //! Number of the last keyframe.
+    uint32_t keyframe{0};
+
+    //! Quantized values of the last keyframe.
+    std::vector<int64_t> key;
+};
+
+
+//! Delta telemetry decoder.
+class DeltaDecoder
+{
+public:
+    //! Result of decoding a packet.
+    enum class Status : uint8_t {
+        DECODED    = 0,  /// The record was decoded.
+        NO_KEYFRAME = 1, /// A delta from a keyframe that was not received.
+        MALFORMED  = 2   /// Not a packet of these channels.
+    };
+
+    //! Constructor.
+    /*!
+     *  \param _channels Channels of the records; the same as the encoder's.
+     */
+    explicit DeltaDecoder(const std::vector<DeltaChannel> &_channels);
+
+    //! Decode a packet.
+    /*!
+     *  \param packet Packet.
+     *  \param len Packet length.
+     *  \param record Record, written only if the packet is decoded.
+     *  \return Status.
+     */
+    Status decode(const uint8_t *packet, size_t len, uint8_t *record);
+
+private:
+    //! Channels.
+    std::vector<DeltaChannel> channels;
+
+    //! Flag to indicate a keyframe has been received.
+    bool haveKey{false};
+
+    //! Number of the last keyframe.
+    uint32_t keyframe{0};
+
+    //! Quantized values of the last keyframe.
+    std::vector<int64_t> key;
+
+    //! Flag to indicate a keyframe no delta has referred to yet.
+    bool havePending{false};
+
+    //! Number of that keyframe.
+    uint32_t pendingKeyframe{0};
+
+    //! Quantized values of that keyframe.
+    std::vector<int64_t> pending;
+
+    //! Quantized values of the packet being decoded.
+    std::vector<int64_t> values;
+};
+
+
+};  // namespace dfti
@@ -0,0 +1,394 @@
+/*!
+ *  \file fec.cc
+ *  \brief Forward error correction implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "fec.hh"
+
+
+namespace dfti {
+
+
+//! Groups the decoder keeps, so that packets may arrive out of order.
+static const size_t fecWindow = 4;
+
+
+//! GF(2^8) log and exponent tables, for the polynomial 0x11d.
+struct GaloisTables
+{
+    //! Constructor.
+    GaloisTables()
+    {
+        uint32_t x = 1;
+        for (uint32_t i = 0; i < 255; ++i) {
+            exp[i] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= 0x11d;
+            }
+        }
+        for (uint32_t i = 255; i < 512; ++i) {
+            exp[i] = exp[i - 255];
+        }
+        log[0] = 0;
+    }
+
+    //! Powers of the generator, twice over so that sums of logs need no
+    //! modulo.
+    uint8_t exp[512];
+    //! Logarithms.
+    uint8_t log[256];
+};
+
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+//! Return the GF(2^8) tables.
+static inline const GaloisTables &
+gf(void)
+{
+    static const GaloisTables tables;
+    return tables;
+}
+
+
+//! Multiply in GF(2^8).
+static inline uint8_t
+gfMul(uint8_t a, uint8_t b)
+{
+    return (a && b) ? gf().exp[gf().log[a] + gf().log[b]] : 0;
+}
+
+
+//! Divide in GF(2^8); b is nonzero.
+static inline uint8_t
+gfDiv(uint8_t a, uint8_t b)
+{
+    return a ? gf().exp[gf().log[a] + 255 - gf().log[b]] : 0;
+}
+
+
+//! Add c times a region to another in GF(2^8).
+static void
+gfMulAdd(uint8_t *dst, const uint8_t *src, size_t len, uint8_t c)
+{
+    if (c == 1) {
+        for (size_t i = 0; i < len; ++i) {
+            dst[i] ^= src[i];
+        }
+    } else if (c) {
+        const GaloisTables &t = gf();
+        const uint32_t logC = t.log[c];
+        for (size_t i = 0; i < len; ++i) {
+            if (src[i]) {
+                dst[i] ^= t.exp[t.log[src[i]] + logC];
+            }
+        }
+    }
+}
+
+
+//! Return the coefficient of datagram i in parity packet j.
+/*!
+ *  A Cauchy matrix, 1 / (x_j + y_i) with x_j = k + j and y_i = i, with
+ *  each column scaled so that the first row is all ones. Every square
+ *  submatrix stays nonsingular, so any k packets of a group recover it.
+ */
+static inline uint8_t
+fecCoefficient(uint8_t k, uint8_t j, uint8_t i)
+{
+    return gfDiv(k ^ i, static_cast<uint8_t>((k + j) ^ i));
+}
+
+
+//! Write a packet header.
+static inline void
+fecWriteHeader(uint8_t *packet, bool parity, uint16_t group, uint8_t index,
+    uint8_t k, uint8_t m)
+{
+    packet[0] = parity ? fecParity : fecDatagram;
+    packet[1] = static_cast<uint8_t>(group);
+    packet[2] = static_cast<uint8_t>(group >> 8);
+    packet[3] = index;
+    packet[4] = k;
+    packet[5] = m;
+}
+
+
+bool
+fecParseHeader(const uint8_t *packet, size_t len, FecHeader &header)
+{
+    if (len < fecHeaderLen ||
+            (packet[0] != fecDatagram && packet[0] != fecParity)) {
+        return false;
+    }
+    header.parity = (packet[0] == fecParity);
+    header.group = static_cast<uint16_t>(packet[1] | (packet[2] << 8));
+    header.index = packet[3];
+    header.dataPackets = packet[4];
+    header.parityPackets = packet[5];
+    return header.dataPackets &&
+        header.dataPackets + header.parityPackets <= 256 &&
+        header.index < (header.parity ? header.parityPackets :
+            header.dataPackets) &&
+        (!header.parity || len >= fecHeaderLen + 2);
+}
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+FecEncoder::FecEncoder(uint8_t _dataPackets, uint8_t _parityPackets,
+    size_t _maxPayloadLen)
+: dataPackets(_dataPackets ? _dataPackets : 1),
+  parityPackets(_parityPackets), maxPayloadLen(_maxPayloadLen),
+  parityBufs(_parityPackets,
+      std::vector<uint8_t>(fecHeaderLen + 2 + _maxPayloadLen, 0))
+{
+    for (uint8_t j = 0; j < parityPackets; ++j) {
+        for (uint8_t i = 0; i < dataPackets; ++i) {
+            coefficients.push_back(fecCoefficient(dataPackets, j, i));
+        }
+    }
+}
+
+
+FecDecoder::FecDecoder(size_t _maxPayloadLen)
+: maxPayloadLen(_maxPayloadLen), groups(fecWindow)
+{
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+size_t
+FecEncoder::encode(const uint8_t *payload, size_t len, uint8_t *packet)
+{
+    if (len > maxPayloadLen) {
+        return 0;
+    }
+    if (!index) {
+        for (std::vector<uint8_t> &buf : parityBufs) {
+            memset(buf.data() + fecHeaderLen, 0, 2 + groupMaxLen);
+        }
+        groupMaxLen = 0;
+    }
+    ready = 0;
+
+    fecWriteHeader(packet, false, group, index, dataPackets, parityPackets);
+    memcpy(packet + fecHeaderLen, payload, len);
+    const uint8_t lenBytes[2] = {static_cast<uint8_t>(len),
+        static_cast<uint8_t>(len >> 8)};
+    for (uint8_t j = 0; j < parityPackets; ++j) {
+        const uint8_t c = coefficients[j * dataPackets + index];
+        uint8_t *symbol = parityBufs[j].data() + fecHeaderLen;
+        gfMulAdd(symbol, lenBytes, 2, c);
+        gfMulAdd(symbol + 2, payload, len, c);
+    }
+    if (len > groupMaxLen) {
+        groupMaxLen = len;
+    }
+
+    if (++index == dataPackets) {
+        for (uint8_t j = 0; j < parityPackets; ++j) {
+            fecWriteHeader(parityBufs[j].data(), true, group, j, dataPackets,
+                parityPackets);
+        }
+        ready = parityPackets;
+        index = 0;
+        ++group;
+    }
+    return fecHeaderLen + len;
+}
+
+
+size_t
+FecDecoder::receive(const uint8_t *packet, size_t len)
+{
+    ready.clear();
+    ++m_stats.packets;
+    FecHeader header;
+    if (!fecParseHeader(packet, len, header) ||
+            len - fecHeaderLen > 2 + maxPayloadLen) {
+        ++m_stats.malformed;
+        return 0;
+    }
+
+    // Retire the group this one takes the place of, unless it is newer.
+    Group &group = groups[header.group % fecWindow];
+    if (group.active && group.id != header.group) {
+        if (static_cast<int16_t>(header.group - group.id) < 0) {
+            ++m_stats.late;
+            return 0;
+        }
+        m_stats.unrecovered += group.dataPackets - group.dataCount;
+        group.active = false;
+    }
+    if (!group.active) {
+        const size_t cap = 2 + maxPayloadLen;
+        group.active = true;
+        group.id = header.group;
+        group.dataPackets = header.dataPackets;
+        group.parityPackets = header.parityPackets;
+        group.symbolLen = 0;
+        group.data.assign(group.dataPackets * cap, 0);
+        group.parity.assign(group.parityPackets * cap, 0);
+        group.haveData.assign(group.dataPackets, false);
+        group.haveParity.assign(group.parityPackets, false);
+        group.dataCount = 0;
+        group.parityCount = 0;
+    } else if (group.dataPackets != header.dataPackets ||
+            group.parityPackets != header.parityPackets) {
+        ++m_stats.malformed;
+        return 0;
+    }
+
+    const size_t cap = 2 + maxPayloadLen;
+    const size_t bodyLen = len - fecHeaderLen;
+    const uint8_t *body = packet + fecHeaderLen;
+    if (header.parity) {
+        if (group.haveParity[header.index]) {
+            return 0;
+        }
+        if ((group.symbolLen && bodyLen != group.symbolLen) ||
+                bodyLen > cap) {
+            ++m_stats.malformed;
+            return 0;
+        }
+        group.symbolLen = bodyLen;
+        memcpy(&group.parity[header.index * cap], body, bodyLen);
+        group.haveParity[header.index] = true;
+        ++group.parityCount;
+    } else {
+        if (group.haveData[header.index]) {
+            return 0;
+        }
+        if (bodyLen > maxPayloadLen ||
+                (group.symbolLen && bodyLen + 2 > group.symbolLen)) {
+            ++m_stats.malformed;
+            return 0;
+        }
+        uint8_t *symbol = &group.data[header.index * cap];
+        symbol[0] = static_cast<uint8_t>(bodyLen);
+        symbol[1] = static_cast<uint8_t>(bodyLen >> 8);
+        memcpy(symbol + 2, body, bodyLen);
+        group.haveData[header.index] = true;
+        ++group.dataCount;
+        ready.push_back({symbol + 2, bodyLen, false});
+    }
+
+    if (group.parityCount && group.dataCount < group.dataPackets &&
+            group.dataCount + group.parityCount >= group.dataPackets) {
+        recover(group);
+    }
+    return ready.size();
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+void
+FecDecoder::recover(Group &group)
+{
+    const uint8_t k = group.dataPackets;
+    const size_t cap = 2 + maxPayloadLen;
+    const size_t symbolLen = group.symbolLen;
+
+    // The missing datagrams, and as many parity packets.
+    std::vector<uint8_t> missing;
+    std::vector<uint8_t> rows;
+    for (uint8_t i = 0; i < k; ++i) {
+        if (!group.haveData[i]) {
+            missing.push_back(i);
+        }
+    }
+    for (uint8_t j = 0; j < group.parityPackets &&
+            rows.size() < missing.size(); ++j) {
+        if (group.haveParity[j]) {
+            rows.push_back(j);
+        }
+    }
+    const size_t e = missing.size();
+
+    // Take the received datagrams out of the parity, leaving the missing
+    // ones times their coefficients.
+    syndromes.assign(e * symbolLen, 0);
+    matrix.assign(e * e, 0);
+    for (size_t r = 0; r < e; ++r) {
+        uint8_t *s = &syndromes[r * symbolLen];
+        memcpy(s, &group.parity[rows[r] * cap], symbolLen);
+        for (uint8_t i = 0; i < k; ++i) {
+            if (group.haveData[i]) {
+                gfMulAdd(s, &group.data[i * cap], symbolLen,
+                    fecCoefficient(k, rows[r], i));
+            }
+        }
+        for (size_t c = 0; c < e; ++c) {
+            matrix[r * e + c] = fecCoefficient(k, rows[r], missing[c]);
+        }
+    }
+
+    // Invert the coefficients of the missing datagrams (Gauss-Jordan).
+    inverse.assign(e * e, 0);
+    for (size_t r = 0; r < e; ++r) {
+        inverse[r * e + r] = 1;
+    }
+    for (size_t c = 0; c < e; ++c) {
+        size_t pivot = c;
+        while (pivot < e && !matrix[pivot * e + c]) {
+            ++pivot;
+        }
+        if (pivot == e) {
+            return;
+        }
+        for (size_t x = 0; x < e; ++x) {
+            std::swap(matrix[c * e + x], matrix[pivot * e + x]);
+            std::swap(inverse[c * e + x], inverse[pivot * e + x]);
+        }
+        const uint8_t scale = gfDiv(1, matrix[c * e + c]);
+        for (size_t x = 0; x < e; ++x) {
+            matrix[c * e + x] = gfMul(matrix[c * e + x], scale);
+            inverse[c * e + x] = gfMul(inverse[c * e + x], scale);
+        }
+        for (size_t r = 0; r < e; ++r) {
+            const uint8_t f = matrix[r * e + c];
+            if (r == c || !f) {
+                continue;
+            }
+            for (size_t x = 0; x < e; ++x) {
+                matrix[r * e + x] ^= gfMul(f, matrix[c * e + x]);
+                inverse[r * e + x] ^= gfMul(f, inverse[c * e + x]);
+            }
+        }
+    }
+
+    for (size_t c = 0; c < e; ++c) {
+        uint8_t *symbol = &group.data[missing[c] * cap];
+        memset(symbol, 0, symbolLen);
+        for (size_t r = 0; r < e; ++r) {
+            gfMulAdd(symbol, &syndromes[r * symbolLen], symbolLen,
+                inverse[c * e + r]);
+        }
+        group.haveData[missing[c]] = true;
+        ++group.dataCount;
+        const size_t len = symbol[0] | (symbol[1] << 8);
+        if (len + 2 > symbolLen) {
+            ++m_stats.malformed;
+            continue;
+        }
+        ++m_stats.recovered;
+        ready.push_back({symbol + 2, len, true});
+    }
+}
+
+
+};  // namespace dfti
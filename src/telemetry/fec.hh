@@ -0,0 +1,276 @@
+/*!
+ *  \file fec.hh
+ *  \brief Forward error correction for telemetry datagrams.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+namespace dfti {
+
+
+/*! \brief Forward error correction over parity groups.
+ *
+ *  Over a lossy link with no retransmission, datagrams are sent in groups
+ *  of k, each followed by m parity packets, and any k of the k + m packets
+ *  of a group give back the k datagrams. The parity is a systematic
+ *  Reed-Solomon (Cauchy) erasure code over GF(2^8), scaled so that the
+ *  first parity packet is the XOR of the datagrams; m = 1 is plain XOR
+ *  parity.
+ *
+ *  Every packet starts with a header:
+ *
+ *  | Byte | Contents                                     |
+ *  |------|----------------------------------------------|
+ *  | 0    | 'F' for a datagram, 'P' for a parity packet  |
+ *  | 1-2  | group number, little endian                  |
+ *  | 3    | index in the group: datagram 0 to k - 1, or  |
+ *  |      | parity packet 0 to m - 1                     |
+ *  | 4    | k                                            |
+ *  | 5    | m                                            |
+ *
+ *  A datagram follows its header unchanged. The parity is computed over
+ *  each datagram's length (2 bytes, little endian) followed by its bytes,
+ *  zero padded to the longest datagram of the group, which is what follows
+ *  a parity packet's header.
+ *
+ *  Datagrams are passed on as soon as they arrive; lost ones are recovered
+ *  once enough of their group has arrived, after the datagrams that
+ *  followed them.
+ *
+ *  This is plain C++ with no Qt, so ground software can build it on its
+ *  own.
+ */
+
+
+//! Leading byte of a datagram.
+const uint8_t fecDatagram = 'F';
+
+//! Leading byte of a parity packet.
+const uint8_t fecParity = 'P';
+
+//! Length of the packet header.
+const size_t fecHeaderLen = 6;
+
+
+//! Header of a forward error correction packet.
+struct FecHeader
+{
+    //! Flag to indicate a parity packet.
+    bool parity;
+    //! Group number.
+    uint16_t group;
+    //! Index in the group.
+    uint8_t index;
+    //! Datagrams per group.
+    uint8_t dataPackets;
+    //! Parity packets per group.
+    uint8_t parityPackets;
+};
+
+
+//! Read and check a packet header.
+/*!
+ *  \param packet Packet.
+ *  \param len Packet length.
+ *  \param header Set to the header.
+ *  \return False if the packet is not a forward error correction packet.
+ */
+bool fecParseHeader(const uint8_t *packet, size_t len, FecHeader &header);
+
+
+//! Forward error correction encoder.
+class FecEncoder
+{
+public:
+    //! Constructor.
+    /*!
+     *  \param _dataPackets Datagrams per group, k.
+     *  \param _parityPackets Parity packets per group, m; k + m is at most
+     *      256.
+     *  \param _maxPayloadLen Longest datagram, bytes.
+     */
+    FecEncoder(uint8_t _dataPackets, uint8_t _parityPackets,
+        size_t _maxPayloadLen);
+
+    //! Add a datagram to the group.
+    /*!
+     *  \param payload Datagram.
+     *  \param len Datagram length, at most the longest given.
+     *  \param packet Buffer of at least maxPacketLen() bytes.
+     *  \return Packet length, or 0 if the datagram is too long.
+     */
+    size_t encode(const uint8_t *payload, size_t len, uint8_t *packet);
+
+    //! Return the number of parity packets completed by the last encode().
+    uint8_t parityReady(void) const { return ready; };
+
+    //! Return a parity packet completed by the last encode().
+    const uint8_t *parity(uint8_t j) const { return parityBufs[j].data(); };
+
+    //! Return the length of the completed parity packets.
+    size_t parityLen(void) const { return fecHeaderLen + 2 + groupMaxLen; };
+
+    //! Return the longest packet, bytes.
+    size_t maxPacketLen(void) const {
+        return fecHeaderLen + 2 + maxPayloadLen;
+    };
+
+private:
+    //! Datagrams per group.
+    uint8_t dataPackets;
+
+    //! Parity packets per group.
+    uint8_t parityPackets;
+
+    //! Longest datagram.
+    size_t maxPayloadLen;
+
+    //! Group number.
+    uint16_t group{0};
+
+    //! Index of the next datagram in the group.
+    uint8_t index{0};
+
+    //! Longest datagram of the group.
+    size_t groupMaxLen{0};
+
+    //! Parity packets completed by the last encode().
+    uint8_t ready{0};
+
+    //! Parity packets, accumulated as datagrams are added.
+    std::vector<std::vector<uint8_t>> parityBufs;
+
+    //! Parity coefficients, m rows of k.
+    std::vector<uint8_t> coefficients;
+};
+
+
+//! Forward error correction decoder statistics.
+struct FecStats
+{
+    //! Packets received.
+    uint64_t packets{0};
+    //! Datagrams recovered from parity.
+    uint64_t recovered{0};
+    //! Datagrams of past groups that could not be recovered.
+    uint64_t unrecovered{0};
+    //! Packets of groups too old to recover any more.
+    uint64_t late{0};
+    //! Packets that were not forward error correction packets.
+    uint64_t malformed{0};
+};
+
+
+//! Forward error correction decoder.
+class FecDecoder
+{
+public:
+    //! Constructor.
+    /*!
+     *  \param _maxPayloadLen Longest datagram, bytes.
+     */
+    explicit FecDecoder(size_t _maxPayloadLen);
+
+    //! Receive a packet.
+    /*!
+     *  \param packet Packet.
+     *  \param len Packet length.
+     *  \return Number of datagrams it made available, its own and any it
+     *      let be recovered, which are valid until the next receive().
+     */
+    size_t receive(const uint8_t *packet, size_t len);
+
+    //! Return a datagram made available by the last receive().
+    /*!
+     *  \param i Index, less than the last receive() returned.
+     *  \param len Set to the datagram length.
+     *  \return Datagram.
+     */
+    const uint8_t *payload(size_t i, size_t &len) const {
+        len = ready[i].len;
+        return ready[i].bytes;
+    };
+
+    //! Return true if a datagram made available was recovered from parity.
+    bool recovered(size_t i) const { return ready[i].recovered; };
+
+    //! Return the statistics.
+    FecStats stats(void) const { return m_stats; };
+
+private:
+    //! A group being received.
+    struct Group
+    {
+        //! Flag to indicate the group is in use.
+        bool active{false};
+        //! Group number.
+        uint16_t id{0};
+        //! Datagrams per group.
+        uint8_t dataPackets{0};
+        //! Parity packets per group.
+        uint8_t parityPackets{0};
+        //! Length of the parity, or 0 before a parity packet arrives.
+        size_t symbolLen{0};
+        //! Datagram lengths and bytes, zero padded.
+        std::vector<uint8_t> data;
+        //! Parity packets, without their headers.
+        std::vector<uint8_t> parity;
+        //! Flags to indicate the datagrams received or recovered.
+        std::vector<bool> haveData;
+        //! Flags to indicate the parity packets received.
+        std::vector<bool> haveParity;
+        //! Datagrams received or recovered.
+        uint32_t dataCount{0};
+        //! Parity packets received.
+        uint32_t parityCount{0};
+    };
+
+    //! A datagram made available by receive().
+    struct Ready
+    {
+        //! Bytes.
+        const uint8_t *bytes;
+        //! Length.
+        size_t len;
+        //! Flag to indicate it was recovered from parity.
+        bool recovered;
+    };
+
+    //! Recover the missing datagrams of a group.
+    void recover(Group &group);
+
+    //! Longest datagram.
+    size_t maxPayloadLen;
+
+    //! Groups being received, indexed by group number modulo their count.
+    std::vector<Group> groups;
+
+    //! Datagrams made available by the last receive().
+    std::vector<Ready> ready;
+
+    //! Scratch space for recovery.
+    std::vector<uint8_t> matrix, inverse, syndromes;
+
+    //! Statistics.
+    FecStats m_stats;
+};
+
+
+};  // namespace dfti
@@ -35,75 +35,67 @@ SerialSensor(_settings, _parent)
 // ----------------------------------------------------------------------------
 //  Public functions
 // ----------------------------------------------------------------------------
+void
+uADC::parseBytes(const char *bytes, qint64 len)
+{
+    // Parsing empties the framer down to one partial line, so feeding it in
+    // pieces of at most its capacity never drops bytes.
+    while (len > 0) {
+        const quint32 n = framer.write(bytes, len);
+        bytes += n;
+        len -= n;
+        parsePackets();
+    }
+}
 
 // ----------------------------------------------------------------------------
 // Public Slots
 // ----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
 void
-uADC::readData(void)
+uADC::parsePackets(void)
 {
-    // qDebug() << "cur bytes" << _port->bytesAvailable();
-    // Add available bytes to the buffer up to the first newline.
-    _buf.append(_port->readLine());
-    // If there is a newline in the buffer, then we should have a full packet
-    // from the uADC, which we extract from the buffer and then parse.
-    if (_buf.contains(uadcTerm)) {
-        // We assume that the packet in the buffer is exactly the packet
-        // length. This may not be true when we start out, in which case the
-        // packet will fail validation.
-        QByteArray pkt = _buf.left(uadcPktLen);
-        if (settings->debugSerial()) {
-            qDebug() << "buffer:" << _buf;
-            qDebug() << "packet:" << pkt;
-        }
-        // We remove everything up to the terminating character, which should
-        // make sure after the first time we get the terminator every packet
-        // after is valid.
-        _buf.remove(0, _buf.lastIndexOf(uadcTerm) + 1);
-        // Validate the packet and parse the data structure. If validation
-        // fails, then display a warning.
-        if (validateUADCChecksum(pkt)) {
-            // Parse the data structure.
-            // Packet ID
-            QByteArray _idBuf = pkt.left(5);
-            data.id = _idBuf.toInt();
-            // Indicated Airspeed
-            QByteArray _iasMpsBuf = pkt.mid(uadcPktIasPos, uadcPktIasLen);
-            data.iasMps = _iasMpsBuf.toFloat();
-            // Angle-of-Attack
-            QByteArray _aoaDegBuf = pkt.mid(uadcPktAoAPos, uadcPktAoALen);
-            data.aoaDeg = _aoaDegBuf.toFloat();
-            // Sideslip Angle
-            QByteArray _aosDegBuf = pkt.mid(uadcPktAoSPos, uadcPktAoSLen);
-            data.aosDeg = _aosDegBuf.toFloat();
-            // Pressure Altitude
-            QByteArray _altMBuf = pkt.mid(uadcPktAltPos, uadcPktAltLen);
-            data.altM = _altMBuf.toInt();
-            // Total Pressure
-            QByteArray _ptPaBuf = pkt.mid(uadcPktPtPos, uadcPktPtLen);
-            data.ptPa = _ptPaBuf.toInt();
-            // Static Pressure
-            QByteArray _psPaBuf = pkt.mid(uadcPktPsPos, uadcPktPsLen);
-            data.psPa = _psPaBuf.toInt();
-            // Emit the signal.
-            emit measurementUpdate(data);
-            // If we are in the verbose debugging mode, print the parsed data.
-            if (settings->debugData()) {
-                qDebug() << "ID :" << data.id
-                         << "IAS:" << data.iasMps
-                         << "AoA:" << data.aoaDeg
-                         << "AoS:" << data.aosDeg
-                         << "ALT:" << data.altM
-                         << "Pt :" << data.ptPa
-                         << "Ps :" << data.psPa;
-            }
-        } else {
-            if (settings->debugData()) {
-                qDebug() << "[INFO ]  packet failed validation";
-            }
-        }
+    // Every newline in the buffer ends a packet from the uADC. The first
+    // one after opening the port may be partial, in which case it fails
+    // validation and is dropped by the framer.
+    const quint64 failures = stats.checksumFailures;
+    FrameView frame;
+    while (framer.next(frame)) {
+        parsePacket(frame.data, frame.len);
+    }
+    if (settings->debugData() && (stats.checksumFailures != failures)) {
+        qDebug() << "[INFO ]  packets failed validation:"
+                 << stats.checksumFailures - failures;
+    }
+}
+
+
+void
+uADC::parsePacket(const char *pkt, quint32 len)
+{
+    if (settings->debugSerial()) {
+        qDebug() << "packet:" << QByteArray(pkt, len);
+    }
+    // Decode, stamp, hand the measurement to the consumer queues and emit
+    // the signal.
+    decodeUADCFields(pkt, data);
+    data.timeUsec = rxTimeUsec;
+    data.rxTimeNs = rxTimeNs;
+    publish(data);
+    emit measurementUpdate(data);
+    // If we are in the verbose debugging mode, print the parsed data.
+    if (settings->debugData()) {
+        qDebug() << "ID :" << data.id
+                 << "IAS:" << data.iasMps
+                 << "AoA:" << data.aoaDeg
+                 << "AoS:" << data.aosDeg
+                 << "ALT:" << data.altM
+                 << "Pt :" << data.ptPa
+                 << "Ps :" << data.psPa;
     }
-    return;
 }
 
 
@@ -111,19 +103,62 @@ uADC::readData(void)
 //  Functions
 // ----------------------------------------------------------------------------
 bool
-validateUADCChecksum(QByteArray pkt)
+validateUADCChecksum(const char *pkt, size_t len)
 {
     bool ok;
     quint8 cksum = 0;
+    // Partial packets (e.g. the first one after opening the port) can't be
+    // valid.
+    if (len < uadcPktCksumPos + 2u) {
+        return false;
+    }
     // Extract checksum byte.
-    QByteArray _cksumBytes = pkt.mid(uadcPktCksumPos, 2);
-    quint8 cksumByte = static_cast<quint8>(_cksumBytes.toInt(&ok, 16));
+    quint8 cksumByte = static_cast<quint8>(
+        hexToInt(pkt + uadcPktCksumPos, 2, &ok));
     // Calculate checksum.
     for (quint8 i = 0; i < uadcPktCksumPos; ++i) {
-        cksum ^= static_cast<quint8>(pkt.at(i));
+        cksum ^= static_cast<quint8>(pkt[i]);
     }
     return ok ? (cksum == cksumByte ? true : false) : false;
 }
 
 
+bool
+validateUADCChecksum(QByteArray pkt)
+{
+    return validateUADCChecksum(pkt.constData(), pkt.size());
+}
+
+
+bool
+decodeUADCPacket(const char *pkt, size_t len, uADCData &data)
+{
+    if (!validateUADCChecksum(pkt, len)) {
+        return false;
+    }
+    decodeUADCFields(pkt, data);
+    return true;
+}
+
+
+void
+decodeUADCFields(const char *pkt, uADCData &data)
+{
+    // Packet ID
+    data.id = decimalToInt(pkt, 5);
+    // Indicated Airspeed
+    data.iasMps = decimalToFloat(pkt + uadcPktIasPos, uadcPktIasLen);
+    // Angle-of-Attack
+    data.aoaDeg = decimalToFloat(pkt + uadcPktAoAPos, uadcPktAoALen);
+    // Sideslip Angle
+    data.aosDeg = decimalToFloat(pkt + uadcPktAoSPos, uadcPktAoSLen);
+    // Pressure Altitude
+    data.altM = decimalToInt(pkt + uadcPktAltPos, uadcPktAltLen);
+    // Total Pressure
+    data.ptPa = decimalToInt(pkt + uadcPktPtPos, uadcPktPtLen);
+    // Static Pressure
+    data.psPa = decimalToInt(pkt + uadcPktPsPos, uadcPktPsLen);
+}
+
+
 };  // namespace dfti
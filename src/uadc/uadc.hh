@@ -21,6 +21,9 @@
 // dfti
 #include "sensor/serialsensor.hh"
 #include "settings/settings.hh"
+#include "util/decimal.hh"
+#include "util/spscqueue.hh"
+#include "util/util.hh"
 
 
 namespace dfti {
@@ -63,12 +66,36 @@ const quint8 uadcPktPsLen = 6;
  *  The checksum is a simple byte-wise XOR up to but not including the
  *  checksum byte itself.
  *
+ *  \param pkt A full uADC packet to validate.
+ *  \param len Packet length.
+ *  \return True if the packet checksum is correct.
+*/
+bool validateUADCChecksum(const char *pkt, size_t len);
+
+
+//! Validate the uADC packet checksum.
+/*!
  *  \param pkt A full uADC packet to validate.
  *  \return True if the packet checksum is correct.
 */
 bool validateUADCChecksum(QByteArray pkt);
 
 
+//! uADC packet format, for DelimitedFraming.
+struct uADCFormat
+{
+    //! Lines longer than two packets are dropped.
+    static const quint32 maxFrameLen = 2 * uadcPktLen;
+    //! Line terminator.
+    static char terminator(void) { return uadcTerm; }
+    //! Check the checksum.
+    static bool check(const char *frame, quint32 len)
+    {
+        return validateUADCChecksum(frame, len);
+    }
+};
+
+
 //! Structure to hold uADC data.
 struct uADCData
 {
@@ -97,9 +124,35 @@ struct uADCData
     quint32 ptPa = 0;
     //! Static Pressure, Pa.
     quint32 psPa = 0;
+    //! Host receive time, microseconds since the Unix epoch.
+    quint64 timeUsec = 0;
+    //! Host monotonic receive time, nanoseconds (see getMonotonicNsec).
+    quint64 rxTimeNs = 0;
 };
 
 
+//! Validate and decode a uADC packet.
+/*!
+ *  The fields are decoded in place from their fixed offsets, without any
+ *  allocation, to the same values QByteArray::toFloat and toInt give.
+ *
+ *  \param pkt A full uADC packet.
+ *  \param len Packet length.
+ *  \param data Structure to decode into; only written if the packet is
+ *      valid, and the receive time is left alone.
+ *  \return True if the packet checksum is correct.
+ */
+bool decodeUADCPacket(const char *pkt, size_t len, uADCData &data);
+
+
+//! Decode a uADC packet that has already been validated.
+/*!
+ *  \param pkt A full uADC packet with a correct checksum.
+ *  \param data Structure to decode into; the receive time is left alone.
+ */
+void decodeUADCFields(const char *pkt, uADCData &data);
+
+
 //! Serial driver to acquire data from a Micro Air Data Computer.
 /*!
  *  Reads in data from an Aeroprobe Micro Air Data Computer over RS-232 serial
@@ -117,7 +170,7 @@ struct uADCData
  *      - static pressure, Pa
  *      - checksum byte
  */
-class uADC : public SerialSensor
+class uADC : public SerialSensor, public MeasurementPublisher<uADCData>
 {
     Q_OBJECT;
 
@@ -129,23 +182,35 @@ public:
      */
     explicit uADC(Settings *_settings, QObject* _parent = nullptr);
 
-public slots:
-    //! Slot to read in data over serial and parse complete packets.
-    void readData(void);
-
 signals:
     //! Emitted to share new uADCData.
     void measurementUpdate(uADCData data);
 
+protected:
+    //! Parse a chunk of raw bytes from the uADC.
+    /*!
+     *  \param bytes Raw bytes.
+     *  \param len Number of bytes.
+     */
+    void parseBytes(const char *bytes, qint64 len);
+
 private:
-    //! Buffer
+    //! Packet framer
+    /*!
+     *  Buffers the raw bytes we read in from the serial port until complete
+     *  lines can be parsed out of them. 1 kB is over a dozen packets.
+     */
+    Framer<DelimitedFraming<uADCFormat>, 1024> framer{stats};
+
+    //! Publish every complete, valid line in the framer.
+    void parsePackets(void);
+
+    //! Decode and publish one packet.
     /*!
-     *  Buffer to hold the raw bytes we read in from the serial port. Since we
-     *  do not necessarily read in complete packets at a time, we need to let
-     *  the buffer fill up until we have a complete packet and then parse it,
-     *  which is the purpose of this buffer.
+     *  \param pkt Start of one valid line from the uADC.
+     *  \param len Line length.
      */
-    QByteArray _buf;
+    void parsePacket(const char *pkt, quint32 len);
 
     //! Data structure.
     uADCData data;
@@ -0,0 +1,174 @@
+/*!
+ *  \file bytering.hh
+ *  \brief Fixed-capacity byte ring buffer for serial receive paths.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cstring>
+// 3rd party
+#include <QtGlobal>
+
+
+namespace dfti {
+
+
+//! Fixed-capacity circular byte buffer.
+/*!
+ *  Holds raw bytes read from a sensor until complete packets can be parsed
+ *  out of them. Unlike appending to and removing from the front of a
+ *  QByteArray, consuming bytes only advances an index, so dropping a parsed
+ *  packet costs the same no matter how much is buffered behind it.
+ *
+ *  Not thread safe; the buffer is owned by the sensor thread.
+ *
+ *  \tparam Capacity Size in bytes, must be a power of two.
+ *  \tparam Slack Extra bytes after the storage, so that view() can return
+ *      up to Slack bytes contiguously even where they wrap.
+ */
+template <quint32 Capacity, quint32 Slack = 0>
+class ByteRing
+{
+    static_assert(Capacity && !(Capacity & (Capacity - 1)),
+        "ByteRing capacity must be a power of two");
+
+public:
+    //! Contiguous free space to read into.
+    /*!
+     *  The free space may wrap, in which case only the part up to the end of
+     *  the storage is returned; call again after commit() for the rest.
+     *
+     *  \param len Set to the number of bytes that may be written.
+     *  \return Pointer to the first free byte.
+     */
+    char *writeRegion(quint32 &len)
+    {
+        const quint32 head = m_head & mask;
+        const quint32 free = Capacity - size();
+        len = free < Capacity - head ? free : Capacity - head;
+        return m_data + head;
+    }
+
+    //! Mark bytes written through writeRegion() as buffered.
+    /*!
+     *  \param len Number of bytes written.
+     */
+    void commit(quint32 len) { m_head += len; }
+
+    //! Copy bytes into the buffer.
+    /*!
+     *  \param src Source bytes.
+     *  \param len Number of bytes.
+     *  \return Number of bytes copied, less than len if the buffer filled.
+     */
+    quint32 write(const char *src, quint32 len)
+    {
+        quint32 done = 0;
+        while (done < len) {
+            quint32 room;
+            char *dst = writeRegion(room);
+            if (!room) {
+                break;
+            }
+            const quint32 n = room < len - done ? room : len - done;
+            memcpy(dst, src + done, n);
+            commit(n);
+            done += n;
+        }
+        return done;
+    }
+
+    //! Byte at an offset from the oldest buffered byte.
+    /*!
+     *  \param offset Offset, must be less than size().
+     */
+    char at(quint32 offset) const { return m_data[(m_tail + offset) & mask]; }
+
+    //! Copy buffered bytes out without consuming them.
+    /*!
+     *  \param dst Destination, at least len bytes.
+     *  \param len Number of bytes, must not exceed size().
+     */
+    void peek(char *dst, quint32 len) const
+    {
+        const quint32 tail = m_tail & mask;
+        const quint32 first = len < Capacity - tail ? len : Capacity - tail;
+        memcpy(dst, m_data + tail, first);
+        memcpy(dst + first, m_data, len - first);
+    }
+
+    //! Contiguous view of the oldest buffered bytes, without consuming them.
+    /*!
+     *  If the bytes wrap around the end of the storage, the wrapped part is
+     *  copied into the slack after it; otherwise nothing is copied. The view
+     *  is valid until the bytes are discarded.
+     *
+     *  \param len Number of bytes, must not exceed size(), nor Slack if they
+     *      may wrap.
+     *  \return Pointer to the oldest buffered byte.
+     */
+    const char *view(quint32 len)
+    {
+        const quint32 tail = m_tail & mask;
+        if (tail + len > Capacity) {
+            Q_ASSERT(tail + len - Capacity <= Slack);
+            memcpy(m_data + Capacity, m_data, tail + len - Capacity);
+        }
+        return m_data + tail;
+    }
+
+    //! Offset of the first occurrence of a byte.
+    /*!
+     *  \param c Byte to look for.
+     *  \param from Offset to start searching at.
+     *  \return Offset of the byte, or size() if it is not buffered.
+     */
+    quint32 indexOf(char c, quint32 from = 0) const
+    {
+        const quint32 n = size();
+        for (quint32 i = from; i < n; ++i) {
+            if (at(i) == c) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    //! Drop the oldest bytes.
+    /*!
+     *  \param len Number of bytes, must not exceed size().
+     */
+    void discard(quint32 len) { m_tail += len; }
+
+    //! Number of buffered bytes.
+    quint32 size(void) const { return m_head - m_tail; }
+
+    //! Total storage in bytes.
+    static quint32 capacity(void) { return Capacity; }
+
+private:
+    //! Index mask.
+    static const quint32 mask = Capacity - 1;
+
+    //! Write position (free running).
+    quint32 m_head{0};
+
+    //! Read position (free running).
+    quint32 m_tail{0};
+
+    //! Storage, followed by the slack for views that wrap.
+    char m_data[Capacity + Slack];
+};
+
+
+};  // namespace dfti
@@ -0,0 +1,212 @@
+/*!
+ *  \file clocksync.cc
+ *  \brief Host to GPS clock correlation implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "clocksync.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+void
+ClockSync::addSample(quint64 monoNs, quint64 gpsNs)
+{
+    const Point p{monoNs, static_cast<qint64>(gpsNs - monoNs)};
+    if (haveBucket && monoNs - bucketStartNs >= bucketNs) {
+        closeBucket();
+        haveBucket = false;
+    }
+    if (!haveBucket) {
+        haveBucket = true;
+        bucketStartNs = monoNs;
+        best = p;
+    } else if (p.offsetNs > best.offsetNs) {
+        best = p;
+    }
+    QMutexLocker lock(&mutex);
+    ++st.samples;
+}
+
+
+quint64
+ClockSync::toGpsNs(quint64 monoNs) const
+{
+    Fit f;
+    {
+        QMutexLocker lock(&mutex);
+        f = published;
+    }
+    if (!f.valid) {
+        return 0;
+    }
+    return monoNs + f.refOffsetNs + std::llround(predict(f, monoNs));
+}
+
+
+bool
+ClockSync::locked(void) const
+{
+    QMutexLocker lock(&mutex);
+    return published.valid;
+}
+
+
+ClockSyncStats
+ClockSync::stats(void) const
+{
+    QMutexLocker lock(&mutex);
+    return st;
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+void
+ClockSync::closeBucket(void)
+{
+    if (fit.valid) {
+        const double residual = static_cast<double>(
+            best.offsetNs - fit.refOffsetNs) - predict(fit, best.monoNs);
+        const double limit = std::max(5 * fit.rmsNs,
+            static_cast<double>(minRejectNs));
+        if (std::fabs(residual) > limit) {
+            rejects[consecutiveRejects++] = best;
+            {
+                QMutexLocker lock(&mutex);
+                ++st.rejected;
+            }
+            if (consecutiveRejects < resetAfter) {
+                return;
+            }
+            // The rejects agree with each other but not with the fit, so
+            // the GPS time has stepped: start over from them.
+            count = 0;
+            head = 0;
+            for (quint32 i = 0; i < resetAfter; ++i) {
+                points[head++] = rejects[i];
+                ++count;
+            }
+            consecutiveRejects = 0;
+            {
+                QMutexLocker lock(&mutex);
+                ++st.resets;
+            }
+            refit();
+            return;
+        }
+    }
+    consecutiveRejects = 0;
+    points[head] = best;
+    head = (head + 1) % maxPoints;
+    count = std::min(count + 1, maxPoints);
+    refit();
+}
+
+
+void
+ClockSync::refit(void)
+{
+    // Reference everything to the oldest bucket, so the offsets (about
+    // 1e18 ns) fit in a double without losing nanoseconds.
+    const quint32 first = (head + maxPoints - count) % maxPoints;
+    Fit f;
+    f.refMonoNs = points[first].monoNs;
+    f.refOffsetNs = points[first].offsetNs;
+    double x[maxPoints];
+    double y[maxPoints];
+    bool use[maxPoints];
+    for (quint32 i = 0; i < count; ++i) {
+        const Point &p = points[(first + i) % maxPoints];
+        x[i] = static_cast<double>(static_cast<qint64>(p.monoNs - f.refMonoNs));
+        y[i] = static_cast<double>(p.offsetNs - f.refOffsetNs);
+        use[i] = true;
+    }
+
+    // Least squares, twice: the second pass without the outliers of the
+    // first.
+    double rms = 0;
+    quint32 used = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        double sx = 0, sy = 0;
+        used = 0;
+        for (quint32 i = 0; i < count; ++i) {
+            if (use[i]) {
+                sx += x[i];
+                sy += y[i];
+                ++used;
+            }
+        }
+        const double mx = sx / used;
+        const double my = sy / used;
+        double sxx = 0, sxy = 0;
+        for (quint32 i = 0; i < count; ++i) {
+            if (use[i]) {
+                sxx += (x[i] - mx) * (x[i] - mx);
+                sxy += (x[i] - mx) * (y[i] - my);
+            }
+        }
+        f.slope = sxx > 0 ? sxy / sxx : 0;
+        f.intercept = my - f.slope * mx;
+
+        double res[maxPoints];
+        double ss = 0;
+        for (quint32 i = 0; i < count; ++i) {
+            res[i] = std::fabs(y[i] - f.intercept - f.slope * x[i]);
+            if (use[i]) {
+                ss += res[i] * res[i];
+            }
+        }
+        rms = std::sqrt(ss / used);
+        if (pass || count < minPoints) {
+            break;
+        }
+        double sorted[maxPoints];
+        std::copy(res, res + count, sorted);
+        std::nth_element(sorted, sorted + count / 2, sorted + count);
+        const double limit = std::max(5 * 1.4826 * sorted[count / 2],
+            static_cast<double>(minRejectNs));
+        quint32 keep = 0;
+        for (quint32 i = 0; i < count; ++i) {
+            keep += res[i] <= limit;
+        }
+        // Two points are needed for a line.
+        if (keep < 2 || keep == count) {
+            break;
+        }
+        for (quint32 i = 0; i < count; ++i) {
+            use[i] = res[i] <= limit;
+        }
+    }
+    f.rmsNs = rms;
+    f.valid = count >= minPoints;
+    fit = f;
+
+    QMutexLocker lock(&mutex);
+    published = f;
+    st.points = used;
+    st.driftPpb = 1e9 * f.slope;
+    st.rmsNs = f.rmsNs;
+}
+
+
+double
+ClockSync::predict(const Fit &f, quint64 monoNs) const
+{
+    return f.intercept + f.slope * static_cast<double>(
+        static_cast<qint64>(monoNs - f.refMonoNs));
+}
+
+
+};  // namespace dfti
@@ -0,0 +1,178 @@
+/*!
+ *  \file clocksync.hh
+ *  \brief Host to GPS clock correlation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <algorithm>
+#include <cmath>
+// 3rd party
+#include <QMutex>
+#include <QtGlobal>
+
+
+namespace dfti {
+
+
+//! Clock correlation statistics.
+struct ClockSyncStats
+{
+    //! Time pairs offered.
+    quint64 samples{0};
+    //! Buckets rejected as outliers.
+    quint64 rejected{0};
+    //! Times the fit was restarted after the GPS time stepped.
+    quint32 resets{0};
+    //! Buckets in the current fit.
+    quint32 points{0};
+    //! Rate of GPS time relative to the host clock, parts per billion.
+    double driftPpb{0};
+    //! RMS residual of the fit, nanoseconds.
+    double rmsNs{0};
+};
+
+
+//! Continuous fit of host monotonic time against GPS time.
+/*!
+ *  The VN-200 stamps its measurements with GPS time, and DFTI stamps every
+ *  packet with CLOCK_MONOTONIC when it is read (see SerialSensor). This
+ *  class fits GPS time against host time as an offset and a drift, so that
+ *  any sensor's receive time can be converted to GPS time.
+ *
+ *  Serial delivery only ever delays a packet, so of the pairs in each one
+ *  second bucket only the least delayed (largest GPS minus host time) is
+ *  kept. A least squares line is fit through the last maxPoints buckets,
+ *  about four minutes. Buckets further from the line than five robust
+ *  standard deviations (5 * 1.4826 times the median absolute residual) are
+ *  left out of the fit, and new buckets further from it than five times the
+ *  RMS residual are rejected; neither limit goes below minRejectNs. If
+ *  resetAfter buckets in a row are rejected the GPS time is assumed to have
+ *  stepped and the fit restarts from them.
+ *
+ *  addSample() is called from one thread (the VN-200's); toGpsNs() may be
+ *  called from any thread.
+ */
+class ClockSync
+{
+public:
+    //! Number of one second buckets in the fit.
+    static const quint32 maxPoints{256};
+
+    //! Buckets needed before the fit is used.
+    static const quint32 minPoints{3};
+
+    //! Consecutive rejected buckets that restart the fit.
+    static const quint32 resetAfter{5};
+
+    //! Length of a bucket, nanoseconds.
+    static const quint64 bucketNs{1000000000ull};
+
+    //! Residuals below this are never outliers, nanoseconds.
+    static const qint64 minRejectNs{20000};
+
+    //! Add a time pair.
+    /*!
+     *  \param monoNs Host monotonic time, nanoseconds.
+     *  \param gpsNs GPS time at the same instant, nanoseconds.
+     */
+    void addSample(quint64 monoNs, quint64 gpsNs);
+
+    //! Convert host monotonic time to GPS time.
+    /*!
+     *  \param monoNs Host monotonic time, nanoseconds.
+     *  \return GPS time, nanoseconds, or 0 if the fit isn't locked yet.
+     */
+    quint64 toGpsNs(quint64 monoNs) const;
+
+    //! Returns true once enough buckets have been fit.
+    bool locked(void) const;
+
+    //! Correlation statistics.
+    ClockSyncStats stats(void) const;
+
+private:
+    //! One bucket: the least delayed pair in it.
+    struct Point
+    {
+        //! Host monotonic time, nanoseconds.
+        quint64 monoNs;
+        //! GPS minus host time, nanoseconds.
+        qint64 offsetNs;
+    };
+
+    //! Published fit; offset = refOffsetNs + intercept + slope * (t - ref).
+    struct Fit
+    {
+        //! Host time the fit is referenced to, nanoseconds.
+        quint64 refMonoNs{0};
+        //! Offset at the reference, nanoseconds.
+        qint64 refOffsetNs{0};
+        //! Offset at the reference relative to refOffsetNs, nanoseconds.
+        double intercept{0};
+        //! Drift, nanoseconds per nanosecond.
+        double slope{0};
+        //! RMS residual, nanoseconds.
+        double rmsNs{0};
+        //! Flag to indicate the fit is locked.
+        bool valid{false};
+    };
+
+    //! Vet the finished bucket and add it to the fit.
+    void closeBucket(void);
+
+    //! Fit the buckets and publish the result.
+    void refit(void);
+
+    //! Offset the current fit predicts, relative to its refOffsetNs.
+    double predict(const Fit &f, quint64 monoNs) const;
+
+    //! Flag to indicate a bucket is being filled.
+    bool haveBucket{false};
+
+    //! Host time the current bucket started, nanoseconds.
+    quint64 bucketStartNs{0};
+
+    //! Least delayed pair in the current bucket.
+    Point best{0, 0};
+
+    //! Ring of fitted buckets.
+    Point points[maxPoints];
+
+    //! Next ring slot to write.
+    quint32 head{0};
+
+    //! Buckets in the ring.
+    quint32 count{0};
+
+    //! Buckets rejected in a row.
+    Point rejects[resetAfter];
+
+    //! Number of rejects in a row.
+    quint32 consecutiveRejects{0};
+
+    //! Fit, as seen by the writer thread.
+    Fit fit;
+
+    //! Guards published and st.
+    mutable QMutex mutex;
+
+    //! Fit, as seen by readers.
+    Fit published;
+
+    //! Statistics.
+    ClockSyncStats st;
+};
+
+
+};  // namespace dfti
@@ -0,0 +1,123 @@
+/*!
+ *  \file crc.cc
+ *  \brief CRC-16-CCITT checksum implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "crc.hh"
+
+
+namespace dfti {
+
+
+namespace {
+
+
+//! CRC-16-CCITT lookup tables.
+/*!
+ *  table[0][x] is the CRC of the single byte x; table[k][x] is the CRC of
+ *  x followed by k zero bytes, which is what slice-by-8 needs to fold the
+ *  k-th last byte of a block into the result.
+ */
+struct CRC16Tables
+{
+    CRC16Tables()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint16 crc = static_cast<quint16>(i << 8);
+            for (quint8 bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? static_cast<quint16>((crc << 1) ^ 0x1021)
+                                     : static_cast<quint16>(crc << 1);
+            }
+            table[0][i] = crc;
+        }
+        for (quint32 i = 0; i < 256; ++i) {
+            for (quint8 k = 1; k < 8; ++k) {
+                const quint16 prev = table[k - 1][i];
+                table[k][i] = static_cast<quint16>(prev << 8) ^
+                    table[0][prev >> 8];
+            }
+        }
+    }
+
+    quint16 table[8][256];
+};
+
+
+//! Tables are built once, on first use.
+const CRC16Tables&
+tables(void)
+{
+    static const CRC16Tables t;
+    return t;
+}
+
+
+};  // namespace
+
+
+quint16
+crc16CCITTScalar(const char *data, size_t len, quint16 crc)
+{
+    for (size_t i = 0; i < len; ++i) {
+        crc = static_cast<quint8>(crc >> 8) | (crc << 8);
+        crc ^= static_cast<quint8>(data[i]);
+        crc ^= static_cast<quint8>(crc & 0xff) >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0x00ff) << 5;
+    }
+    return crc;
+}
+
+
+quint16
+crc16CCITTTable(const char *data, size_t len, quint16 crc)
+{
+    const quint16 (&t)[256] = tables().table[0];
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    for (size_t i = 0; i < len; ++i) {
+        crc = static_cast<quint16>(crc << 8) ^ t[(crc >> 8) ^ p[i]];
+    }
+    return crc;
+}
+
+
+quint16
+crc16CCITTSlice8(const char *data, size_t len, quint16 crc)
+{
+    const quint16 (&t)[8][256] = tables().table;
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    while (len >= 8) {
+        crc = t[7][p[0] ^ (crc >> 8)] ^ t[6][p[1] ^ (crc & 0xff)] ^
+            t[5][p[2]] ^ t[4][p[3]] ^ t[3][p[4]] ^ t[2][p[5]] ^
+            t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = static_cast<quint16>(crc << 8) ^ t[0][(crc >> 8) ^ *p++];
+    }
+    return crc;
+}
+
+
+
+quint16
+crc16X25(const char *data, size_t len, quint16 crc)
+{
+    for (size_t i = 0; i < len; ++i) {
+        quint8 tmp = static_cast<quint8>(data[i]) ^ static_cast<quint8>(crc);
+        tmp ^= tmp << 4;
+        crc = (crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4);
+    }
+    return crc;
+}
+
+};  // namespace dfti
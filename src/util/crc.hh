@@ -0,0 +1,84 @@
+/*!
+ *  \file crc.hh
+ *  \brief CRC-16-CCITT checksum routines.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cstddef>
+// 3rd party
+#include <QtGlobal>
+
+
+namespace dfti {
+
+
+//! CRC-16-CCITT, one byte at a time with shifts and xors.
+/*!
+ *  Polynomial 0x1021, no reflection and no final xor, as used by the
+ *  VectorNav binary protocol. This is the original implementation used to
+ *  validate VN-200 packets; it needs no tables and is kept as the reference
+ *  the faster versions are checked against.
+ *
+ *  \param data Bytes to checksum.
+ *  \param len Number of bytes.
+ *  \param crc Initial CRC value (or the CRC of the preceding bytes).
+ *  \return Updated CRC.
+ */
+quint16 crc16CCITTScalar(const char *data, size_t len, quint16 crc = 0);
+
+
+//! CRC-16-CCITT using one 256-entry lookup table.
+/*!
+ *  \copydetails crc16CCITTScalar
+ */
+quint16 crc16CCITTTable(const char *data, size_t len, quint16 crc = 0);
+
+
+//! CRC-16-CCITT using slice-by-8 lookup tables.
+/*!
+ *  Eight table lookups are combined per eight bytes of input, which breaks
+ *  the dependency of every byte on the previous CRC. Bytes are loaded one at
+ *  a time, so the result does not depend on host byte order or alignment.
+ *
+ *  \copydetails crc16CCITTScalar
+ */
+quint16 crc16CCITTSlice8(const char *data, size_t len, quint16 crc = 0);
+
+
+//! CRC-16-CCITT using the fastest available implementation.
+/*!
+ *  \copydetails crc16CCITTScalar
+ */
+inline quint16
+crc16CCITT(const char *data, size_t len, quint16 crc = 0)
+{
+    return crc16CCITTSlice8(data, len, crc);
+}
+
+
+
+//! CRC-16/X.25 (CRC-16/MCRF4XX), as MAVLink uses.
+/*!
+ *  Polynomial 0x1021, reflected, computed a byte at a time like MAVLink's
+ *  crc_accumulate. MAVLink starts from 0xffff and ends each message with
+ *  its CRC extra byte.
+ *
+ *  \param data Bytes to checksum.
+ *  \param len Number of bytes.
+ *  \param crc Initial CRC value (or the CRC of the preceding bytes).
+ *  \return Updated CRC.
+ */
+quint16 crc16X25(const char *data, size_t len, quint16 crc = 0xffff);
+
+};  // namespace dfti
@@ -0,0 +1,141 @@
+/*!
+ *  \file decimal.cc
+ *  \brief Allocation-free decimal field decoding implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "decimal.hh"
+
+
+namespace dfti {
+
+
+namespace {
+
+
+//! Powers of ten that are exact in a double.
+const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+    1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+
+//! Split a plain decimal field into sign, integer mantissa and decimals.
+/*!
+ *  \param field First character of the field.
+ *  \param len Field length.
+ *  \param maxDigits Most digits accepted.
+ *  \param allowPoint Whether a decimal point is accepted.
+ *  \param negative Set if the field has a minus sign.
+ *  \param mantissa Set to the digits as an integer.
+ *  \param decimals Set to the number of digits after the point.
+ *  \return False if the field is not of the plain form.
+ */
+bool
+splitDecimal(const char *field, int len, int maxDigits, bool allowPoint,
+    bool &negative, qint64 &mantissa, int &decimals)
+{
+    int i = 0;
+    negative = false;
+    if (len > 0 && (field[0] == '+' || field[0] == '-')) {
+        negative = field[0] == '-';
+        ++i;
+    }
+    int digits = 0;
+    int whole = 0;
+    bool point = false;
+    mantissa = 0;
+    decimals = 0;
+    for (; i < len; ++i) {
+        const char c = field[i];
+        if (c >= '0' && c <= '9') {
+            if (++digits > maxDigits) {
+                return false;
+            }
+            mantissa = 10 * mantissa + (c - '0');
+            point ? ++decimals : ++whole;
+        } else if (c == '.' && allowPoint && !point) {
+            point = true;
+        } else {
+            return false;
+        }
+    }
+    // Digits are required on both sides of a point, so that only forms
+    // every conversion routine agrees on take the fast path.
+    return whole && (!point || decimals);
+}
+
+
+};  // namespace
+
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+float
+decimalToFloat(const char *field, int len, bool *ok)
+{
+    bool negative;
+    qint64 mantissa;
+    int decimals;
+    if (!splitDecimal(field, len, 15, true, negative, mantissa, decimals)) {
+        return QByteArray::fromRawData(field, len).toFloat(ok);
+    }
+    if (ok) {
+        *ok = true;
+    }
+    const double value = static_cast<double>(mantissa) / powersOfTen[decimals];
+    return static_cast<float>(negative ? -value : value);
+}
+
+
+int
+decimalToInt(const char *field, int len, bool *ok)
+{
+    bool negative;
+    qint64 mantissa;
+    int decimals;
+    if (!splitDecimal(field, len, 9, false, negative, mantissa, decimals)) {
+        return QByteArray::fromRawData(field, len).toInt(ok);
+    }
+    if (ok) {
+        *ok = true;
+    }
+    return static_cast<int>(negative ? -mantissa : mantissa);
+}
+
+
+int
+hexToInt(const char *field, int len, bool *ok)
+{
+    int value = 0;
+    if (len < 1 || len > 7) {
+        return QByteArray::fromRawData(field, len).toInt(ok, 16);
+    }
+    for (int i = 0; i < len; ++i) {
+        const char c = field[i];
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return QByteArray::fromRawData(field, len).toInt(ok, 16);
+        }
+        value = 16 * value + digit;
+    }
+    if (ok) {
+        *ok = true;
+    }
+    return value;
+}
+
+
+};  // namespace dfti
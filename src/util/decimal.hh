@@ -0,0 +1,64 @@
+/*!
+ *  \file decimal.hh
+ *  \brief Allocation-free decimal field decoding.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// 3rd party
+#include <QByteArray>
+#include <QtGlobal>
+
+
+namespace dfti {
+
+
+//! Decode a decimal field exactly as QByteArray::toFloat does.
+/*!
+ *  Fields of the plain form <tt>[+-]digits[.digits]</tt> with at most 15
+ *  digits are decoded in place: the digits are accumulated into an integer
+ *  mantissa, which is exact in a double, and divided once by an exact power
+ *  of ten. IEEE division rounds correctly, so this is the same double Qt's
+ *  string conversion produces, and the float rounded from it is bit for bit
+ *  what toFloat returns. Anything else (whitespace, exponents, long fields,
+ *  junk) is handed to QByteArray::toFloat, so the result is always
+ *  identical; only that fallback allocates.
+ *
+ *  \param field First character of the field; need not be terminated.
+ *  \param len Field length.
+ *  \param ok Set to false if the field is not a number, as toFloat does.
+ *  \return Decoded value, or 0 if the field is not a number.
+ */
+float decimalToFloat(const char *field, int len, bool *ok = nullptr);
+
+
+//! Decode a decimal field exactly as QByteArray::toInt does.
+/*!
+ *  Fields of the form <tt>[+-]digits</tt> with at most 9 digits are
+ *  decoded in place; anything else goes through QByteArray::toInt.
+ *
+ *  \copydetails decimalToFloat
+ */
+int decimalToInt(const char *field, int len, bool *ok = nullptr);
+
+
+//! Decode a hexadecimal field exactly as QByteArray::toInt(ok, 16) does.
+/*!
+ *  Fields of up to 7 hex digits are decoded in place; anything else goes
+ *  through QByteArray::toInt.
+ *
+ *  \copydetails decimalToFloat
+ */
+int hexToInt(const char *field, int len, bool *ok = nullptr);
+
+
+};  // namespace dfti
@@ -0,0 +1,135 @@
+/*!
+ *  \file scheduler.cc
+ *  \brief Periodic tick scheduler implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "scheduler.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+Scheduler::Scheduler(QObject* _parent)
+: QObject(_parent)
+{
+}
+
+
+Scheduler::~Scheduler()
+{
+    stop();
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+bool
+Scheduler::start(quint32 periodUsec)
+{
+    stop();
+    if (!periodUsec) {
+        qWarning() << "[WARN ]  Scheduler: zero period";
+        return false;
+    }
+    periodNs = 1000ull * periodUsec;
+    m_stats = SchedulerStats();
+    return arm(monotonicNsec() + periodNs);
+}
+
+
+bool
+Scheduler::startOnce(quint32 delayUsec)
+{
+    if (periodNs) {
+        stop();
+        periodNs = 0;
+    }
+    return arm(monotonicNsec() + 1000ull * delayUsec);
+}
+
+
+void
+Scheduler::stop(void)
+{
+    if (notifier) {
+        notifier->setEnabled(false);
+        delete notifier.data();
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+bool
+Scheduler::arm(quint64 deadlineNs)
+{
+    if (fd < 0) {
+        fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0) {
+            qWarning() << "[WARN ]  Scheduler: timerfd_create failed:"
+                       << strerror(errno);
+            return false;
+        }
+        // String based, as activated() is overloaded from Qt 5.15.
+        notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(notifier.data(), SIGNAL(activated(int)), this,
+            SLOT(expired()));
+    }
+
+    firstNs = deadlineNs;
+    deadlines = 0;
+
+    struct itimerspec spec;
+    spec.it_value.tv_sec = firstNs / nsecPerSec;
+    spec.it_value.tv_nsec = firstNs % nsecPerSec;
+    spec.it_interval.tv_sec = periodNs / nsecPerSec;
+    spec.it_interval.tv_nsec = periodNs % nsecPerSec;
+    if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        qWarning() << "[WARN ]  Scheduler: timerfd_settime failed:"
+                   << strerror(errno);
+        stop();
+        return false;
+    }
+    return true;
+}
+
+
+void
+Scheduler::expired(void)
+{
+    // The count is the number of deadlines since the last read.
+    quint64 count = 0;
+    if (read(fd, &count, sizeof(count)) != sizeof(count) || !count) {
+        return;
+    }
+    deadlines += count;
+    m_stats.missed += count - 1;
+
+    // Lateness relative to the latest deadline.
+    const quint64 deadlineNs = firstNs + (deadlines - 1) * periodNs;
+    const quint64 now = monotonicNsec();
+    const quint64 lateNs = now > deadlineNs ? now - deadlineNs : 0;
+    ++m_stats.histogram[jitterBin(lateNs)];
+    m_stats.maxLateNs = std::max(m_stats.maxLateNs, lateNs);
+    ++m_stats.ticks;
+
+    emit tick();
+}
+
+
+};  // namespace dfti
@@ -0,0 +1,185 @@
+/*!
+ *  \file scheduler.hh
+ *  \brief Periodic tick scheduler interface.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/timerfd.h>
+#include <unistd.h>
+// 3rd party
+#include <QDebug>
+#include <QObject>
+#include <QPointer>
+#include <QSocketNotifier>
+#include <QtGlobal>
+// dfti
+#include "util/timeutil.hh"
+
+
+namespace dfti {
+
+
+//! Number of bins in the tick lateness histogram.
+const quint32 numJitterBins = 16;
+
+
+//! Scheduler statistics.
+struct SchedulerStats
+{
+    //! Ticks emitted.
+    quint64 ticks{0};
+    //! Deadlines that passed without a tick of their own.
+    quint64 missed{0};
+    //! Largest lateness of a tick, nanoseconds.
+    quint64 maxLateNs{0};
+    //! Tick lateness histogram; see jitterBinUsec.
+    quint64 histogram[numJitterBins] = {0};
+};
+
+
+//! Upper edge of a lateness histogram bin.
+/*!
+ *  Bin 0 holds ticks less than 1 us late, and bin k ticks less than 2^k us
+ *  late; the last bin holds everything later.
+ *
+ *  \param bin Bin index.
+ *  \return Upper edge of the bin, microseconds.
+ */
+inline quint32
+jitterBinUsec(quint32 bin)
+{
+    return 1u << bin;
+}
+
+
+//! Histogram bin of a lateness.
+/*!
+ *  \param lateNs Lateness, nanoseconds.
+ *  \return Bin index; see jitterBinUsec.
+ */
+inline quint32
+jitterBin(quint64 lateNs)
+{
+    quint32 bin = 0;
+    while (bin < numJitterBins - 1 && lateNs >= 1000ull * jitterBinUsec(bin)) {
+        ++bin;
+    }
+    return bin;
+}
+
+
+//! Periodic tick on absolute monotonic deadlines.
+/*!
+ *  A QTimer takes its interval in whole milliseconds and schedules each
+ *  timeout relative to the last one, so rates that do not divide 1 kHz are
+ *  rounded and lateness accumulates. The Scheduler instead arms a timerfd
+ *  on CLOCK_MONOTONIC with an absolute first deadline and a period in
+ *  nanoseconds, so the n-th deadline is always start + n * period however
+ *  late earlier ticks were handled. The timerfd is watched from the owning
+ *  thread's event loop, so tick() is delivered like a QTimer timeout.
+ *
+ *  If the thread falls behind by more than a period the deadlines in
+ *  between are counted as missed and a single tick() is emitted; ticks are
+ *  never delivered in a burst. The lateness of every tick relative to its
+ *  deadline is kept in a histogram.
+ *
+ *  startOnce() instead arms the same timer for a single tick, for consumers
+ *  that delay their work after an event by less than a millisecond.
+ */
+class Scheduler : public QObject
+{
+    Q_OBJECT;
+
+public:
+    //! Constructor
+    /*!
+     *  \param _parent Pointer to parent QObject.
+     */
+    explicit Scheduler(QObject* _parent = nullptr);
+
+    //! Dtor.
+    ~Scheduler();
+
+    //! Start ticking.
+    /*!
+     *  The first tick is one period from now. Call from the thread whose
+     *  event loop should deliver the ticks.
+     *
+     *  \param periodUsec Tick period, microseconds.
+     *  \return True if the timer was armed.
+     */
+    bool start(quint32 periodUsec);
+
+    //! Tick once after a delay.
+    /*!
+     *  Re-arms the same timer when called again, replacing the pending
+     *  deadline, so it is cheap enough to call for every event. Periodic
+     *  ticking is stopped, and the statistics accumulate across calls.
+     *
+     *  \param delayUsec Delay, microseconds.
+     *  \return True if the timer was armed.
+     */
+    bool startOnce(quint32 delayUsec);
+
+    //! Stop ticking.
+    void stop(void);
+
+    //! Return the tick statistics.
+    /*!
+     *  \remark Call from the owning thread.
+     */
+    SchedulerStats stats(void) const { return m_stats; };
+
+signals:
+    //! Emitted once for each deadline that is handled.
+    void tick(void);
+
+private slots:
+    //! Handle a timerfd expiration.
+    void expired(void);
+
+private:
+    //! Arm the timer.
+    /*!
+     *  Creates the timer on first use.
+     *
+     *  \param deadlineNs Monotonic time of the first deadline, nanoseconds.
+     *  \return True if the timer was armed.
+     */
+    bool arm(quint64 deadlineNs);
+
+    //! Timer file descriptor.
+    int fd{-1};
+
+    //! Watches the timer file descriptor.
+    QPointer<QSocketNotifier> notifier{nullptr};
+
+    //! Tick period, nanoseconds; 0 for a single tick.
+    quint64 periodNs{0};
+
+    //! Monotonic time of the first deadline, nanoseconds.
+    quint64 firstNs{0};
+
+    //! Deadlines passed so far.
+    quint64 deadlines{0};
+
+    //! Tick statistics.
+    SchedulerStats m_stats;
+};
+
+
+};  // namespace dfti
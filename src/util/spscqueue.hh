@@ -0,0 +1,196 @@
+/*!
+ *  \file spscqueue.hh
+ *  \brief Lock-free single-producer/single-consumer queue.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <atomic>
+#include <vector>
+// 3rd party
+#include <QtGlobal>
+// dfti
+#include "util/wakeup.hh"
+
+
+namespace dfti {
+
+
+//! Default depth of the per-consumer sensor measurement queues.
+/*!
+ *  At 800 Hz this holds over 300 ms of measurements, which is several log
+ *  periods even at the lowest log rate we fly.
+ */
+const quint32 sensorQueueDepth = 256;
+
+
+//! Fixed-capacity lock-free single-producer/single-consumer queue.
+/*!
+ *  Used to hand measurements from a sensor thread to a consumer thread
+ *  without going through the Qt event queue. All storage is allocated with
+ *  the queue, so pushing and draining never allocate (as long as copying T
+ *  does not).
+ *
+ *  Exactly one thread may call push() and exactly one (possibly different)
+ *  thread may call pop()/drain(). When the queue is full new items are
+ *  rejected and counted as overflows; the consumer is expected to report
+ *  the overflow count.
+ *
+ *  \tparam T Item type.
+ *  \tparam Capacity Number of slots, must be a power of two.
+ */
+template <typename T, quint32 Capacity>
+class SPSCQueue
+{
+    static_assert(Capacity && !(Capacity & (Capacity - 1)),
+        "SPSCQueue capacity must be a power of two");
+
+public:
+    //! Push an item (producer thread only).
+    /*!
+     *  \param item Item to copy into the queue.
+     *  \return False if the queue was full and the item was dropped.
+     */
+    bool push(const T &item)
+    {
+        const quint32 head = m_head.load(std::memory_order_relaxed);
+        const quint32 tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail == Capacity) {
+            m_overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Pop the oldest item (consumer thread only).
+    /*!
+     *  \param item Destination for the item.
+     *  \return False if the queue was empty.
+     */
+    bool pop(T &item)
+    {
+        const quint32 tail = m_tail.load(std::memory_order_relaxed);
+        const quint32 head = m_head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        item = m_items[tail & mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Consume every queued item in order (consumer thread only).
+    /*!
+     *  The slots are released back to the producer in one batch once all
+     *  items have been handed to func.
+     *
+     *  \param func Callable invoked as func(const T&) for each item.
+     *  \return Number of items consumed.
+     */
+    template <typename F>
+    quint32 drain(F func)
+    {
+        const quint32 tail = m_tail.load(std::memory_order_relaxed);
+        const quint32 head = m_head.load(std::memory_order_acquire);
+        for (quint32 i = tail; i != head; ++i) {
+            func(m_items[i & mask]);
+        }
+        m_tail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    //! Number of items currently queued.
+    quint32 size(void) const
+    {
+        return m_head.load(std::memory_order_acquire) -
+            m_tail.load(std::memory_order_acquire);
+    }
+
+    //! Number of items dropped because the queue was full.
+    quint32 overflows(void) const
+    {
+        return m_overflows.load(std::memory_order_relaxed);
+    }
+
+private:
+    //! Index mask.
+    static const quint32 mask = Capacity - 1;
+
+    //! Producer position, kept on its own cache line.
+    alignas(64) std::atomic<quint32> m_head{0};
+
+    //! Consumer position, kept on its own cache line.
+    alignas(64) std::atomic<quint32> m_tail{0};
+
+    //! Overflow counter.
+    std::atomic<quint32> m_overflows{0};
+
+    //! Item storage.
+    T m_items[Capacity];
+};
+
+
+//! Fan-out of a sensor's measurements to per-consumer queues.
+/*!
+ *  Sensor drivers inherit from this alongside SerialSensor; each consumer
+ *  (Logger, Server) owns a queue and attaches it before the sensor thread is
+ *  started, which keeps every queue single-producer/single-consumer.
+ *
+ *  \tparam T Measurement type.
+ */
+template <typename T>
+class MeasurementPublisher
+{
+public:
+    //! Queue type consumers must own.
+    typedef SPSCQueue<T, sensorQueueDepth> Queue;
+
+    //! Attach a consumer queue.
+    /*!
+     *  \remark Must be called before the sensor thread is started.
+     *  \param queue Queue to push measurements to.
+     *  \param wakeup If given, notified after every measurement is pushed,
+     *      for consumers that act on each measurement as it arrives.
+     */
+    void attachQueue(Queue *queue, Wakeup *wakeup = nullptr)
+    {
+        m_queues.push_back(queue);
+        m_wakeups.push_back(wakeup);
+    };
+
+protected:
+    //! Push a measurement to every attached queue.
+    /*!
+     *  \param data Measurement to publish.
+     */
+    void publish(const T &data)
+    {
+        for (size_t i = 0; i < m_queues.size(); ++i) {
+            if (m_queues[i]->push(data) && m_wakeups[i]) {
+                m_wakeups[i]->notify();
+            }
+        }
+    }
+
+private:
+    //! Attached consumer queues.
+    std::vector<Queue *> m_queues;
+
+    //! Wakeup of each consumer queue, or nullptr.
+    std::vector<Wakeup *> m_wakeups;
+};
+
+
+};  // namespace dfti
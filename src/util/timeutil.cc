@@ -0,0 +1,80 @@
+/*!
+ *  \file timeutil.cc
+ *  \brief Host clocks and GPS/Unix time conversion implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "timeutil.hh"
+
+
+namespace dfti {
+
+
+//! Unix times at which leap seconds took effect, seconds.
+/*!
+ *  GPS minus UTC is the number of entries at or before a time. The list
+ *  ends with the leap second of 31 DEC 2016; add new ones as IERS Bulletin C
+ *  announces them.
+ */
+static const quint64 leapSecondsUnix[] = {
+    362793600,   // 1 JUL 1981
+    394329600,   // 1 JUL 1982
+    425865600,   // 1 JUL 1983
+    489024000,   // 1 JUL 1985
+    567993600,   // 1 JAN 1988
+    631152000,   // 1 JAN 1990
+    662688000,   // 1 JAN 1991
+    709948800,   // 1 JUL 1992
+    741484800,   // 1 JUL 1993
+    773020800,   // 1 JUL 1994
+    820454400,   // 1 JAN 1996
+    867715200,   // 1 JUL 1997
+    915148800,   // 1 JAN 1999
+    1136073600,  // 1 JAN 2006
+    1230768000,  // 1 JAN 2009
+    1341100800,  // 1 JUL 2012
+    1435708800,  // 1 JUL 2015
+    1483228800   // 1 JAN 2017
+};
+
+//! Number of leap seconds in the table.
+static const quint32 numLeapSeconds =
+    sizeof(leapSecondsUnix) / sizeof(leapSecondsUnix[0]);
+
+
+// ----------------------------------------------------------------------------
+//  Functions
+// ----------------------------------------------------------------------------
+quint32
+leapSecondsAtUnix(quint64 unixSec)
+{
+    // Search from the end; current times are past every entry.
+    quint32 n = numLeapSeconds;
+    while (n && unixSec < leapSecondsUnix[n - 1]) {
+        --n;
+    }
+    return n;
+}
+
+
+quint32
+leapSecondsAtGps(quint64 gpsSec)
+{
+    // In GPS time the n-th leap second took effect n seconds later than
+    // its Unix time suggests.
+    quint32 n = numLeapSeconds;
+    while (n && gpsSec + gpsEpochUnixSec < leapSecondsUnix[n - 1] + n) {
+        --n;
+    }
+    return n;
+}
+
+
+};  // namespace dfti
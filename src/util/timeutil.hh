@@ -0,0 +1,144 @@
+/*!
+ *  \file timeutil.hh
+ *  \brief Host clocks and GPS/Unix time conversion.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <chrono>
+#include <ctime>
+// 3rd party
+#include <QtGlobal>
+
+
+namespace dfti {
+
+
+//! Unix time of the GPS epoch, 0000 6 JAN 1980 UTC, in seconds.
+const quint64 gpsEpochUnixSec = 315964800;
+
+//! Nanoseconds per second.
+const quint64 nsecPerSec = 1000000000;
+
+
+//! std::chrono clock over clock_gettime(CLOCK_MONOTONIC).
+/*!
+ *  glibc serves clock_gettime from the vDSO, so reading the clock costs a
+ *  few tens of nanoseconds and no system call, and, unlike a shared
+ *  struct timeval, is safe from any thread.
+ */
+struct MonotonicClock
+{
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<MonotonicClock> time_point;
+    static constexpr bool is_steady = true;
+
+    //! Current time.
+    static time_point now(void) noexcept
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return time_point(std::chrono::seconds(ts.tv_sec) +
+            std::chrono::nanoseconds(ts.tv_nsec));
+    }
+};
+
+
+//! std::chrono clock over clock_gettime(CLOCK_REALTIME).
+/*!
+ *  Unix time; jumps whenever the system time is set.
+ */
+struct RealtimeClock
+{
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<RealtimeClock> time_point;
+    static constexpr bool is_steady = false;
+
+    //! Current time.
+    static time_point now(void) noexcept
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return time_point(std::chrono::seconds(ts.tv_sec) +
+            std::chrono::nanoseconds(ts.tv_nsec));
+    }
+};
+
+
+//! Monotonic time in nanoseconds.
+inline quint64
+monotonicNsec(void)
+{
+    return MonotonicClock::now().time_since_epoch().count();
+}
+
+
+//! Unix time in nanoseconds.
+inline quint64
+realtimeNsec(void)
+{
+    return RealtimeClock::now().time_since_epoch().count();
+}
+
+
+//! GPS minus UTC at a Unix time.
+/*!
+ *  \param unixSec Unix time, seconds.
+ *  \return Leap seconds inserted since the GPS epoch.
+ */
+quint32 leapSecondsAtUnix(quint64 unixSec);
+
+
+//! GPS minus UTC at a GPS time.
+/*!
+ *  \param gpsSec GPS time, seconds since the GPS epoch.
+ *  \return Leap seconds inserted since the GPS epoch.
+ */
+quint32 leapSecondsAtGps(quint64 gpsSec);
+
+
+//! Convert GPS time to Unix time.
+/*!
+ *  Exact; applies the leap seconds in effect at that GPS time.
+ *
+ *  \param gpsNs GPS time, nanoseconds since the GPS epoch.
+ *  \return Unix time, nanoseconds.
+ */
+inline quint64
+gpsToUnixNsec(quint64 gpsNs)
+{
+    return gpsNs + gpsEpochUnixSec * nsecPerSec -
+        leapSecondsAtGps(gpsNs / nsecPerSec) * nsecPerSec;
+}
+
+
+//! Convert Unix time to GPS time.
+/*!
+ *  Exact, and the inverse of gpsToUnixNsec.
+ *
+ *  \param unixNs Unix time, nanoseconds; not before the GPS epoch.
+ *  \return GPS time, nanoseconds since the GPS epoch.
+ */
+inline quint64
+unixToGpsNsec(quint64 unixNs)
+{
+    return unixNs - gpsEpochUnixSec * nsecPerSec +
+        leapSecondsAtUnix(unixNs / nsecPerSec) * nsecPerSec;
+}
+
+
+};  // namespace dfti
@@ -17,50 +17,73 @@
 namespace dfti {
 
 
+//! Replacement clock for getTimeUsec, if any.
+static quint64 (*timeSource)(void) = nullptr;
+
+
+void
+setTimeSource(quint64 (*source)(void))
+{
+    timeSource = source;
+}
+
+
 quint64
 getTimeUsec(void)
 {
-    static struct timeval _ts;
-    gettimeofday(&_ts, nullptr);
-    return 1e6 * _ts.tv_sec + _ts.tv_usec;
+    if (timeSource) {
+        return timeSource();
+    }
+    return realtimeNsec() / 1000;
 }
 
 
 quint64
-gpsToUnixUsec(quint64 gpsTime)
+getMonotonicNsec(void)
 {
-    const float nsToUs = 1e-3;
-    const quint64 gpsEpochFromUnixEpochUs = 315964800000000;
-    return static_cast<quint64>(gpsEpochFromUnixEpochUs + gpsTime * nsToUs);
+    return monotonicNsec();
+}
+
+
+QString
+fileTimestamp(void)
+{
+    // Get ISO date timestamp.
+    QDateTime local(QDateTime::currentDateTime());
+    QDateTime UTC(local.toTimeSpec(Qt::UTC));
+    // QDateTime format doesn't support formatters without separators, so use
+    // a dummy value 'R' and then replace it.
+    QString timestamp = UTC.toString("yyyy'R'MM'R'dd'T'HH'R'mm");
+    timestamp.replace(QString("R"), QString(""));
+    return timestamp;
 }
 
 
 quint64
-gpsToUnixSec(quint64 gpsTime)
+gpsToUnixUsec(quint64 gpsTime)
 {
-    const float usToSec = 1e-6;
-    return static_cast<quint64>(gpsToUnixUsec(gpsTime) * usToSec);
+    return gpsToUnixNsec(gpsTime) / 1000;
 }
 
 
-float
-hzToMsec(quint8 rate)
+quint64
+gpsToUnixSec(quint64 gpsTime)
 {
-    return 1e3 / static_cast<float>(rate);
+    return gpsToUnixNsec(gpsTime) / nsecPerSec;
 }
 
 
-float
-hzToUsec(quint8 rate)
+quint32
+hzToUsec(quint32 rate)
 {
-    return 1e6 / static_cast<float>(rate);
+    return rate ? (1000000 + rate / 2) / rate : 0;
 }
 
 
-float
-secToMsec(quint8 period)
+quint32
+secToMsec(quint32 period)
 {
-    return 1e3 * static_cast<float>(period);
+    return 1000 * period;
 }
 
 
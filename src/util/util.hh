@@ -14,12 +14,12 @@
 #pragma once
 
 
-// stdlib
-#include <ctime>
-#include <sys/time.h>
 // 3rd party
+#include <QDateTime>
 #include <QDebug>
 #include <QString>
+// dfti
+#include "util/timeutil.hh"
 
 
 namespace dfti {
@@ -27,6 +27,8 @@ namespace dfti {
 
 //! Get timestamp in microseconds.
 /*!
+ *  Thread safe; reads CLOCK_REALTIME through realtimeNsec.
+ *
  *  \remark If you are using this function on an embedded computer without a
  *      Real Time Clock, this is probably the time since boot.
  *  \return Unix time, microseconds since Jan 1, 1970.
@@ -34,8 +36,38 @@ namespace dfti {
 quint64 getTimeUsec(void);
 
 
+//! Replace the clock behind getTimeUsec.
+/*!
+ *  Used when replaying captured data so that measurements and log ticks are
+ *  stamped with the recorded time instead of the time of the replay. Must
+ *  be set before any sensor threads are started.
+ *
+ *  \param source Function returning the time in microseconds since the Unix
+ *      epoch, or nullptr to use the system clock again.
+ */
+void setTimeSource(quint64 (*source)(void));
+
+
+//! Get monotonic timestamp in nanoseconds.
+/*!
+ *  \remark Unlike getTimeUsec this never jumps when the system time is set
+ *      (e.g. from GPS), so it is the clock to difference receive times with.
+ *  \return Nanoseconds since an arbitrary fixed point, usually boot.
+ */
+quint64 getMonotonicNsec(void);
+
+
+//! Get the current UTC time formatted for use in file names.
+/*!
+ *  \return Timestamp of the form YYYYMMDDTHHMM.
+ */
+QString fileTimestamp(void);
+
+
 //! Convert GPS timestamp in nanoseconds to Unix timestamp in microseconds.
 /*!
+ *  Exact integer conversion, leap seconds included (see gpsToUnixNsec).
+ *
  *  \param gpsTime Timestamp from GPS epoch (0000 6 JAN 1980) in nanoseconds.
  */
 quint64 gpsToUnixUsec(quint64 gpsTime);
@@ -49,28 +81,21 @@ quint64 gpsToUnixUsec(quint64 gpsTime);
  */
 quint64 gpsToUnixSec(quint64 gpsTime);
 
-//! Convert Hertz rate to millisecond sampling time.
-/*!
- *  \param rate Sampling rate in Hz.
- *  \return Sampling period in milliseconds.
- */
-float hzToMsec(quint8 rate);
-
-
 //! Convert Hertz rate to microsecond sampling time.
 /*!
  *  \param rate Sampling rate in Hz.
- *  \return Sampling period in microseconds.
+ *  \return Sampling period in microseconds, rounded to the nearest, or 0 if
+ *      the rate is 0.
  */
-float hzToUsec(quint8 rate);
+quint32 hzToUsec(quint32 rate);
 
 
-//! Convert seconds to microseconds.
+//! Convert seconds to milliseconds.
 /*!
  *  \param period Time in seconds.
- *  \return Period in  microseconds.
+ *  \return Period in milliseconds.
  */
-float secToMsec(quint8 period);
+quint32 secToMsec(quint32 period);
 
 
 };  // namespace dfti
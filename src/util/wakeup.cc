@@ -0,0 +1,89 @@
+/*!
+ *  \file wakeup.cc
+ *  \brief Cross-thread wakeup implementation.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#include "wakeup.hh"
+
+
+namespace dfti {
+
+
+// ----------------------------------------------------------------------------
+//  Constructors/destructors
+// ----------------------------------------------------------------------------
+Wakeup::Wakeup(QObject* _parent)
+: QObject(_parent)
+{
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        qWarning() << "[WARN ]  Wakeup: eventfd failed:" << strerror(errno);
+    }
+}
+
+
+Wakeup::~Wakeup()
+{
+    if (notifier) {
+        notifier->setEnabled(false);
+        delete notifier.data();
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Public functions
+// ----------------------------------------------------------------------------
+bool
+Wakeup::watch(void)
+{
+    if (fd < 0) {
+        return false;
+    }
+    if (!notifier) {
+        // String based, as activated() is overloaded from Qt 5.15.
+        notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(notifier.data(), SIGNAL(activated(int)), this,
+            SLOT(readEvent()));
+    }
+    return true;
+}
+
+
+void
+Wakeup::notify(void)
+{
+    const quint64 one = 1;
+    if (fd >= 0) {
+        // Only fails if the counter would overflow, in which case the
+        // consumer has a wakeup pending anyway.
+        ssize_t ret = write(fd, &one, sizeof(one));
+        Q_UNUSED(ret);
+    }
+}
+
+// ----------------------------------------------------------------------------
+//  Private functions
+// ----------------------------------------------------------------------------
+void
+Wakeup::readEvent(void)
+{
+    quint64 count = 0;
+    if (read(fd, &count, sizeof(count)) != sizeof(count) || !count) {
+        return;
+    }
+    emit woken(count);
+}
+
+
+};  // namespace dfti
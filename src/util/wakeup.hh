@@ -0,0 +1,90 @@
+/*!
+ *  \file wakeup.hh
+ *  \brief Cross-thread wakeup of an event loop.
+ *  \author Joshua Harris
+ *  \copyright Copyright © 2017 Vehicle Systems & Control Laboratory,
+ *  Department of Aerospace Engineering, Texas A&M University
+ *  \license BSD 2-Clause License
+ *
+ * This file is provided for instructional value only.  It is not guaranteed for any particular purpose.  
+ * The authors do not offer any warranties or representations, nor do they accept any liabilities with respect 
+ * to the information or their use.  This file is distributed with the understanding that the  authors are not engaged 
+ * in rendering engineering or other professional services associate with their use.
+ */
+#pragma once
+
+
+// stdlib
+#include <cerrno>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <unistd.h>
+// 3rd party
+#include <QDebug>
+#include <QObject>
+#include <QPointer>
+#include <QSocketNotifier>
+#include <QtGlobal>
+
+
+namespace dfti {
+
+
+//! Wakes a consumer thread's event loop from a producer thread.
+/*!
+ *  Measurements are handed between threads through SPSCQueues, which a
+ *  consumer normally drains on its own schedule. A consumer that wants to
+ *  act on each measurement as it arrives has the publisher call notify()
+ *  after pushing, which writes to an eventfd; the consumer's event loop
+ *  watches the eventfd and emits woken(). Notifications that arrive before
+ *  the consumer gets to run are merged into one woken().
+ */
+class Wakeup : public QObject
+{
+    Q_OBJECT;
+
+public:
+    //! Constructor
+    /*!
+     *  \param _parent Pointer to parent QObject.
+     */
+    explicit Wakeup(QObject* _parent = nullptr);
+
+    //! Dtor.
+    ~Wakeup();
+
+    //! Start watching for notifications.
+    /*!
+     *  Call from the thread whose event loop should deliver woken().
+     *
+     *  \return True if the eventfd is being watched.
+     */
+    bool watch(void);
+
+    //! Wake the consumer.
+    /*!
+     *  \remark May be called from any thread.
+     */
+    void notify(void);
+
+signals:
+    //! Emitted when the consumer has been notified.
+    /*!
+     *  \param count Notifications merged into this one.
+     */
+    void woken(quint64 count);
+
+private slots:
+    //! Handle an eventfd notification.
+    void readEvent(void);
+
+private:
+    //! Event file descriptor.
+    int fd{-1};
+
+    //! Watches the event file descriptor.
+    QPointer<QSocketNotifier> notifier{nullptr};
+};
+
+
+};  // namespace dfti
@@ -35,73 +35,117 @@ SerialSensor(_settings, _parent)
 // ----------------------------------------------------------------------------
 //  Public functions
 // ----------------------------------------------------------------------------
+void
+VN200::setClockSync(ClockSync *sync)
+{
+    clockSync = sync;
+    // 10 bits a byte with the start and stop bits.
+    packetWireNs = 10ull * vn200PacketLen * 1000000000ull / baudRate;
+}
+
 
-// ----------------------------------------------------------------------------
-// Public Slots
-// ----------------------------------------------------------------------------
 void
-VN200::readData(void)
+VN200::parseBytes(const char *bytes, qint64 len)
 {
-    // Add available bytes to the buffer.
-    buf.append(_port->readAll());
-
-    if (buf.contains(header)) {
-        quint16 startIdx = buf.indexOf(header);
-        // Make sure we have a full packet, otherwise return and wait.
-        if (buf.size() < startIdx + packetSize) {
-            return;
-        }
-        QByteArray pkt = buf.mid(startIdx, packetSize);
-
-        //Validate packet.
-        if (validateVN200Checksum(pkt)) {
-            packet = reinterpret_cast<VN200Packet*>(pkt.data());
-            copyPacketToData();
-            // Emit the measurement update signal.
-            emit measurementUpdate(data);
-            // Check to see if we have GPS. If either the latitude or longitude
-            // is nonzero we should be OK.
-            if (abs(data.posDegDegM[0]) || abs(data.posDegDegM[1])) {
-                emit gpsAvailable(true);
-            }
-            // If we are in the verbose debugging mode, print the parsed data.
-            if (settings->debugData()) {
-                qDebug() << "TimeGPS :" << data.gpsTimeNs
-                         << "Yaw" << data.eulerDeg[0]
-                         << "Pitch" << data.eulerDeg[1]
-                         << "Roll" << data.eulerDeg[2]
-                         << "Quaternion: {"
-                         << data.quaternion[0] << ","
-                         << data.quaternion[1] << ","
-                         << data.quaternion[2] << ","
-                         << data.quaternion[3] << "}"
-                         << "P:" << data.angularRatesRPS[0]
-                         << "Q:" << data.angularRatesRPS[1]
-                         << "R:" << data.angularRatesRPS[2]
-                         << "Lat:" << data.posDegDegM[0]
-                         << "Lon:" << data.posDegDegM[1]
-                         << "Alt:" << data.posDegDegM[2]
-                         << "Vx:" << data.velNedMps[0]
-                         << "Vy:" << data.velNedMps[1]
-                         << "Vz:" << data.velNedMps[2]
-                         << "Ax:" << data.accelMps2[0]
-                         << "Ay:" << data.accelMps2[1]
-                         << "Az:" << data.accelMps2[2];
-            }
-        } else {
-            if (settings->debugData()) {
-                qDebug() << "[INFO ]  packet failed validation";
-            }
-        }
-        // We remove everything up to the next packet.
-        buf.remove(0, startIdx + packetSize);
+    // Copy into the framer, parsing each time it fills so that any amount of
+    // input is consumed.
+    while (len > 0) {
+        const quint32 n = framer.write(bytes, len);
+        parsePackets();
+        bytes += n;
+        len -= n;
     }
-    return;
 }
 
+
+quint32
+VN200::bytesWanted(void) const
+{
+    return framer.buffered() < vn200PacketLen ?
+        vn200PacketLen - framer.buffered() : 1;
+}
+
+// ----------------------------------------------------------------------------
+// Public Slots
+// ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 //  Private functions
 // ----------------------------------------------------------------------------
+void
+VN200::parsePackets(void)
+{
+    const quint64 failures = stats.checksumFailures;
+    FrameView frame;
+    while (framer.next(frame)) {
+        publishPacket(frame.data);
+    }
+    if (settings->debugData() && (stats.checksumFailures != failures)) {
+        qDebug() << "[INFO ]  packets failed validation:"
+                 << stats.checksumFailures - failures;
+    }
+
+    if (settings->debugSerial() && stats.packetsParsed &&
+        !(stats.packetsParsed % 1000) && (stats.packetsParsed != reported)) {
+        qDebug() << "VN200: packets" << stats.packetsParsed
+                 << "crc failures" << stats.checksumFailures
+                 << "discarded bytes" << stats.bytesDiscarded
+                 << "resyncs" << stats.resyncs
+                 << "peak buffered" << stats.peakBuffered;
+        reported = stats.packetsParsed;
+    }
+}
+
+
+void
+VN200::publishPacket(const char *frame)
+{
+    packet = reinterpret_cast<const VN200Packet*>(frame);
+    copyPacketToData();
+    data.timeUsec = rxTimeUsec;
+    data.rxTimeNs = rxTimeNs;
+    // The GPS time is when the VN-200 sampled and the receive time when the
+    // last byte was read, so take off the time the packet spent on the
+    // wire. (Current GPS timestamps in nanoseconds are always greater than
+    // 1e18.)
+    if (clockSync && data.gpsTimeNs > 1e18) {
+        clockSync->addSample(rxTimeNs - packetWireNs, data.gpsTimeNs);
+    }
+    // Hand the measurement to the consumer queues and emit the measurement
+    // update signal.
+    publish(data);
+    emit measurementUpdate(data);
+    // Check to see if we have GPS. If either the latitude or longitude is
+    // nonzero we should be OK.
+    if (abs(data.posDegDegM[0]) || abs(data.posDegDegM[1])) {
+        emit gpsAvailable(true);
+    }
+    // If we are in the verbose debugging mode, print the parsed data.
+    if (settings->debugData()) {
+        qDebug() << "TimeGPS :" << data.gpsTimeNs
+                 << "Yaw" << data.eulerDeg[0]
+                 << "Pitch" << data.eulerDeg[1]
+                 << "Roll" << data.eulerDeg[2]
+                 << "Quaternion: {"
+                 << data.quaternion[0] << ","
+                 << data.quaternion[1] << ","
+                 << data.quaternion[2] << ","
+                 << data.quaternion[3] << "}"
+                 << "P:" << data.angularRatesRPS[0]
+                 << "Q:" << data.angularRatesRPS[1]
+                 << "R:" << data.angularRatesRPS[2]
+                 << "Lat:" << data.posDegDegM[0]
+                 << "Lon:" << data.posDegDegM[1]
+                 << "Alt:" << data.posDegDegM[2]
+                 << "Vx:" << data.velNedMps[0]
+                 << "Vy:" << data.velNedMps[1]
+                 << "Vz:" << data.velNedMps[2]
+                 << "Ax:" << data.accelMps2[0]
+                 << "Ay:" << data.accelMps2[1]
+                 << "Az:" << data.accelMps2[2];
+    }
+}
+
+
 void
 VN200::copyPacketToData(void)
 {
@@ -134,19 +178,21 @@ VN200::copyPacketToData(void)
 //  Functions
 // ----------------------------------------------------------------------------
 bool
-validateVN200Checksum(QByteArray pkt)
+validateVN200Checksum(const char *pkt, size_t len)
 {
-    quint16 crc = 0;
-    // Calculate checksum.
-    for (quint8 i = 1; i < pkt.size(); ++i) {
-        crc = static_cast<quint8>(crc >> 8) | (crc << 8);
-        crc ^= static_cast<quint8>(pkt[i]);
-        crc ^= static_cast<quint8>(crc & 0xff) >> 4;
-        crc ^= crc << 12;
-        crc ^= (crc & 0x00ff) << 5;
+    // The sync byte is not covered by the checksum.
+    if (len < 1) {
+        return false;
     }
     // If the CRC is 0, then the validation passed.
-    return crc ? false : true;
+    return crc16CCITT(pkt + 1, len - 1) ? false : true;
+}
+
+
+bool
+validateVN200Checksum(const QByteArray &pkt)
+{
+    return validateVN200Checksum(pkt.constData(), pkt.size());
 }
 
 
@@ -23,6 +23,10 @@
 // dfti
 #include "sensor/serialsensor.hh"
 #include "settings/settings.hh"
+#include "util/clocksync.hh"
+#include "util/crc.hh"
+#include "util/spscqueue.hh"
+#include "util/util.hh"
 
 
 namespace dfti {
@@ -33,10 +37,54 @@ namespace dfti {
  *  The checksum is a CRC 16; if the checksum byte is included the checksum
  *  should evaluate to 0.
  *
+ *  \param pkt A full VN-200 packet to validate, starting at the sync byte.
+ *  \param len Packet length including the checksum bytes.
+ *  \return True if the packet checksum is correct.
+*/
+bool validateVN200Checksum(const char *pkt, size_t len);
+
+
+//! Validate the VN-200 packet checksum.
+/*!
  *  \param pkt A full VN-200 packet to validate.
  *  \return True if the packet checksum is correct.
 */
-bool validateVN200Checksum(QByteArray pkt);
+bool validateVN200Checksum(const QByteArray &pkt);
+
+
+//! VN-200 packet header bytes.
+/*!
+ *  \remark Used to identify the start of a VN-200 packet. Note that the
+ *      last three header bytes here change depending on the VN-200 payload.
+ */
+const char vn200Header[] = "\xfa\x01\xfa\x01";
+//! VN-200 packet header length.
+const quint8 vn200HeaderLen = 4;
+//! VN-200 packet length, including the checksum.
+const quint8 vn200PacketLen = 102;
+
+
+//! VN-200 packet format, for SyncFraming.
+struct VN200Format
+{
+    //! Header bytes checked before waiting for a whole packet.
+    static const quint32 headerLen = vn200HeaderLen;
+    //! Packets are a fixed size.
+    static const quint32 maxFrameLen = vn200PacketLen;
+    //! Sync byte.
+    static char syncByte(void) { return vn200Header[0]; }
+    //! Packet length, if the header matches.
+    static quint32 frameLen(const char *header)
+    {
+        return memcmp(header, vn200Header, vn200HeaderLen) ? 0 :
+            vn200PacketLen;
+    }
+    //! Check the CRC.
+    static bool check(const char *frame, quint32 len)
+    {
+        return validateVN200Checksum(frame, len);
+    }
+};
 
 
 //! Structure to hold VN-200 data.
@@ -90,6 +138,10 @@ struct VN200Data
      *  bias compensated by the EKF. Order is Ax, Ay, Az.
      */
     float accelMps2[3] = {0};
+    //! Host receive time, microseconds since the Unix epoch.
+    quint64 timeUsec = 0;
+    //! Host monotonic receive time, nanoseconds (see getMonotonicNsec).
+    quint64 rxTimeNs = 0;
 };
 
 
@@ -117,7 +169,7 @@ struct VN200Data
  *  fields are selected.
  *  The last two bytes are the checksum.
  */
-class VN200 : public SerialSensor
+class VN200 : public SerialSensor, public MeasurementPublisher<VN200Data>
 {
     Q_OBJECT;
 
@@ -129,17 +181,13 @@ public:
      */
     explicit VN200(Settings *_settings, QObject* _parent = nullptr);
 
-    //! VN-200 packet header bytes.
+    //! Feed the GPS time of every packet to a clock correlation.
     /*!
-     *  \remark Used to identify the start of a VN-200 packet. Note that the
-     *      last three header bytes here change depending on the VN-200
-     *      payload.
+     *  Must be called before the sensor thread starts.
+     *
+     *  \param sync Clock correlation, which must outlive the sensor.
      */
-    const QByteArray header{"\xfa\x01\xfa\x01"};
-
-public slots:
-    //! Slot to read in data over serial and parse complete packets.
-    void readData(void);
+    void setClockSync(ClockSync *sync);
 
 signals:
     //! Emitted when GPS data is available.
@@ -148,21 +196,53 @@ signals:
     //! Emitted to share new VN200Data.
     void measurementUpdate(VN200Data data);
 
+protected:
+    //! Parse a chunk of raw bytes from the VN-200.
+    /*!
+     *  Publishes every complete, valid packet, so a backlog never builds up
+     *  between wakeups.
+     *
+     *  \param bytes Raw bytes.
+     *  \param len Number of bytes.
+     */
+    void parseBytes(const char *bytes, qint64 len);
+
+    //! Bytes needed to complete the packet being received.
+    /*!
+     *  Packets are a fixed size, so the termios backend can wait for a whole
+     *  one before waking the sensor.
+     */
+    quint32 bytesWanted(void) const;
+
 private:
-    //! Buffer
+    //! Packet framer
     /*!
-     *  Buffer to hold the raw bytes we read in from the serial port. Since we
-     *  do not necessarily read in complete packets at a time, we need to let
-     *  the buffer fill up until we have a complete packet and then parse it,
-     *  which is the purpose of this buffer.
+     *  Buffers the raw bytes we read in from the serial port until complete
+     *  packets can be parsed out of them. 4 kB is about 40 packets, or over
+     *  a third of a second of data at 115200 baud.
      */
-    QByteArray buf;
+    Framer<SyncFraming<VN200Format>, 4096> framer{stats};
+
+    //! Publish every complete, valid packet in the framer.
+    void parsePackets(void);
+
+    //! Decode a packet and publish it.
+    /*!
+     *  \param frame A full, valid packet.
+     */
+    void publishPacket(const char *frame);
 
     //! Copy from raw packet to data struct.
     void copyPacketToData(void);
 
-    //! Expected packet size.
-    static const quint8 packetSize{102};
+    //! Packet count at the last statistics report.
+    quint64 reported{0};
+
+    //! Clock correlation fed with each packet's GPS time, if any.
+    ClockSync *clockSync{nullptr};
+
+    //! Time a packet takes on the wire, nanoseconds.
+    quint64 packetWireNs{0};
 
 #pragma pack(push, 1)  // change structure packing to 1 byte
     //! Packet format.
@@ -189,7 +269,7 @@ private:
     VN200Data data;
 
     //! Raw packet data.
-    VN200Packet *packet{nullptr};
+    const VN200Packet *packet{nullptr};
 };
 
 